@@ -8,13 +8,19 @@
 #include <catch2/catch_test_macros.hpp>
 #include <cbor_tags/cbor_decoder.h>
 #include <cbor_tags/cbor_encoder.h>
+#include <cbor_tags/cbor_segmented.h>
+#include <cbor_tags/extensions/cbor_shm.h>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <deque>
 #include <fmt/base.h>
 #include <iostream>
 #include <list>
 #include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
 
 using namespace cbor::tags;
 
@@ -159,6 +165,32 @@ TEST_CASE("decoder benchmarks", "[decoder]") {
             return output_array;
         });
     };
+
+    std::deque<std::byte> deque_buffer(buffer.begin(), buffer.end());
+    BENCHMARK_ADVANCED("Bench decoding from deque")(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&deque_buffer]() mutable {
+            std::vector<uint64_t> output_array;
+            auto                  dec    = make_decoder(deque_buffer);
+            auto                  status = dec(output_array);
+            CHECK(status);
+            return output_array;
+        });
+    };
+
+    std::vector<std::span<const std::byte>> chunks;
+    for (std::size_t i = 0; i < buffer.size(); i += 64) {
+        chunks.emplace_back(buffer.data() + i, std::min<std::size_t>(64, buffer.size() - i));
+    }
+    segmented_buffer segmented(chunks);
+    BENCHMARK_ADVANCED("Bench decoding from 64 byte segments")(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&segmented]() mutable {
+            std::vector<uint64_t> output_array;
+            auto                  dec    = make_decoder(segmented);
+            auto                  status = dec(output_array);
+            CHECK(status);
+            return output_array;
+        });
+    };
 }
 
 TEST_CASE("Encoder benchmarks", "[encoder]") {
@@ -357,3 +389,43 @@ TEST_CASE("decode variants", "[decoder]") {
         });
     };
 }
+
+TEST_CASE("Shared memory transport", "[ipc]") {
+    struct Quote {
+        std::uint64_t    sequence;
+        std::string_view symbol;
+        double           bid;
+        double           ask;
+        std::uint64_t    volume;
+    };
+    auto ring = shm_ring::create(256, 64);
+
+    BENCHMARK_ADVANCED("Encode in place, decode zero-copy")(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&ring, i = std::uint64_t{}]() mutable {
+            auto sent = ring.try_send(Quote{++i, "ACME", 101.25, 101.5, 1000 + i});
+            CHECK(sent);
+            Quote quote{};
+            auto  msg = ring.try_receive();
+            CHECK(msg);
+            CHECK(msg->decode(quote));
+            return quote.volume;
+        });
+    };
+
+    // The same message through an intermediate vector copied into a slot sized buffer, as done without the ring
+    std::vector<std::byte>     staging;
+    std::array<std::byte, 256> slot{};
+    BENCHMARK_ADVANCED("Encode to vector, copy, decode")(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&staging, &slot, i = std::uint64_t{}]() mutable {
+            staging.clear();
+            auto enc = make_encoder(staging);
+            CHECK(enc(Quote{++i, "ACME", 101.25, 101.5, 1000 + i}));
+            std::memcpy(slot.data(), staging.data(), staging.size());
+            Quote quote{};
+            auto  view = std::span<const std::byte>(slot.data(), staging.size());
+            auto  dec  = make_decoder(view);
+            CHECK(dec(quote));
+            return quote.volume;
+        });
+    };
+}
@@ -0,0 +1,31 @@
+# cbor_tags_generate_cddl(<target> CDDL <schema.cddl> HEADER <name.h> [NAMESPACE <namespace>])
+#
+# Generates a header of C++ types from a CDDL schema at build time, one type per rule, and puts it on the include path of <target>. The
+# namespace defaults to the name of the schema file. Needs the cddl_struct_generator tool, built with CBOR_TAGS_BUILD_TOOLS.
+function(cbor_tags_generate_cddl target)
+  cmake_parse_arguments(ARG "" "CDDL;HEADER;NAMESPACE" "" ${ARGN})
+  if(NOT ARG_CDDL OR NOT ARG_HEADER)
+    message(FATAL_ERROR "cbor_tags_generate_cddl: CDDL and HEADER are required")
+  endif()
+  if(NOT TARGET cddl_struct_generator)
+    message(FATAL_ERROR "cbor_tags_generate_cddl: cddl_struct_generator is not built, enable CBOR_TAGS_BUILD_TOOLS")
+  endif()
+
+  get_filename_component(schema ${ARG_CDDL} ABSOLUTE)
+  if(NOT ARG_NAMESPACE)
+    get_filename_component(ARG_NAMESPACE ${schema} NAME_WE)
+    string(MAKE_C_IDENTIFIER ${ARG_NAMESPACE} ARG_NAMESPACE)
+  endif()
+
+  set(output_dir ${CMAKE_CURRENT_BINARY_DIR}/cddl_generated/${target})
+  set(output ${output_dir}/${ARG_HEADER})
+  add_custom_command(
+    OUTPUT ${output}
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${output_dir}
+    COMMAND cddl_struct_generator ${schema} ${output} ${ARG_NAMESPACE}
+    DEPENDS cddl_struct_generator ${schema}
+    COMMENT "Generating ${ARG_HEADER} from ${ARG_CDDL}")
+
+  target_sources(${target} PRIVATE ${output})
+  target_include_directories(${target} PRIVATE ${output_dir})
+endfunction()
@@ -7,6 +7,8 @@
 #include "cbor_tags/cbor_simple.h"
 #include "cbor_tags/float16_ieee754.h"
 
+#include <array>
+#include <compare>
 #include <cstddef>
 #include <cstdint>
 #include <ranges>
@@ -38,7 +40,18 @@ enum class status_code : uint8_t {
     no_matching_tag_value_in_variant,
     invalid_container_size,
     out_of_memory,
-    error
+    error,
+    // Added after error so the values above stay stable
+    buffer_overflow,
+    would_block,
+    unknown_enum_name,
+    integer_overflow,
+    malformed,
+    nesting_too_deep,
+    invalid_schema,
+    schema_mismatch,
+    invalid_path,
+    not_found
 };
 
 constexpr std::string_view status_message(status_code s) {
@@ -62,6 +75,16 @@ constexpr std::string_view status_message(status_code s) {
     case status_code::invalid_container_size: return "Invalid container size";
     case status_code::out_of_memory: return "Out of memory";
     case status_code::error: return "Error";
+    case status_code::buffer_overflow: return "Buffer overflow";
+    case status_code::would_block: return "Would block";
+    case status_code::unknown_enum_name: return "Unknown enum name";
+    case status_code::integer_overflow: return "Integer overflow";
+    case status_code::malformed: return "Malformed";
+    case status_code::nesting_too_deep: return "Nesting too deep";
+    case status_code::invalid_schema: return "Invalid schema";
+    case status_code::schema_mismatch: return "Schema mismatch";
+    case status_code::invalid_path: return "Invalid path";
+    case status_code::not_found: return "Not found";
     default: return "Unknown status";
     }
 }
@@ -249,6 +272,53 @@ struct as_map {
 struct as_indefinite_map {};
 struct end_map {};
 
+// Stringref namespace, tag 256. Inside it every text or byte string long enough to be worth it is numbered, and repeats of it are
+// encoded as tag 25 references to that number. The wrapped value is referenced, not copied, and must outlive the encode or decode call.
+template <typename T> class stringref_namespace {
+  public:
+    static constexpr std::uint64_t cbor_tag = 256;
+
+    constexpr explicit stringref_namespace(T &value) noexcept : value_(value) {}
+    constexpr T &value() const noexcept { return value_; }
+
+  private:
+    T &value_;
+};
+
+template <typename T> stringref_namespace(T &) -> stringref_namespace<T>;
+
+// Packed CBOR, tag 113. Strings repeated often enough are moved to a shared item table and referred to by index, common prefixes are
+// moved to an argument table and only the rest of the string is written. The tables are chosen from a counting pass over the value
+// before it is written. The decoder resolves references in place of strings, views into the buffer cannot hold a string that was
+// split off a prefix. The wrapped value is referenced, not copied, and must outlive the encode or decode call.
+template <typename T> class packed {
+  public:
+    static constexpr std::uint64_t cbor_tag = 113;
+
+    constexpr explicit packed(T &value) noexcept : value_(value) {}
+    constexpr T &value() const noexcept { return value_; }
+
+  private:
+    T &value_;
+};
+
+template <typename T> packed(T &) -> packed<T>;
+
+// UUID (RFC 9562), tag 37 and a 16 byte string in network byte order. Untagged ids can use std::array<std::byte, 16> directly, both
+// are decoded with a single copy.
+struct uuid {
+    static constexpr std::uint64_t cbor_tag = 37;
+    std::array<std::byte, 16>      bytes{};
+
+    friend constexpr auto operator<=>(const uuid &, const uuid &) = default;
+};
+
+// Enums are encoded as their underlying integer, unless they have names. Specialize enum_names with
+//     static constexpr std::array<std::pair<E, std::string_view>, N> values{...};
+// or a generated list such as magic_enum::enum_entries<E>(), and named values are encoded as text strings. Values without a name are
+// still encoded as integers, and the decoder accepts both. Names are found through a perfect hash built at compile time.
+template <typename E> struct enum_names {};
+
 // Compile-time function to get CBOR major type
 template <IsCborMajor T> constexpr std::byte get_major_3_bit_tag() {
     if constexpr (IsUnsigned<T>) {
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <ranges>
+#include <span>
 #include <system_error>
 #include <type_traits>
 #include <utility>
@@ -40,6 +43,14 @@ concept ValidCborBuffer = requires(T) {
 template <typename T>
 concept IsContiguous = requires(T) { requires std::ranges::contiguous_range<T>; };
 
+// Chained buffers that expose their contiguous segments, see segmented_buffer
+template <typename T>
+concept IsSegmented = requires(const T &t) {
+    typename T::segment_type;
+    { t.segments() } -> std::ranges::random_access_range;
+    { t.cbegin().segment() } -> std::convertible_to<std::span<const std::byte>>;
+};
+
 // Forward declaration of float16_t, implementation that can be used is in float16_ieee754.h
 struct float16_t;
 
@@ -69,6 +80,16 @@ struct as_tag_any {
     std::uint64_t tag;
 };
 
+// One complete encoded item, captured as is when decoding and written back verbatim when encoding. The bytes are not owned, they
+// point into the buffer that was decoded.
+struct raw_cbor {
+    std::span<const std::byte> data;
+
+    friend constexpr bool operator==(const raw_cbor &lhs, const raw_cbor &rhs) noexcept {
+        return std::ranges::equal(lhs.data, rhs.data);
+    }
+};
+
 template <typename T>
 concept IsTextHeader = std::is_same_v<T, as_text_any>;
 
@@ -87,6 +108,33 @@ concept IsTagHeader = std::is_same_v<T, as_tag_any>;
 template <typename T>
 concept IsAnyHeader = IsArrayHeader<T> || IsMapHeader<T> || IsTagHeader<T> || IsTextHeader<T> || IsBinaryHeader<T>;
 
+template <typename T>
+concept IsRawCbor = std::is_same_v<T, raw_cbor>;
+
+template <typename T> class stringref_namespace;
+
+template <typename T> struct is_stringref_namespace : std::false_type {};
+template <typename T> struct is_stringref_namespace<stringref_namespace<T>> : std::true_type {};
+
+template <typename T>
+concept IsStringrefNamespace = is_stringref_namespace<T>::value;
+
+template <typename T> class packed;
+
+template <typename T> struct is_packed : std::false_type {};
+template <typename T> struct is_packed<packed<T>> : std::true_type {};
+
+template <typename T>
+concept IsPacked = is_packed<T>::value;
+
+// Tag 24 wrappers holding either a value or its encoded bytes, see embedded in cbor_embedded.h
+template <typename T>
+concept IsEmbedded = requires(const T &t) {
+    typename T::embedded_type;
+    { t.encoded() } -> std::convertible_to<std::span<const std::byte>>;
+    { t.decoded() };
+};
+
 template <typename T>
 concept IsFloat16 = std::is_same_v<T, float16_t>; // Do not require sizeof(T) == 2, let the memory layout be implementation defined
 
@@ -108,20 +156,58 @@ concept IsSimple = IsFloat16<T> || IsFloat32<T> || IsFloat64<T> || IsBool<T> ||
 template <typename T>
 concept IsEnum = std::is_enum_v<T>;
 
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef __int128          int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+
+// 128-bit integers are encoded as basic integers when they fit in 64 bits, otherwise as bignums (tags 2/3)
+template <typename T>
+concept IsInt128 = std::is_same_v<T, int128_t> || std::is_same_v<T, uint128_t>;
+#else
+template <typename T>
+concept IsInt128 = false;
+#endif
+
+// Arbitrary precision integers, encoded like IsInt128. magnitude() is the big-endian absolute value, assign() receives the same without
+// leading zeros.
+template <typename T>
+concept IsBignum = requires(const T &t, T &v, std::span<const std::byte> magnitude) {
+    { t.is_negative() } -> std::convertible_to<bool>;
+    { t.magnitude() } -> std::convertible_to<std::span<const std::byte>>;
+    v.assign(bool{}, magnitude);
+};
+
+// Decimal fractions (tag 4) and bigfloats (tag 5), see cbor_decimal.h
+template <typename Mantissa> struct decimal_fraction;
+template <typename Mantissa> struct bigfloat;
+
+template <typename T> struct is_decimal_or_bigfloat : std::false_type {};
+template <typename M> struct is_decimal_or_bigfloat<decimal_fraction<M>> : std::true_type {};
+template <typename M> struct is_decimal_or_bigfloat<bigfloat<M>> : std::true_type {};
+
+template <typename T>
+concept IsDecimalOrBigfloat = is_decimal_or_bigfloat<T>::value;
+
 template <typename T>
 concept IsEnumUnsigned = IsEnum<T> && std::is_unsigned_v<std::underlying_type_t<T>>;
 
 template <typename T>
 concept IsEnumSigned = IsEnum<T> && std::is_signed_v<std::underlying_type_t<T>>;
 
+template <typename E> struct enum_names;
+
+// Enums with a name table, see enum_names in cbor.h
+template <typename T>
+concept HasEnumNames = IsEnum<T> && requires { std::ranges::size(enum_names<T>::values); };
+
 template <typename T>
-concept IsUnsigned = (std::is_unsigned_v<T> && std::is_integral_v<T> && !IsSimple<T>);
+concept IsUnsigned = (std::is_unsigned_v<T> && std::is_integral_v<T> && !IsSimple<T> && !IsInt128<T>);
 
 template <typename T>
 concept IsUnsignedOrEnum = IsUnsigned<T> || IsEnumUnsigned<T>;
 
 template <typename T>
-concept IsSigned = ((std::is_signed_v<T> && std::is_integral_v<T> && !IsSimple<T>) || std::is_same_v<T, integer>);
+concept IsSigned = ((std::is_signed_v<T> && std::is_integral_v<T> && !IsSimple<T> && !IsInt128<T>) || std::is_same_v<T, integer>);
 
 template <typename T>
 concept IsSignedOrEnum = IsSigned<T> || IsEnumSigned<T>;
@@ -143,6 +229,13 @@ concept IsTextString = IsTextHeader<T> || requires(T t) {
 template <typename T>
 concept IsBinaryString = IsBinaryHeader<T> || std::is_same_v<std::remove_cvref_t<std::ranges::range_value_t<T>>, std::byte>;
 
+template <typename T> struct is_byte_array : std::false_type {};
+template <std::size_t N> struct is_byte_array<std::array<std::byte, N>> : std::true_type {};
+
+// Byte strings with a length fixed at compile time, e.g ids and hashes, decoded with one copy straight into the array
+template <typename T>
+concept IsFixedBinaryString = IsBinaryString<T> && is_byte_array<T>::value;
+
 template <typename T>
 concept IsString = IsTextString<T> || IsBinaryString<T>;
 
@@ -153,9 +246,10 @@ template <typename T>
 concept IsFixedArray = requires {
     typename T::value_type;
     typename T::size_type;
-    typename std::tuple_size<T>::type;
-    requires std::is_same_v<T, std::array<typename T::value_type, std::tuple_size<T>::value>> ||
-                 std::is_same_v<T, std::span<typename T::value_type>>;
+    requires std::is_same_v<T, std::span<typename T::value_type>> || requires {
+        typename std::tuple_size<T>::type;
+        requires std::is_same_v<T, std::array<typename T::value_type, std::tuple_size<T>::value>>;
+    };
 };
 
 template <typename T>
@@ -186,7 +280,7 @@ concept IsTuple = requires {
 };
 
 template <typename T>
-concept IsAggregate = std::is_aggregate_v<T> && !IsFixedArray<T> && !IsAnyHeader<T>;
+concept IsAggregate = std::is_aggregate_v<T> && !IsFixedArray<T> && !IsAnyHeader<T> && !IsRawCbor<T>;
 
 template <std::uint64_t T> struct static_tag;
 template <IsUnsigned T> struct dynamic_tag;
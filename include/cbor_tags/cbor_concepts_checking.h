@@ -55,6 +55,11 @@ template <typename ByteType, typename... T> constexpr bool is_valid_major(ByteTy
         // Special case for signed types which can be either positive or negative
         if constexpr (IsEnum<U>) {
             using enum_type = std::underlying_type_t<Type>;
+            if constexpr (HasEnumNames<Type>) {
+                if (m == static_cast<ByteType>(major_type::TextString)) {
+                    return true;
+                }
+            }
             return is_valid_major<ByteType, enum_type>(m);
 
         } else if constexpr (IsSigned<Type>) {
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_concepts.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+namespace cbor::tags {
+
+// The head of a data item (RFC 8949 3): major type, additional information and the argument, which is the value, length, count, tag
+// number or the bits of a float. Indefinite lengths and break have additional information 31 and an argument of zero.
+struct item_head {
+    major_type    major{};
+    std::byte     info{};
+    std::uint64_t argument{};
+
+    constexpr bool indefinite() const noexcept { return info == std::byte{31}; }
+    constexpr bool is_break() const noexcept { return major == major_type::Simple && indefinite(); }
+};
+
+// Forward only walk over the items of a buffer, one head or run of payload bytes at a time, without decoding into types or allocating.
+// Transcoders and tools build on this when they only need to look at the items, the decoder is for reading them into values.
+template <ValidCborBuffer Buffer> class cursor {
+  public:
+    using size_type = std::size_t;
+
+    static constexpr size_type default_max_depth = 256;
+
+    constexpr explicit cursor(const Buffer &buffer) : size_(std::ranges::size(buffer)) {
+        if constexpr (IsContiguous<Buffer>) {
+            data_ = reinterpret_cast<const std::byte *>(std::ranges::data(buffer));
+        } else {
+            position_ = std::ranges::cbegin(buffer);
+        }
+    }
+
+    constexpr size_type offset() const noexcept { return offset_; }
+    constexpr size_type remaining() const noexcept { return size_ - offset_; }
+    constexpr bool      at_end() const noexcept { return offset_ >= size_; }
+
+    // The next head. Incomplete if the buffer ends inside it, malformed for reserved additional information, an indefinite length on
+    // a type that has none, or a two byte simple value below 32.
+    constexpr status_code read_head(item_head &head) noexcept {
+        if (at_end()) {
+            return status_code::incomplete;
+        }
+        const auto initial = next();
+        head.major         = static_cast<major_type>(static_cast<std::uint8_t>(initial) >> 5);
+        head.info          = initial & std::byte{0x1f};
+        head.argument      = 0;
+
+        const auto info = static_cast<std::uint8_t>(head.info);
+        if (info < 24) {
+            head.argument = info;
+        } else if (info < 28) {
+            const auto length = size_type{1} << (info - 24);
+            if (remaining() < length) {
+                return status_code::incomplete;
+            }
+            for (size_type i = 0; i < length; ++i) {
+                head.argument = (head.argument << 8) | static_cast<std::uint64_t>(next());
+            }
+            if (info == 24 && head.major == major_type::Simple && head.argument < 32) {
+                return status_code::malformed;
+            }
+        } else if (info < 31 || head.major == major_type::UnsignedInteger || head.major == major_type::NegativeInteger ||
+                   head.major == major_type::Tag) {
+            return status_code::malformed;
+        }
+        return status_code::success;
+    }
+
+    // Passes the next n bytes to f as spans of contiguous bytes: one span for contiguous buffers, one per segment for chained buffers
+    // and small staged blocks for other buffers
+    template <typename F> constexpr status_code read_bytes(std::uint64_t n, F &&f) {
+        if (remaining() < n) {
+            return status_code::incomplete;
+        }
+        auto count = static_cast<size_type>(n);
+        if constexpr (IsContiguous<Buffer>) {
+            f(std::span<const std::byte>(data_ + offset_, count));
+        } else if constexpr (IsSegmented<Buffer>) {
+            for (auto left = count; left > 0;) {
+                const auto segment = position_.segment().first(std::min(left, position_.segment().size()));
+                f(segment);
+                position_ += static_cast<std::iter_difference_t<decltype(position_)>>(segment.size());
+                left -= segment.size();
+            }
+        } else {
+            std::array<std::byte, 256> block;
+            for (auto left = count; left > 0;) {
+                const auto chunk = std::min(left, block.size());
+                for (size_type i = 0; i < chunk; ++i, ++position_) {
+                    block[i] = static_cast<std::byte>(*position_);
+                }
+                f(std::span<const std::byte>(block.data(), chunk));
+                left -= chunk;
+            }
+        }
+        offset_ += count;
+        return status_code::success;
+    }
+
+    constexpr status_code skip_bytes(std::uint64_t n) noexcept {
+        if (remaining() < n) {
+            return status_code::incomplete;
+        }
+        const auto count = static_cast<size_type>(n);
+        if constexpr (!IsContiguous<Buffer>) {
+            position_ = std::next(position_, static_cast<std::iter_difference_t<decltype(position_)>>(count));
+        }
+        offset_ += count;
+        return status_code::success;
+    }
+
+    // Skips one whole data item with everything nested in it
+    constexpr status_code skip(size_type max_depth = default_max_depth) noexcept {
+        item_head head;
+        if (auto status = read_head(head); status != status_code::success) {
+            return status;
+        }
+        return head.is_break() ? status_code::malformed : skip_content(head, max_depth);
+    }
+
+    // Skips what follows a head that was already read, e.g the elements of an array
+    constexpr status_code skip_content(const item_head &head, size_type max_depth = default_max_depth) noexcept {
+        switch (head.major) {
+        case major_type::ByteString:
+        case major_type::TextString: {
+            if (!head.indefinite()) {
+                return skip_bytes(head.argument);
+            }
+            for (item_head chunk;;) {
+                if (auto status = read_head(chunk); status != status_code::success) {
+                    return status;
+                }
+                if (chunk.is_break()) {
+                    return status_code::success;
+                }
+                if (chunk.major != head.major || chunk.indefinite()) {
+                    return status_code::malformed;
+                }
+                if (auto status = skip_bytes(chunk.argument); status != status_code::success) {
+                    return status;
+                }
+            }
+        }
+        case major_type::Array:
+        case major_type::Map:
+        case major_type::Tag: {
+            if (max_depth == 0) {
+                return status_code::nesting_too_deep;
+            }
+            if (head.indefinite()) {
+                for (std::uint64_t i = 0;; ++i) {
+                    item_head item;
+                    if (auto status = read_head(item); status != status_code::success) {
+                        return status;
+                    }
+                    if (item.is_break()) {
+                        return head.major == major_type::Map && i % 2 != 0 ? status_code::malformed : status_code::success;
+                    }
+                    if (auto status = skip_content(item, max_depth - 1); status != status_code::success) {
+                        return status;
+                    }
+                }
+            }
+            // Every item takes at least a byte, so counts past the rest of the buffer are cut off
+            const auto items = head.major == major_type::Tag ? 1 : head.argument;
+            if (items > remaining() || (head.major == major_type::Map && items > remaining() / 2)) {
+                return status_code::incomplete;
+            }
+            for (std::uint64_t i = 0; i < (head.major == major_type::Map ? items * 2 : items); ++i) {
+                if (auto status = skip(max_depth - 1); status != status_code::success) {
+                    return status;
+                }
+            }
+            return status_code::success;
+        }
+        default: return head.is_break() ? status_code::malformed : status_code::success;
+        }
+    }
+
+  private:
+    constexpr std::byte next() noexcept {
+        if constexpr (IsContiguous<Buffer>) {
+            return data_[offset_++];
+        } else {
+            const auto b = static_cast<std::byte>(*position_);
+            ++position_;
+            ++offset_;
+            return b;
+        }
+    }
+
+    // Picked lazily, std::span has no const_iterator in C++20
+    using iterator_t =
+        typename std::conditional_t<IsContiguous<Buffer>, std::type_identity<const std::byte *>, detail::iterator_type<Buffer>>::type;
+
+    const std::byte *data_{};     // Contiguous buffers
+    iterator_t       position_{}; // Other buffers
+    size_type        offset_{0};
+    size_type        size_;
+};
+
+} // namespace cbor::tags
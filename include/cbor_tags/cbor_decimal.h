@@ -0,0 +1,252 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace cbor::tags {
+
+namespace detail {
+
+// Mantissas that the conversions below work on, wider ones such as a user bignum can only be encoded and decoded
+template <typename T>
+concept IsFractionInteger = (std::signed_integral<T> && sizeof(T) <= 8) || (IsInt128<T> && static_cast<T>(-1) < 0);
+
+#if defined(__SIZEOF_INT128__)
+using fraction_magnitude = uint128_t;
+#else
+using fraction_magnitude = std::uint64_t;
+#endif
+
+template <IsFractionInteger T> constexpr fraction_magnitude magnitude_of(T value) noexcept {
+    const auto bits = static_cast<fraction_magnitude>(value);
+    return value < 0 ? fraction_magnitude{0} - bits : bits;
+}
+
+// Room for the digits of a 128-bit magnitude
+using decimal_digits_buffer = std::array<char, 40>;
+
+// Writes the decimal digits of value to the end of buffer, returns them
+constexpr std::string_view decimal_digits(fraction_magnitude value, decimal_digits_buffer &buffer) noexcept {
+    auto first = buffer.end();
+    do {
+        *--first = static_cast<char>('0' + static_cast<int>(value % 10));
+        value /= 10;
+    } while (value != 0);
+    return {first, buffer.end()};
+}
+
+// Exact text of (-1)^negative * digits * 10^exponent. Fixed is plain positional notation, scientific is d.ddde±xx with every digit
+// kept, general is the shorter of the two.
+inline std::to_chars_result decimal_to_chars(char *first, char *last, bool negative, std::string_view digits, std::int64_t exponent,
+                                             std::chars_format fmt) {
+    constexpr auto max_exponent = std::numeric_limits<std::int64_t>::max() / 2;
+    if (exponent > max_exponent || exponent < -max_exponent) {
+        return {last, std::errc::value_too_large};
+    }
+    const auto zero      = digits == "0";
+    const auto n         = static_cast<std::int64_t>(digits.size());
+    const auto point     = n + exponent; // Digits before the decimal point
+    const auto sci_exp   = point - 1;
+    const auto sci_abs   = static_cast<std::uint64_t>(sci_exp < 0 ? -sci_exp : sci_exp);
+    auto       exp_width = std::int64_t{2};
+    for (auto rest = sci_abs / 100; rest != 0; rest /= 10) {
+        ++exp_width;
+    }
+    const auto sci_len   = negative + n + (n > 1 ? 1 : 0) + 2 + exp_width;
+    const auto fixed_len = exponent >= 0 ? negative + (zero ? 1 : n + exponent)
+                           : point > 0   ? negative + n + 1
+                                         : negative + 2 - point + n;
+
+    const auto scientific = fmt == std::chars_format::scientific || (fmt == std::chars_format::general && sci_len < fixed_len);
+    const auto length     = scientific ? sci_len : fixed_len;
+    if (length > last - first) {
+        return {last, std::errc::value_too_large};
+    }
+
+    auto out = first;
+    if (negative) {
+        *out++ = '-';
+    }
+    if (scientific) {
+        *out++ = digits.front();
+        if (n > 1) {
+            *out++ = '.';
+            out    = std::ranges::copy(digits.substr(1), out).out;
+        }
+        *out++ = 'e';
+        *out++ = sci_exp < 0 ? '-' : '+';
+        if (sci_abs < 10) {
+            *out++ = '0';
+        }
+        return std::to_chars(out, last, sci_abs);
+    }
+    if (exponent >= 0) {
+        out = std::ranges::copy(digits, out).out;
+        if (!zero) {
+            out = std::fill_n(out, exponent, '0');
+        }
+    } else if (point > 0) {
+        out    = std::ranges::copy(digits.substr(0, static_cast<std::size_t>(point)), out).out;
+        *out++ = '.';
+        out    = std::ranges::copy(digits.substr(static_cast<std::size_t>(point)), out).out;
+    } else {
+        *out++ = '0';
+        *out++ = '.';
+        out    = std::fill_n(out, -point, '0');
+        out    = std::ranges::copy(digits, out).out;
+    }
+    return {out, std::errc{}};
+}
+
+} // namespace detail
+
+// Decimal fraction, tag 4: mantissa * 10^exponent, exact. The mantissa is a basic integer or a bignum on the wire, so it can be any
+// integer type the encoder handles, including int128_t and IsBignum types. Conversions to and from double and text are provided for
+// mantissas up to 128 bits and never allocate.
+template <typename Mantissa = std::int64_t> struct decimal_fraction {
+    static constexpr std::uint64_t cbor_tag = 4;
+
+    std::int64_t exponent{};
+    Mantissa     mantissa{};
+
+    constexpr decimal_fraction() = default;
+    constexpr decimal_fraction(std::int64_t exponent, Mantissa mantissa) : exponent(exponent), mantissa(std::move(mantissa)) {}
+
+    // The shortest decimal that reads back as value, as std::to_chars would print it. Empty for infinity and NaN.
+    static std::optional<decimal_fraction> from_double(double value) noexcept
+        requires detail::IsFractionInteger<Mantissa> && (sizeof(Mantissa) >= 8)
+    {
+        if (!std::isfinite(value)) {
+            return std::nullopt;
+        }
+        std::array<char, 32> text;
+        const auto           end = std::to_chars(text.data(), text.data() + text.size(), value, std::chars_format::scientific).ptr;
+
+        // [-]d[.ddd]e±xx with at most 17 digits
+        auto       it       = text.data();
+        const bool negative = *it == '-';
+        it += negative;
+        Mantissa     digits{};
+        std::int64_t fraction_digits = 0;
+        bool         in_fraction     = false;
+        for (; *it != 'e'; ++it) {
+            if (*it == '.') {
+                in_fraction = true;
+                continue;
+            }
+            digits = digits * 10 + (*it - '0');
+            fraction_digits += in_fraction;
+        }
+        ++it;
+        it += *it == '+';
+        int exp10 = 0;
+        std::from_chars(it, end, exp10);
+        return decimal_fraction{exp10 - fraction_digits, negative ? -digits : digits};
+    }
+
+    // Correctly rounded. Exact in double arithmetic when the mantissa fits in 53 bits and |exponent| <= 22, otherwise the exact
+    // decimal is rounded by std::from_chars.
+    double to_double() const noexcept
+        requires detail::IsFractionInteger<Mantissa>
+    {
+        static constexpr std::array<double, 23> powers{1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        const auto magnitude = detail::magnitude_of(mantissa);
+        const auto sign      = mantissa < 0 ? -1.0 : 1.0;
+        if (magnitude <= detail::fraction_magnitude{1} << 53 && exponent >= -22 && exponent <= 22) {
+            const auto value = static_cast<double>(magnitude);
+            return sign * (exponent < 0 ? value / powers[static_cast<std::size_t>(-exponent)]
+                                        : value * powers[static_cast<std::size_t>(exponent)]);
+        }
+        if (magnitude == 0 || exponent < -400) {
+            return sign * 0.0;
+        }
+        if (exponent > 400) {
+            return sign * std::numeric_limits<double>::infinity();
+        }
+        std::array<char, 64> text;
+        const auto           end   = to_chars(text.data(), text.data() + text.size(), std::chars_format::scientific).ptr;
+        double               value = 0;
+        if (std::from_chars(text.data(), end, value).ec == std::errc::result_out_of_range) {
+            return exponent > 0 ? sign * std::numeric_limits<double>::infinity() : sign * 0.0;
+        }
+        return value;
+    }
+
+    // The exact value as text, see detail::decimal_to_chars. Hex goes through to_double().
+    std::to_chars_result to_chars(char *first, char *last, std::chars_format fmt = std::chars_format::general) const
+        requires detail::IsFractionInteger<Mantissa>
+    {
+        if (fmt == std::chars_format::hex) {
+            return std::to_chars(first, last, to_double(), fmt);
+        }
+        detail::decimal_digits_buffer buffer;
+        return detail::decimal_to_chars(first, last, mantissa < 0, detail::decimal_digits(detail::magnitude_of(mantissa), buffer),
+                                        exponent, fmt);
+    }
+
+    // Compares the representation, 1e1 and 10e0 are different
+    friend constexpr bool operator==(const decimal_fraction &, const decimal_fraction &) = default;
+};
+
+// Bigfloat, tag 5: mantissa * 2^exponent, encoded like decimal_fraction
+template <typename Mantissa = std::int64_t> struct bigfloat {
+    static constexpr std::uint64_t cbor_tag = 5;
+
+    std::int64_t exponent{};
+    Mantissa     mantissa{};
+
+    constexpr bigfloat() = default;
+    constexpr bigfloat(std::int64_t exponent, Mantissa mantissa) : exponent(exponent), mantissa(std::move(mantissa)) {}
+
+    // Exact, with the trailing zero bits of the mantissa moved to the exponent. Empty for infinity and NaN.
+    static std::optional<bigfloat> from_double(double value) noexcept
+        requires detail::IsFractionInteger<Mantissa> && (sizeof(Mantissa) >= 8)
+    {
+        if (!std::isfinite(value)) {
+            return std::nullopt;
+        }
+        if (value == 0) {
+            return bigfloat{};
+        }
+        int  exp2     = 0;
+        auto mantissa = static_cast<std::int64_t>(std::ldexp(std::frexp(value, &exp2), std::numeric_limits<double>::digits));
+        auto exponent = static_cast<std::int64_t>(exp2) - std::numeric_limits<double>::digits;
+        while (mantissa % 2 == 0) {
+            mantissa /= 2;
+            ++exponent;
+        }
+        return bigfloat{exponent, static_cast<Mantissa>(mantissa)};
+    }
+
+    // Exact when the mantissa fits in 53 bits and the result is a normal double
+    double to_double() const noexcept
+        requires detail::IsFractionInteger<Mantissa>
+    {
+        constexpr std::int64_t limit = 4096; // Past any double, with room for a 128-bit mantissa
+        return std::ldexp(static_cast<double>(mantissa), static_cast<int>(std::clamp(exponent, -limit, limit)));
+    }
+
+    // The value of to_double() as std::to_chars prints it
+    std::to_chars_result to_chars(char *first, char *last, std::chars_format fmt = std::chars_format::general) const
+        requires detail::IsFractionInteger<Mantissa>
+    {
+        return std::to_chars(first, last, to_double(), fmt);
+    }
+
+    friend constexpr bool operator==(const bigfloat &, const bigfloat &) = default;
+};
+
+} // namespace cbor::tags
@@ -8,20 +8,27 @@
 #include "cbor_tags/cbor_reflection.h"
 #include "cbor_tags/float16_ieee754.h"
 
+#include <algorithm>
+#include <array>
 #include <bit>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 // #include <fmt/base.h>
 // #include <fmt/ranges.h>
 #include <exception>
 // #include <fmt/base.h>
 #include <iterator>
+#include <limits>
+#include <memory>
 // #include <magic_enum/magic_enum.hpp>
 // #include <nameof.hpp>
 #include <optional>
 #include <ranges>
 #include <span>
 #include <stdexcept>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <variant>
@@ -43,21 +50,35 @@ struct decoder : public Decoders<decoder<InputBuffer, Options, Decoders...>>...
     using expected_type   = typename Options::return_type;
     using unexpected_type = typename Options::error_type;
     using options         = Options;
+    using buffer_type     = InputBuffer;
 
     explicit decoder(const InputBuffer &data) : data_(data), reader_(data) {}
 
+    // Non-contiguous buffers with random access (e.g std::deque, segmented_buffer) copy strings in bulk instead of byte by byte
+    template <typename T>
+    static constexpr bool has_bulk_copy = !IsContiguous<InputBuffer> && std::random_access_iterator<iterator_t> && requires(T t) {
+        t.resize(std::size_t{});
+        { t.data() } -> std::convertible_to<const void *>;
+        requires sizeof(typename T::value_type) == 1;
+    };
+
     template <typename... T> expected_type operator()(T &&...args) noexcept {
         try {
             status_collector<self_t> collect_status{*this};
 
             auto success = (collect_status(args) && ...);
+            shared_.values.clear();
 
             if (!success) {
                 return unexpected<decltype(collect_status.result)>(collect_status.result);
             }
             return expected_type{};
-        } catch (const std::bad_alloc &) { return unexpected<status_code>(status_code::out_of_memory); } catch (const std::exception &) {
+        } catch (const std::bad_alloc &) {
+            shared_.values.clear();
+            return unexpected<status_code>(status_code::out_of_memory);
+        } catch (const std::exception &) {
             // std::rethrow_exception(std::current_exception());   // for debugging, this handling is TODO!
+            shared_.values.clear();
             return unexpected<status_code>(status_code::error); // placeholder
         }
     }
@@ -95,10 +116,145 @@ struct decoder : public Decoders<decoder<InputBuffer, Options, Decoders...>>...
         return status_code::success;
     }
 
+#if defined(__SIZEOF_INT128__)
+    // A basic integer or a bignum (tags 2/3) whose magnitude fits, leading zeros are allowed
+    template <IsInt128 T> constexpr status_code decode(T &value, major_type major, byte additionalInfo) {
+        constexpr bool is_signed = std::is_same_v<T, int128_t>;
+        constexpr auto invalid_major =
+            is_signed ? status_code::invalid_major_type_for_integer : status_code::invalid_major_type_for_unsigned_integer;
+
+        auto negative  = major == major_type::NegativeInteger;
+        auto magnitude = uint128_t{};
+        if (major == major_type::UnsignedInteger || major == major_type::NegativeInteger) {
+            magnitude = decode_unsigned(additionalInfo);
+        } else if (major == major_type::Tag) {
+            const auto tag = decode_unsigned(additionalInfo);
+            if (tag != 2 && tag != 3) {
+                return status_code::invalid_tag_value;
+            }
+            negative                             = tag == 3;
+            const auto [bytes_major, bytes_info] = read_initial_byte();
+            if (bytes_major != major_type::ByteString) {
+                return status_code::invalid_major_type_for_binary_string;
+            }
+            for (const auto b : bignum_bytes(decode_bstring(bytes_info))) {
+                if (magnitude >> 120 != 0) {
+                    return status_code::integer_overflow;
+                }
+                magnitude = (magnitude << 8) | static_cast<std::uint8_t>(b);
+            }
+        } else {
+            return invalid_major;
+        }
+
+        if constexpr (is_signed) {
+            if (magnitude > static_cast<uint128_t>(std::numeric_limits<int128_t>::max())) {
+                return status_code::integer_overflow;
+            }
+            value = negative ? -1 - static_cast<int128_t>(magnitude) : static_cast<int128_t>(magnitude);
+        } else {
+            if (negative) {
+                return major == major_type::Tag ? status_code::invalid_tag_value : invalid_major;
+            }
+            value = magnitude;
+        }
+        return status_code::success;
+    }
+#endif
+
+    // Hands the magnitude to the bignum without a copy when it is a positive bignum in a contiguous buffer. Otherwise it is copied to
+    // the stack, or the heap past 256 bits, with room for the carry of a negative value.
+    template <IsBignum T> constexpr status_code decode(T &value, major_type major, byte additionalInfo) {
+        std::array<byte, 33> small{};
+        std::vector<byte>    large;
+        std::span<byte>      magnitude;
+        bool                 negative = major == major_type::NegativeInteger;
+        if (major == major_type::UnsignedInteger || major == major_type::NegativeInteger) {
+            const auto n = decode_unsigned(additionalInfo);
+            magnitude    = std::span(small).first(9);
+            for (std::size_t i = 0; i < 8; ++i) {
+                magnitude[1 + i] = static_cast<byte>(n >> (8 * (7 - i)));
+            }
+        } else if (major == major_type::Tag) {
+            const auto tag = decode_unsigned(additionalInfo);
+            if (tag != 2 && tag != 3) {
+                return status_code::invalid_tag_value;
+            }
+            negative                             = tag == 3;
+            const auto [bytes_major, bytes_info] = read_initial_byte();
+            if (bytes_major != major_type::ByteString) {
+                return status_code::invalid_major_type_for_binary_string;
+            }
+            const auto bytes = decode_bstring(bytes_info);
+            if constexpr (IsContiguous<InputBuffer>) {
+                if (!negative) {
+                    value.assign(false, detail::strip_leading_zeros(bytes));
+                    return status_code::success;
+                }
+            }
+            const auto size = static_cast<std::size_t>(std::ranges::distance(bignum_bytes(bytes)));
+            if (size < small.size()) {
+                magnitude = std::span(small).first(size + 1);
+            } else {
+                large.resize(size + 1);
+                magnitude = large;
+            }
+            std::ranges::transform(bignum_bytes(bytes), magnitude.begin() + 1, [](auto b) { return static_cast<byte>(b); });
+        } else {
+            return status_code::invalid_major_type_for_integer;
+        }
+
+        if (negative) {
+            detail::increment_big_endian(magnitude);
+        }
+        value.assign(negative, detail::strip_leading_zeros(magnitude));
+        return status_code::success;
+    }
+
+    // The bytes of a decoded byte string, as a range
+    template <typename Bytes> static constexpr auto bignum_bytes(const Bytes &bytes) {
+        if constexpr (IsContiguous<InputBuffer>) {
+            return bytes;
+        } else {
+            return bytes.range;
+        }
+    }
+
+    template <IsDecimalOrBigfloat T> constexpr status_code decode(T &value, major_type major, byte additionalInfo) {
+        if (major != major_type::Tag) {
+            return status_code::invalid_major_type_for_tag;
+        }
+        if (decode_unsigned(additionalInfo) != T::cbor_tag) {
+            return status_code::invalid_tag_value;
+        }
+        const auto [array_major, array_info] = read_initial_byte();
+        if (array_major != major_type::Array) {
+            return status_code::invalid_major_type_for_array;
+        }
+        if (decode_unsigned(array_info) != 2) {
+            return status_code::invalid_container_size;
+        }
+        if (const auto status = decode(value.exponent); status != status_code::success) {
+            return status;
+        }
+        return decode(value.mantissa);
+    }
+
     template <IsBinaryString T> constexpr status_code decode(T &t, major_type major, byte additionalInfo) {
+        if (major == major_type::Tag && stringrefs_ != nullptr) [[unlikely]] {
+            return decode_stringref(t, additionalInfo);
+        }
+        if (packed_ != nullptr && (major == major_type::Simple || major == major_type::Tag)) [[unlikely]] {
+            return decode_packed(t, major, additionalInfo);
+        }
         if (major == major_type::ByteString) {
             auto bstring = decode_bstring(additionalInfo);
-            t            = T(bstring.begin(), bstring.end());
+            if constexpr (has_bulk_copy<T>) {
+                t.resize(std::ranges::size(bstring.range));
+                detail::copy_bytes(bstring.range.begin(), t.size(), t.data());
+            } else {
+                t = T(bstring.begin(), bstring.end());
+            }
         } else {
             // throw std::runtime_error("Invalid major type for binary string");
             return status_code::invalid_major_type_for_binary_string;
@@ -107,7 +263,55 @@ struct decoder : public Decoders<decoder<InputBuffer, Options, Decoders...>>...
         return status_code::success;
     }
 
+    // The length must match, the bytes are copied into the array without a view or temporary in between
+    template <IsFixedBinaryString T> constexpr status_code decode(T &t, major_type major, byte additionalInfo) {
+        constexpr auto size = std::tuple_size_v<T>;
+        if (major != major_type::ByteString) {
+            if constexpr (IsContiguous<InputBuffer>) {
+                if (stringrefs_ != nullptr || packed_ != nullptr) [[unlikely]] {
+                    std::span<const byte> bytes;
+                    if (const auto status = decode(bytes, major, additionalInfo); status != status_code::success) {
+                        return status;
+                    }
+                    if (bytes.size() != size) {
+                        return status_code::invalid_container_size;
+                    }
+                    std::ranges::copy(bytes, t.begin());
+                    return status_code::success;
+                }
+            }
+            return status_code::invalid_major_type_for_binary_string;
+        }
+        if (decode_unsigned(additionalInfo) != size) {
+            return status_code::invalid_container_size;
+        }
+        if constexpr (size > 0) {
+            if (reader_.empty(data_, size - 1)) {
+                return status_code::incomplete;
+            }
+        }
+
+        if constexpr (IsContiguous<InputBuffer>) {
+            const auto *first = reinterpret_cast<const byte *>(std::ranges::data(data_)) + reader_.position_;
+            std::memcpy(t.data(), first, size);
+            reader_.position_ += size;
+            if (stringrefs_ != nullptr) [[unlikely]] {
+                stringrefs_->record(std::span<const byte>(first, size), false);
+            }
+        } else {
+            detail::copy_bytes(reader_.position_, size, t.data());
+            reader_.position_ = std::next(reader_.position_, size);
+        }
+        return status_code::success;
+    }
+
     template <IsTextString T> constexpr status_code decode(T &t, major_type major, byte additionalInfo) {
+        if (major == major_type::Tag && stringrefs_ != nullptr) [[unlikely]] {
+            return decode_stringref(t, additionalInfo);
+        }
+        if (packed_ != nullptr && (major == major_type::Simple || major == major_type::Tag)) [[unlikely]] {
+            return decode_packed(t, major, additionalInfo);
+        }
         if (major == major_type::TextString) {
             t = decode_text(additionalInfo);
         } else {
@@ -350,14 +554,32 @@ struct decoder : public Decoders<decoder<InputBuffer, Options, Decoders...>>...
     }
 
     constexpr status_code decode(std::string &value, major_type major, byte additionalInfo) {
+        if (major == major_type::Tag && stringrefs_ != nullptr) [[unlikely]] {
+            return decode_stringref(value, additionalInfo);
+        }
+        if (packed_ != nullptr && (major == major_type::Simple || major == major_type::Tag)) [[unlikely]] {
+            return decode_packed(value, major, additionalInfo);
+        }
         if (major != major_type::TextString) {
             return status_code::invalid_major_type_for_text_string;
         }
-        value = std::string(decode_text(additionalInfo));
+        if constexpr (has_bulk_copy<std::string>) {
+            auto text = decode_text(additionalInfo);
+            value.resize(std::ranges::size(text.range));
+            detail::copy_bytes(text.range.begin(), value.size(), value.data());
+        } else {
+            value = std::string(decode_text(additionalInfo));
+        }
         return status_code::success;
     }
 
     constexpr status_code decode(std::string_view &value, major_type major, byte additionalInfo) {
+        if (major == major_type::Tag && stringrefs_ != nullptr) [[unlikely]] {
+            return decode_stringref(value, additionalInfo);
+        }
+        if (packed_ != nullptr && (major == major_type::Simple || major == major_type::Tag)) [[unlikely]] {
+            return decode_packed(value, major, additionalInfo);
+        }
         if (major != major_type::TextString) {
             return status_code::invalid_major_type_for_text_string;
         }
@@ -518,6 +740,335 @@ struct decoder : public Decoders<decoder<InputBuffer, Options, Decoders...>>...
         return status_code::success;
     }
 
+    template <IsStringrefNamespace T> constexpr status_code decode(T &value, major_type major, byte additionalInfo) {
+        static_assert(IsContiguous<InputBuffer>, "stringrefs refer back into the decoded buffer, which must be contiguous");
+        if (major != major_type::Tag) {
+            return status_code::invalid_major_type_for_tag;
+        }
+        if (decode_unsigned(additionalInfo) != T::cbor_tag) {
+            return status_code::invalid_tag_value;
+        }
+        detail::stringref_decode_table                 table;
+        detail::scoped_assign<decltype(stringrefs_)> scope(stringrefs_, &table);
+        detail::scoped_assign<decltype(packed_)>     not_packed(packed_, nullptr);
+        return decode(value.value());
+    }
+
+    template <IsPacked T> constexpr status_code decode(T &value, major_type major, byte additionalInfo) {
+        static_assert(IsContiguous<InputBuffer>, "packed tables refer into the decoded buffer, which must be contiguous");
+        if (major != major_type::Tag) {
+            return status_code::invalid_major_type_for_tag;
+        }
+        if (decode_unsigned(additionalInfo) != T::cbor_tag) {
+            return status_code::invalid_tag_value;
+        }
+        const auto [array_major, array_info] = read_initial_byte();
+        if (array_major != major_type::Array) {
+            return status_code::invalid_major_type_for_array;
+        }
+        if (decode_unsigned(array_info) != 3) {
+            return status_code::invalid_container_size;
+        }
+        detail::scoped_assign<decltype(stringrefs_)> no_stringrefs(stringrefs_, nullptr);
+        detail::packed_decode_table                  table;
+        for (auto *items : {&table.shared, &table.arguments}) {
+            if (const auto status = decode_packed_table(*items); status != status_code::success) {
+                return status;
+            }
+        }
+        detail::scoped_assign<decltype(packed_)> scope(packed_, &table);
+        return decode(value.value());
+    }
+
+    // Records where each table item is, strings can be referred to in place of a string, anything else is skipped
+    constexpr status_code decode_packed_table(std::vector<detail::packed_decode_table::entry> &items) {
+        const auto [major, additionalInfo] = read_initial_byte();
+        if (major != major_type::Array) {
+            return status_code::invalid_major_type_for_array;
+        }
+        const auto size = decode_unsigned(additionalInfo);
+        items.reserve(std::min<std::uint64_t>(size, data_.size()));
+        for (std::uint64_t i = 0; i < size; ++i) {
+            if (reader_.empty(data_)) {
+                return status_code::incomplete;
+            }
+            const auto [item_major, item_info] = read_initial_byte();
+            if ((item_major == major_type::ByteString || item_major == major_type::TextString) && item_info != static_cast<byte>(31)) {
+                items.push_back({decode_bstring(item_info), item_major == major_type::TextString, true});
+            } else if (const auto status = skip(item_major, item_info); status != status_code::success) {
+                return status;
+            } else {
+                items.push_back({{}, false, false});
+            }
+        }
+        return status_code::success;
+    }
+
+    // A shared item reference, simple(0..15) or tag 6, or a string following an argument reference, tags 224..255 and 28704..32767
+    template <typename T> constexpr status_code decode_packed(T &value, major_type major, byte additionalInfo) {
+        constexpr bool text     = IsTextString<T>;
+        constexpr auto mismatch =
+            text ? status_code::invalid_major_type_for_text_string : status_code::invalid_major_type_for_binary_string;
+        const auto usable = [&](const detail::packed_decode_table::entry &entry) { return entry.string && entry.text == text; };
+
+        if (major == major_type::Simple) {
+            const auto index = static_cast<std::size_t>(additionalInfo);
+            if (index >= 16) {
+                return mismatch;
+            }
+            if (index >= packed_->shared.size()) {
+                return status_code::invalid_tag_value;
+            }
+            return usable(packed_->shared[index]) ? assign_packed(value, packed_->shared[index].bytes, {}) : mismatch;
+        }
+
+        const auto tag = decode_unsigned(additionalInfo);
+        if (tag == 6) {
+            const auto [index_major, index_info] = read_initial_byte();
+            if (index_major != major_type::UnsignedInteger && index_major != major_type::NegativeInteger) {
+                return status_code::invalid_major_type_for_integer;
+            }
+            const auto offset = decode_unsigned(index_info);
+            if (offset >= packed_->shared.size()) {
+                return status_code::invalid_tag_value;
+            }
+            const auto index = 16 + 2 * offset + (index_major == major_type::NegativeInteger);
+            if (index >= packed_->shared.size()) {
+                return status_code::invalid_tag_value;
+            }
+            return usable(packed_->shared[index]) ? assign_packed(value, packed_->shared[index].bytes, {}) : mismatch;
+        }
+
+        auto index = std::uint64_t{};
+        if (tag >= 224 && tag < 256) {
+            index = tag - 224;
+        } else if (tag >= 28704 && tag < 32768) {
+            index = 32 + (tag - 28704);
+        } else {
+            return status_code::invalid_tag_value;
+        }
+        if (index >= packed_->arguments.size()) {
+            return status_code::invalid_tag_value;
+        }
+        const auto &argument             = packed_->arguments[index];
+        const auto [rest_major, rest_info] = read_initial_byte();
+        if (!usable(argument) || rest_major != (text ? major_type::TextString : major_type::ByteString)) {
+            return mismatch;
+        }
+        if constexpr (IsContiguous<InputBuffer>) {
+            return assign_packed(value, argument.bytes, decode_bstring(rest_info));
+        } else {
+            return status_code::error; // Not reached, packed CBOR is only decoded from contiguous buffers
+        }
+    }
+
+    // Strings in two parts need a type that can hold a copy, views cannot
+    template <typename T> constexpr status_code assign_packed(T &value, std::span<const byte> first, std::span<const byte> rest) {
+        using element_type = std::ranges::range_value_t<T>;
+        const auto *begin  = reinterpret_cast<const element_type *>(first.data());
+        if (rest.empty()) {
+            value = T(begin, begin + first.size());
+            return status_code::success;
+        }
+        if constexpr (requires(const element_type *p) { value.insert(value.end(), p, p); }) {
+            const auto *rest_begin = reinterpret_cast<const element_type *>(rest.data());
+            value                  = T(begin, begin + first.size());
+            value.insert(value.end(), rest_begin, rest_begin + rest.size());
+            return status_code::success;
+        } else {
+            return status_code::invalid_tag_value;
+        }
+    }
+
+    // A tag 25 reference in place of a string, to a string numbered earlier in the current namespace
+    template <typename T> constexpr status_code decode_stringref(T &value, byte additionalInfo) {
+        if (decode_unsigned(additionalInfo) != 25) {
+            return status_code::invalid_tag_value;
+        }
+        const auto [major, indexInfo] = read_initial_byte();
+        if (major != major_type::UnsignedInteger) {
+            return status_code::invalid_major_type_for_unsigned_integer;
+        }
+        const auto index = decode_unsigned(indexInfo);
+        if (index >= stringrefs_->strings.size()) {
+            return status_code::invalid_tag_value;
+        }
+
+        const auto &[bytes, text] = stringrefs_->strings[index];
+        if constexpr (IsTextString<T>) {
+            if (!text) {
+                return status_code::invalid_major_type_for_text_string;
+            }
+            value = std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        } else {
+            if (text) {
+                return status_code::invalid_major_type_for_binary_string;
+            }
+            value = T(bytes.begin(), bytes.end());
+        }
+        return status_code::success;
+    }
+
+    // A shareable value (tag 28) is numbered before its content is decoded, so the content can refer back to it. A reference (tag 29)
+    // resolves to the object decoded earlier in the same call, which must have been decoded as the same type.
+    template <typename T> constexpr status_code decode(std::shared_ptr<T> &value) {
+        using element_type = std::remove_cv_t<T>;
+        if (reader_.empty(data_)) {
+            return status_code::incomplete;
+        }
+        const auto initial = reader_.read(data_, 0);
+        if (initial == static_cast<byte>(0xF6)) {
+            reader_.read(data_);
+            value.reset();
+            return status_code::success;
+        }
+        if (static_cast<major_type>(initial >> 5) == major_type::Tag && (initial & static_cast<byte>(0x1F)) <= static_cast<byte>(27)) {
+            // The tag may be written in any head width. Any tag other than 28 and 29 belongs to T, so rewind and let T decode it.
+            const auto start            = reader_;
+            const auto [major, tagInfo] = read_initial_byte();
+            const auto tag              = decode_unsigned(tagInfo);
+            if (tag == 28) {
+                auto object = std::make_shared<element_type>();
+                shared_.values.push_back({object, &detail::type_key<element_type>});
+                value = object;
+                return decode(*object);
+            }
+            if (tag == 29) {
+                const auto [index_major, indexInfo] = read_initial_byte();
+                if (index_major != major_type::UnsignedInteger) {
+                    return status_code::invalid_major_type_for_unsigned_integer;
+                }
+                const auto index = decode_unsigned(indexInfo);
+                if (index >= shared_.values.size() || shared_.values[index].type != &detail::type_key<element_type>) {
+                    return status_code::invalid_tag_value;
+                }
+                value = std::static_pointer_cast<element_type>(shared_.values[index].object);
+                return status_code::success;
+            }
+            reader_ = start;
+        }
+        auto       object = std::make_shared<element_type>();
+        const auto status = decode(*object);
+        value             = std::move(object);
+        return status;
+    }
+
+    template <IsEmbedded T> constexpr status_code decode(T &value, major_type major, byte additionalInfo) {
+        static_assert(IsContiguous<InputBuffer>, "embedded refers into the decoded buffer, which must be contiguous");
+        if (major != major_type::Tag) {
+            return status_code::invalid_major_type_for_tag;
+        }
+        if (decode_unsigned(additionalInfo) != T::cbor_tag) {
+            return status_code::invalid_tag_value;
+        }
+        const auto [inner_major, inner_additional_info] = read_initial_byte();
+        if (inner_major != major_type::ByteString) {
+            return status_code::invalid_major_type_for_binary_string;
+        }
+        value.assign_encoded(decode_bstring(inner_additional_info));
+        return status_code::success;
+    }
+
+    constexpr status_code decode(raw_cbor &value, major_type major, byte additionalInfo) {
+        static_assert(IsContiguous<InputBuffer>, "raw_cbor refers into the decoded buffer, which must be contiguous");
+        const auto start  = reader_.position_ - 1; // The initial byte is already read
+        const auto status = skip(major, additionalInfo);
+        if (status == status_code::success) {
+            value.data = std::span<const byte>(reinterpret_cast<const byte *>(std::ranges::data(data_)) + start, reader_.position_ - start);
+        }
+        return status;
+    }
+
+    constexpr status_code decode(raw_cbor &value) {
+        if (reader_.empty(data_)) {
+            return status_code::incomplete;
+        }
+        const auto [major, additionalInfo] = read_initial_byte();
+        return decode(value, major, additionalInfo);
+    }
+
+    // Maximum nesting of indefinite length items that skip() can track, definite length items nest without limit
+    static constexpr std::size_t max_indefinite_depth = 64;
+
+    // Moves past the rest of an item whose initial byte is already read, including everything nested in it. Iterative, so hostile
+    // nesting cannot exhaust the call stack.
+    constexpr status_code skip(major_type major, byte additionalInfo, std::size_t namespaces = 0) {
+        std::uint64_t                                    pending{0}; // Items left in the enclosing definite containers
+        std::array<std::uint64_t, max_indefinite_depth> saved{};    // pending of the levels outside each open indefinite item
+        std::size_t                                      depth{0};
+        bool                                             in_indefinite_string{false}; // Indefinite strings only hold definite chunks
+        constexpr auto                                   indefinite = static_cast<byte>(31);
+
+        for (;;) {
+            if (major == major_type::Simple && additionalInfo == indefinite) {
+                if (pending != 0 || depth == 0) {
+                    return status_code::error; // Break outside of an indefinite length item
+                }
+                pending              = saved[--depth];
+                in_indefinite_string = false;
+            } else {
+                pending -= pending != 0;
+                switch (major) {
+                case major_type::UnsignedInteger:
+                case major_type::NegativeInteger: decode_unsigned(additionalInfo); break;
+                case major_type::ByteString:
+                case major_type::TextString:
+                case major_type::Array:
+                case major_type::Map:
+                    if (additionalInfo == indefinite) {
+                        if (depth == max_indefinite_depth) {
+                            return status_code::error;
+                        }
+                        saved[depth++]       = pending;
+                        pending              = 0;
+                        in_indefinite_string = major == major_type::ByteString || major == major_type::TextString;
+                    } else if (major == major_type::ByteString || major == major_type::TextString) {
+                        if (in_indefinite_string) {
+                            // Chunks of indefinite length strings are never numbered as stringrefs
+                            detail::scoped_assign<decltype(stringrefs_)> scope(stringrefs_, nullptr);
+                            decode_bstring(additionalInfo);
+                        } else {
+                            decode_bstring(additionalInfo, major);
+                        }
+                    } else {
+                        const auto size = decode_unsigned(additionalInfo);
+                        pending += major == major_type::Map ? 2 * size : size;
+                    }
+                    break;
+                case major_type::Tag:
+                    if (const auto tag = decode_unsigned(additionalInfo); tag == 256 && stringrefs_ != nullptr) [[unlikely]] {
+                        // A nested stringref namespace numbers its strings in a table of its own
+                        if (namespaces == max_indefinite_depth) {
+                            return status_code::error;
+                        }
+                        detail::stringref_decode_table                 nested;
+                        detail::scoped_assign<decltype(stringrefs_)> scope(stringrefs_, &nested);
+                        const auto [nested_major, nested_info] = read_initial_byte();
+                        if (const auto status = skip(nested_major, nested_info, namespaces + 1); status != status_code::success) {
+                            return status;
+                        }
+                    } else {
+                        if (tag == 28) {
+                            shared_.values.emplace_back(); // Numbered, but never decoded as an object
+                        }
+                        ++pending;
+                    }
+                    break;
+                case major_type::Simple:
+                    if (additionalInfo >= static_cast<byte>(24)) {
+                        read_unsigned(additionalInfo);
+                    }
+                    break;
+                }
+            }
+
+            if (pending == 0 && depth == 0) {
+                return status_code::success;
+            }
+            std::tie(major, additionalInfo) = read_initial_byte();
+        }
+    }
+
     template <typename T> constexpr status_code decode(T &value) {
         if (reader_.empty(data_)) {
             // throw std::runtime_error("Unexpected end of input");
@@ -544,7 +1095,7 @@ struct decoder : public Decoders<decoder<InputBuffer, Options, Decoders...>>...
         return -1 - static_cast<int64_t>(value);
     }
 
-    constexpr auto decode_bstring(byte additionalInfo) {
+    constexpr auto decode_bstring(byte additionalInfo, major_type major = major_type::ByteString) {
         auto length = decode_unsigned(additionalInfo);
         if (reader_.empty(data_, length - 1)) {
             throw std::runtime_error("Unexpected end of input");
@@ -553,6 +1104,9 @@ struct decoder : public Decoders<decoder<InputBuffer, Options, Decoders...>>...
         if constexpr (IsContiguous<InputBuffer>) {
             auto result = std::span<const byte>(reinterpret_cast<const byte *>(&data_[reader_.position_]), length);
             reader_.position_ += length;
+            if (stringrefs_ != nullptr) [[unlikely]] {
+                stringrefs_->record(result, major == major_type::TextString);
+            }
             return result;
         } else {
             auto it           = std::next(reader_.position_, length);
@@ -563,7 +1117,7 @@ struct decoder : public Decoders<decoder<InputBuffer, Options, Decoders...>>...
     }
 
     constexpr auto decode_text(byte additionalInfo) {
-        auto bytes = decode_bstring(additionalInfo);
+        auto bytes = decode_bstring(additionalInfo, major_type::TextString);
         if constexpr (IsContiguous<InputBuffer>) {
             return std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size());
         } else {
@@ -683,8 +1237,11 @@ struct decoder : public Decoders<decoder<InputBuffer, Options, Decoders...>>...
     }
 
     // Variadic friends only in c++26, must be public
-    const InputBuffer          &data_;
-    detail::reader<InputBuffer> reader_;
+    const InputBuffer              &data_;
+    detail::reader<InputBuffer>     reader_;
+    detail::stringref_decode_table *stringrefs_{nullptr}; // Set while decoding inside a stringref namespace
+    detail::shared_decode_table     shared_;              // Shareable values decoded in the current call
+    detail::packed_decode_table    *packed_{nullptr};     // Set while decoding inside packed CBOR
 };
 
 template <typename T> struct cbor_header_decoder {
@@ -723,6 +1280,11 @@ template <typename T> struct enum_decoder {
 
     template <IsEnum U> constexpr status_code decode(U &value, major_type major, std::byte additionalInfo) {
         using underlying_type = std::underlying_type_t<U>;
+        if constexpr (HasEnumNames<U>) {
+            if (major > major_type::NegativeInteger) {
+                return decode_name(value, major, additionalInfo);
+            }
+        }
         if constexpr (IsSigned<underlying_type>) {
             if (major > major_type::NegativeInteger) {
                 // throw std::runtime_error("Invalid major type for enum");
@@ -748,10 +1310,185 @@ template <typename T> struct enum_decoder {
         auto [major, additionalInfo] = detail::underlying<T>(this).read_initial_byte();
         return decode(value, major, additionalInfo);
     }
+
+    // Looks the name up without allocating, contiguous buffers are read through a view, which also resolves stringrefs and packed
+    // references, other buffers are copied to the stack
+    template <HasEnumNames U> constexpr status_code decode_name(U &value, major_type major, std::byte additionalInfo) {
+        using table = detail::enum_name_table<U>;
+        auto &self  = detail::underlying<T>(this);
+
+        std::optional<U> found;
+        if constexpr (IsContiguous<typename T::buffer_type>) {
+            std::string_view name;
+            if (const auto status = self.decode(name, major, additionalInfo); status != status_code::success) {
+                return status == status_code::invalid_major_type_for_text_string ? status_code::invalid_major_type_for_enum : status;
+            }
+            found = table::find(name);
+        } else {
+            if (major != major_type::TextString) {
+                return status_code::invalid_major_type_for_enum;
+            }
+            std::array<char, table::max_length> name{};
+            std::size_t                         size = 0;
+            for (const auto c : self.decode_bstring(additionalInfo, major_type::TextString).range) {
+                if (size < name.size()) {
+                    name[size] = static_cast<char>(c);
+                }
+                ++size;
+            }
+            if (size <= name.size()) {
+                found = table::find(std::string_view(name.data(), size));
+            }
+        }
+        if (!found) {
+            return status_code::unknown_enum_name;
+        }
+        value = *found;
+        return status_code::success;
+    }
+};
+
+// Time points from tag 1, integer or floating point epoch seconds, or tag 1001 extended time, durations from tag 1002. Times finer than
+// the target are rounded to the nearest tick, times outside its range are an integer_overflow. Unknown elective (unsigned) keys of
+// extended time are skipped, unknown critical (negative) keys are rejected.
+template <typename T> struct chrono_decoder {
+    template <typename Duration>
+        requires(!std::chrono::treat_as_floating_point_v<typename Duration::rep>)
+    constexpr status_code decode(std::chrono::time_point<std::chrono::system_clock, Duration> &value, major_type major,
+                                 std::byte additionalInfo) {
+        auto &self = detail::underlying<T>(this);
+        if (major != major_type::Tag) {
+            return status_code::invalid_major_type_for_tag;
+        }
+        const auto tag = self.decode_unsigned(additionalInfo);
+        if (tag != 1 && tag != 1001) {
+            return status_code::invalid_tag_value;
+        }
+        detail::epoch_time time;
+        if (const auto status = tag == 1 ? decode_epoch_time(time) : decode_extended_time(time); status != status_code::success) {
+            return status;
+        }
+        Duration since_epoch;
+        if (!detail::to_duration(time, since_epoch)) {
+            return status_code::integer_overflow;
+        }
+        value = std::chrono::time_point<std::chrono::system_clock, Duration>(since_epoch);
+        return status_code::success;
+    }
+
+    template <typename Rep, typename Period>
+        requires(!std::chrono::treat_as_floating_point_v<Rep>)
+    constexpr status_code decode(std::chrono::duration<Rep, Period> &value, major_type major, std::byte additionalInfo) {
+        auto &self = detail::underlying<T>(this);
+        if (major != major_type::Tag) {
+            return status_code::invalid_major_type_for_tag;
+        }
+        if (self.decode_unsigned(additionalInfo) != 1002) {
+            return status_code::invalid_tag_value;
+        }
+        detail::epoch_time time;
+        if (const auto status = decode_extended_time(time); status != status_code::success) {
+            return status;
+        }
+        return detail::to_duration(time, value) ? status_code::success : status_code::integer_overflow;
+    }
+
+    template <typename Duration>
+        requires(!std::chrono::treat_as_floating_point_v<typename Duration::rep>)
+    constexpr status_code decode(std::chrono::time_point<std::chrono::system_clock, Duration> &value) {
+        auto [major, additionalInfo] = detail::underlying<T>(this).read_initial_byte();
+        return decode(value, major, additionalInfo);
+    }
+
+    template <typename Rep, typename Period>
+        requires(!std::chrono::treat_as_floating_point_v<Rep>)
+    constexpr status_code decode(std::chrono::duration<Rep, Period> &value) {
+        auto [major, additionalInfo] = detail::underlying<T>(this).read_initial_byte();
+        return decode(value, major, additionalInfo);
+    }
+
+    // Tag 1 content
+    constexpr status_code decode_epoch_time(detail::epoch_time &time) {
+        auto &self                   = detail::underlying<T>(this);
+        auto [major, additionalInfo] = self.read_initial_byte();
+        if (major != major_type::Simple) {
+            time.nanoseconds = 0;
+            return decode_seconds(time.seconds, major, additionalInfo);
+        }
+        double seconds = 0;
+        switch (static_cast<std::uint8_t>(additionalInfo)) {
+        case 25: seconds = static_cast<double>(self.read_float16()); break;
+        case 26: seconds = self.read_float(); break;
+        case 27: seconds = self.read_double(); break;
+        default: return status_code::invalid_tag_for_simple;
+        }
+        const auto split = detail::split_seconds(seconds);
+        if (!split) {
+            return status_code::integer_overflow;
+        }
+        time = *split;
+        return status_code::success;
+    }
+
+    // Tags 1001 and 1002 content, a map with at least the seconds, key 1
+    constexpr status_code decode_extended_time(detail::epoch_time &time) {
+        auto      &self                  = detail::underlying<T>(this);
+        const auto [map_major, map_info] = self.read_initial_byte();
+        if (map_major != major_type::Map) {
+            return status_code::invalid_major_type_for_map;
+        }
+        time             = {};
+        bool has_seconds = false;
+        for (auto size = self.decode_unsigned(map_info); size > 0; --size) {
+            const auto [key_major, key_info] = self.read_initial_byte();
+            std::int64_t key                 = 0; // Any elective key but the seconds
+            if (key_major == major_type::UnsignedInteger) {
+                key = self.decode_unsigned(key_info) == 1 ? 1 : 0;
+            } else if (key_major == major_type::NegativeInteger) {
+                key = -1 - static_cast<std::int64_t>(std::min<std::uint64_t>(self.decode_unsigned(key_info), 63));
+            } else if (const auto status = self.skip(key_major, key_info); status != status_code::success) {
+                return status;
+            }
+
+            const auto [major, additionalInfo] = self.read_initial_byte();
+            if (key == 1) {
+                if (const auto status = decode_seconds(time.seconds, major, additionalInfo); status != status_code::success) {
+                    return status;
+                }
+                has_seconds = true;
+            } else if (const auto scale = detail::fraction_scale(key); scale != 0) {
+                if (major != major_type::UnsignedInteger) {
+                    return status_code::invalid_major_type_for_unsigned_integer;
+                }
+                const auto fraction = self.decode_unsigned(additionalInfo);
+                if (fraction >= static_cast<std::uint64_t>(1'000'000'000 / scale)) {
+                    return status_code::invalid_tag_value;
+                }
+                time.nanoseconds = static_cast<std::int64_t>(fraction) * scale;
+            } else if (key < 0) {
+                return status_code::invalid_tag_value;
+            } else if (const auto status = self.skip(major, additionalInfo); status != status_code::success) {
+                return status;
+            }
+        }
+        return has_seconds ? status_code::success : status_code::invalid_tag_value;
+    }
+
+    constexpr status_code decode_seconds(std::int64_t &seconds, major_type major, std::byte additionalInfo) {
+        if (major != major_type::UnsignedInteger && major != major_type::NegativeInteger) {
+            return status_code::invalid_major_type_for_integer;
+        }
+        const auto argument = detail::underlying<T>(this).decode_unsigned(additionalInfo);
+        if (argument > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+            return status_code::integer_overflow;
+        }
+        seconds = major == major_type::NegativeInteger ? -1 - static_cast<std::int64_t>(argument) : static_cast<std::int64_t>(argument);
+        return status_code::success;
+    }
 };
 
 template <typename InputBuffer> inline auto make_decoder(InputBuffer &buffer) {
-    return decoder<InputBuffer, Options<default_expected, default_wrapping>, cbor_header_decoder, enum_decoder>(buffer);
+    return decoder<InputBuffer, Options<default_expected, default_wrapping>, cbor_header_decoder, enum_decoder, chrono_decoder>(buffer);
 }
 
 } // namespace cbor::tags
\ No newline at end of file
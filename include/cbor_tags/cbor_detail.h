@@ -2,11 +2,26 @@
 
 #include "cbor_tags/cbor_concepts.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
 #include <concepts>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include <string_view>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace cbor::tags::detail {
 
@@ -17,6 +32,19 @@ struct appender;
 template <typename T> struct appender<T, false> {
     using value_type = T::value_type;
 
+    // Non-contiguous byte buffers (e.g std::deque, std::list) can stage small writes on the stack and insert them in bulk.
+    // Staging is only active between start_staging() and flush(), see encoder::operator(), otherwise every write goes straight through.
+    static constexpr bool        can_stage     = !IsContiguous<T> && !IsMap<T> && sizeof(value_type) == 1;
+    static constexpr std::size_t staging_bytes = 64;
+
+    struct staging_buffer {
+        std::array<value_type, staging_bytes> bytes;
+        std::size_t                           size{0};
+        bool                                  active{false};
+    };
+    struct no_staging {};
+    [[no_unique_address]] std::conditional_t<can_stage, staging_buffer, no_staging> staged_;
+
     constexpr void operator()(T &container, value_type value) {
         if constexpr (IsMap<T>) {
             const auto &[key, mapped_value] = value;
@@ -26,6 +54,15 @@ template <typename T> struct appender<T, false> {
                 container.insert_or_assign(key, mapped_value);
             }
         } else {
+            if constexpr (can_stage) {
+                if (staged_.active) {
+                    if (staged_.size == staging_bytes) {
+                        flush_staged(container);
+                    }
+                    staged_.bytes[staged_.size++] = value;
+                    return;
+                }
+            }
             container.push_back(value);
         }
     }
@@ -35,42 +72,567 @@ template <typename T> struct appender<T, false> {
         constexpr bool all_1_byte = ((sizeof(Ts) == 1) && ...);
         static_assert(all_1_byte, "multi_append requires all arguments to be 1 byte types");
 
+        if constexpr (can_stage) {
+            if (staged_.active) {
+                if (staged_.size + sizeof...(Ts) > staging_bytes) {
+                    flush_staged(container);
+                }
+                ((staged_.bytes[staged_.size++] = static_cast<value_type>(std::forward<Ts>(values))), ...);
+                return;
+            }
+        }
         container.insert(container.end(), {std::forward<Ts>(values)...});
     }
 
-    constexpr void operator()(T &container, std::span<const std::byte> values) {
-        container.insert(container.end(), reinterpret_cast<const value_type *>(values.data()),
-                         reinterpret_cast<const value_type *>(values.data() + values.size()));
+    // Byte ranges, only for byte buffers, so that decoding into e.g std::vector<std::string_view> can use operator()(T &, value_type)
+    constexpr void operator()(T &container, std::span<const std::byte> values)
+        requires(sizeof(value_type) == 1)
+    {
+        append_bytes(container, reinterpret_cast<const value_type *>(values.data()), values.size());
     }
-    constexpr void operator()(T &container, std::string_view value) {
-        container.insert(container.end(), reinterpret_cast<const value_type *>(value.data()),
-                         reinterpret_cast<const value_type *>(value.data() + value.size()));
+    constexpr void operator()(T &container, std::string_view value)
+        requires(sizeof(value_type) == 1)
+    {
+        append_bytes(container, reinterpret_cast<const value_type *>(value.data()), value.size());
+    }
+
+    constexpr void start_staging() noexcept {
+        if constexpr (can_stage) {
+            staged_.active = true;
+        }
+    }
+
+    // Writes out anything staged and stops staging
+    constexpr void flush(T &container) {
+        if constexpr (can_stage) {
+            flush_staged(container);
+            staged_.active = false;
+        }
+    }
+
+    // Drops anything staged, used when encoding failed half way
+    constexpr void discard_staged() noexcept {
+        if constexpr (can_stage) {
+            staged_.size   = 0;
+            staged_.active = false;
+        }
+    }
+
+  private:
+    constexpr void append_bytes(T &container, const value_type *data, std::size_t size) {
+        if constexpr (can_stage) {
+            if (staged_.active) {
+                if (staged_.size + size <= staging_bytes) {
+                    std::memcpy(staged_.bytes.data() + staged_.size, data, size);
+                    staged_.size += size;
+                    return;
+                }
+                flush_staged(container);
+            }
+        }
+        container.insert(container.end(), data, data + size);
+    }
+
+    constexpr void flush_staged(T &container) {
+        if constexpr (can_stage) {
+            // A single range insert, for std::deque this is a copy straight into the chunk storage at the back
+            container.insert(container.end(), staged_.bytes.data(), staged_.bytes.data() + staged_.size);
+            staged_.size = 0;
+        }
     }
 };
 
+// Fixed size buffers (std::array, std::span) never write past their end. Encoding keeps counting the bytes it would have written, so
+// the caller learns how much space was needed, and with skip_ set the first skip_ bytes of the stream are dropped instead, which lets
+// an encode that overflowed one buffer be resumed into the next.
 template <typename T> struct appender<T, true> {
     using size_type  = T::size_type;
     using value_type = T::value_type;
-    size_type head_{};
+    size_type head_{}; // Position in the encoded stream, may run past the end of the buffer
+    size_type skip_{}; // Bytes of the stream that went into earlier buffers
 
     template <typename... Ts> constexpr void multi_append(T &container, Ts &&...values) {
         static_assert(sizeof...(Ts) > 1, "multi_append requires at least 2 arguments, use operator() for single values");
         constexpr bool all_1_byte = ((sizeof(Ts) == 1) && ...);
         static_assert(all_1_byte, "multi_append requires all arguments to be 1 byte types");
-        ((container[head_++] = std::forward<Ts>(values)), ...);
+        if (fits(container, sizeof...(Ts))) [[likely]] {
+            auto *out = container.data() + (head_ - skip_);
+            ((*out++ = std::forward<Ts>(values)), ...);
+            head_ += sizeof...(Ts);
+        } else {
+            const value_type bytes[] = {std::forward<Ts>(values)...};
+            append_clipped(container, bytes, sizeof...(Ts));
+        }
     }
 
-    constexpr void operator()(T &container, value_type value) { container[head_++] = value; }
+    constexpr void operator()(T &container, value_type value) {
+        if (fits(container, 1)) [[likely]] {
+            container[head_++ - skip_] = value;
+        } else {
+            append_clipped(container, &value, 1);
+        }
+    }
     constexpr void operator()(T &container, std::span<const std::byte> values) {
-        std::memcpy(container.data() + head_, reinterpret_cast<const value_type *>(values.data()), values.size());
-        head_ += values.size();
+        append_clipped(container, reinterpret_cast<const value_type *>(values.data()), values.size());
     }
     constexpr void operator()(T &container, std::string_view value) {
-        std::memcpy(container.data() + head_, reinterpret_cast<const value_type *>(value.data()), value.size());
-        head_ += value.size();
+        append_clipped(container, reinterpret_cast<const value_type *>(value.data()), value.size());
+    }
+
+    constexpr bool      overflowed(const T &container) const noexcept { return head_ > skip_ + container.size(); }
+    constexpr size_type written(const T &container) const noexcept {
+        return head_ <= skip_ ? 0 : std::min<size_type>(head_ - skip_, container.size());
+    }
+
+    constexpr void start_staging() noexcept {}
+    constexpr void flush(T &) noexcept {}
+    constexpr void discard_staged() noexcept {}
+
+  private:
+    constexpr bool fits(const T &container, size_type n) const noexcept { return head_ >= skip_ && head_ + n <= skip_ + container.size(); }
+
+    // Writes only the part of [head_, head_ + n) that lands inside [skip_, skip_ + size)
+    constexpr void append_clipped(T &container, const value_type *data, size_type n) {
+        const auto first = std::max(head_, skip_);
+        const auto last  = std::min(head_ + n, skip_ + container.size());
+        if (first < last) {
+            if constexpr (std::is_trivially_copyable_v<value_type>) {
+                std::memcpy(container.data() + (first - skip_), data + (first - head_), last - first);
+            } else {
+                std::copy(data + (first - head_), data + (last - head_), container.data() + (first - skip_));
+            }
+        }
+        head_ += n;
+    }
+};
+
+// Stringrefs (tags 25/256): strings are numbered in order of appearance, but only when a reference to the next number is shorter
+// than repeating the string
+constexpr std::size_t min_stringref_length(std::uint64_t index) noexcept {
+    return index < 24 ? 3 : index < 256 ? 4 : index < 65536 ? 5 : index < 4294967296 ? 7 : 11;
+}
+
+// A string's bytes, text and byte strings with the same bytes are different items
+struct string_key {
+    std::string_view bytes;
+    bool             text;
+    auto             operator<=>(const string_key &) const = default;
+};
+
+struct string_key_hash {
+    std::size_t operator()(const string_key &k) const noexcept { return std::hash<std::string_view>{}(k.bytes) ^ k.text; }
+};
+
+struct stringref_encode_table {
+    std::unordered_map<string_key, std::uint64_t, string_key_hash> index;
+    std::uint64_t                                                  next{0};
+
+    // The number of an identical earlier string, otherwise numbers this one if it qualifies. The bytes must outlive the table.
+    std::optional<std::uint64_t> find_or_add(std::string_view bytes, bool text) {
+        if (bytes.size() < min_stringref_length(0)) {
+            return std::nullopt;
+        }
+        if (const auto it = index.find(string_key{bytes, text}); it != index.end()) {
+            return it->second;
+        }
+        if (bytes.size() >= min_stringref_length(next)) {
+            index.emplace(string_key{bytes, text}, next++);
+        }
+        return std::nullopt;
+    }
+
+    // Numbers a string that can never be referenced from here, to stay in step with the decoder
+    void skip(std::size_t size) noexcept { next += size >= min_stringref_length(next); }
+};
+
+struct stringref_decode_table {
+    struct entry {
+        std::span<const std::byte> bytes;
+        bool                       text;
+    };
+    std::vector<entry> strings;
+
+    void record(std::span<const std::byte> bytes, bool text) {
+        if (bytes.size() >= min_stringref_length(strings.size())) {
+            strings.push_back({bytes, text});
+        }
+    }
+};
+
+// Length of the initial byte and argument for value
+constexpr std::size_t header_length(std::uint64_t value) noexcept {
+    return value < 24 ? 1 : value <= 0xFF ? 2 : value <= 0xFFFF ? 3 : value <= 0xFFFFFFFF ? 5 : 9;
+}
+
+// Bignums (tags 2/3) are big-endian magnitudes, a negative bignum holds the magnitude of -1 - n, so one less than that of n
+constexpr std::span<const std::byte> strip_leading_zeros(std::span<const std::byte> bytes) noexcept {
+    const auto first = std::ranges::find_if(bytes, [](std::byte b) { return b != std::byte{0}; });
+    return bytes.subspan(static_cast<std::size_t>(first - bytes.begin()));
+}
+
+// Subtracts one from a nonzero value
+constexpr void decrement_big_endian(std::span<std::byte> bytes) noexcept {
+    for (auto it = bytes.rbegin(); it != bytes.rend(); ++it) {
+        if (*it != std::byte{0}) {
+            *it = static_cast<std::byte>(std::to_integer<unsigned>(*it) - 1);
+            return;
+        }
+        *it = std::byte{0xFF};
+    }
+}
+
+// Adds one, the caller leaves a leading zero byte for the carry when the bytes may all be 0xFF
+constexpr void increment_big_endian(std::span<std::byte> bytes) noexcept {
+    for (auto it = bytes.rbegin(); it != bytes.rend(); ++it) {
+        if (*it != std::byte{0xFF}) {
+            *it = static_cast<std::byte>(std::to_integer<unsigned>(*it) + 1);
+            return;
+        }
+        *it = std::byte{0};
+    }
+}
+
+// Time (tags 1, 1001 and 1002) as whole seconds and the nanoseconds after them, 0 <= nanoseconds < 10^9 also before the epoch
+struct epoch_time {
+    std::int64_t seconds{};
+    std::int64_t nanoseconds{};
+};
+
+template <typename Rep, typename Period> constexpr epoch_time split_seconds(std::chrono::duration<Rep, Period> value) {
+    const auto seconds = std::chrono::floor<std::chrono::seconds>(value);
+    return {seconds.count(), std::chrono::duration_cast<std::chrono::nanoseconds>(value - seconds).count()};
+}
+
+// Floating point seconds rounded to the nearest nanosecond, empty for NaN, infinity or past the 64-bit range
+inline std::optional<epoch_time> split_seconds(double value) {
+    if (!(value > -9.2e18 && value < 9.2e18)) {
+        return std::nullopt;
+    }
+    const auto seconds     = std::floor(value);
+    auto       nanoseconds = static_cast<std::int64_t>(std::round((value - seconds) * 1e9));
+    auto       whole       = static_cast<std::int64_t>(seconds);
+    if (nanoseconds == 1'000'000'000) {
+        nanoseconds = 0;
+        ++whole;
+    }
+    return epoch_time{whole, nanoseconds};
+}
+
+// The time in Duration, parts finer than it are rounded to the nearest tick. False if it does not fit.
+template <typename Duration> constexpr bool to_duration(epoch_time time, Duration &value) {
+    constexpr auto limit = std::chrono::duration<double>(Duration::max()).count();
+    if (!(static_cast<double>(time.seconds) > -limit && static_cast<double>(time.seconds) + 1 < limit)) {
+        return false;
+    }
+    const auto seconds = std::chrono::seconds{time.seconds};
+    const auto whole   = std::chrono::floor<Duration>(seconds);
+    const auto rest    = std::chrono::duration_cast<std::chrono::nanoseconds>(seconds - whole) + std::chrono::nanoseconds{time.nanoseconds};
+    value              = whole + std::chrono::round<Duration>(rest);
+    return true;
+}
+
+// Fractional seconds in extended time (tags 1001/1002) are keyed -3, -6 or -9 for milli, micro or nanoseconds
+constexpr std::int64_t fraction_scale(std::int64_t key) noexcept {
+    return key == -3 ? 1'000'000 : key == -6 ? 1'000 : key == -9 ? 1 : 0;
+}
+
+// The coarsest key that holds nanoseconds exactly
+constexpr std::int64_t fraction_key(std::int64_t nanoseconds) noexcept {
+    return nanoseconds % 1'000'000 == 0 ? -3 : nanoseconds % 1'000 == 0 ? -6 : -9;
+}
+
+// Packed CBOR (tags 113/6): shared item i is referred to by simple(i) for the first 16, after that by 6(n) for even and 6(-1-n) for
+// odd offsets from 16. Argument i is prepended to a string by tag 224 + i.
+constexpr std::size_t packed_reference_length(std::uint64_t index) noexcept {
+    return index < 16 ? 1 : 1 + header_length((index - 16) / 2);
+}
+
+struct packed_encode_table {
+    static constexpr std::size_t   max_arguments  = 32;
+    static constexpr std::uint64_t first_argument = 224;
+
+    std::unordered_map<string_key, std::uint64_t, string_key_hash> counts; // Occurrences, from the counting pass
+    std::unordered_map<string_key, std::uint64_t, string_key_hash> index;  // Shared item numbers
+    std::vector<string_key>                                        shared;
+    std::vector<string_key>                                        arguments;
+    bool                                                           counting{true};
+
+    void count(std::string_view bytes, bool text) { ++counts[string_key{bytes, text}]; }
+
+    std::optional<std::uint64_t> find_shared(std::string_view bytes, bool text) const {
+        if (const auto it = index.find(string_key{bytes, text}); it != index.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    // The argument that starts the string, selected arguments never start one another
+    std::optional<std::size_t> find_argument(std::string_view bytes, bool text) const {
+        for (std::size_t i = 0; i < arguments.size(); ++i) {
+            if (arguments[i].text == text && bytes.starts_with(arguments[i].bytes)) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Builds the tables from the counts. The most frequent strings get the shortest references, a string is only shared when the
+    // references and the table entry are smaller than writing it every time.
+    void select() {
+        using counted = std::pair<string_key, std::uint64_t>;
+        std::vector<counted> repeated;
+        std::vector<counted> rest;
+        for (const auto &entry : counts) {
+            (entry.second > 1 ? repeated : rest).push_back(entry);
+        }
+        std::ranges::sort(repeated, [](const counted &a, const counted &b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        for (const auto &[key, count] : repeated) {
+            const auto size = header_length(key.bytes.size()) + key.bytes.size();
+            if (size + count * packed_reference_length(shared.size()) < count * size) {
+                index.emplace(key, shared.size());
+                shared.push_back(key);
+            } else {
+                rest.emplace_back(key, count);
+            }
+        }
+        select_arguments(rest);
+        counting = false;
+    }
+
+  private:
+    // Once sorted, strings with a common prefix are adjacent, and the prefixes worth trying are the common prefixes of neighbours
+    void select_arguments(std::vector<std::pair<string_key, std::uint64_t>> &strings) {
+        std::ranges::sort(strings, {}, &std::pair<string_key, std::uint64_t>::first);
+        std::vector<std::uint64_t> uses_before(strings.size() + 1);
+        for (std::size_t i = 0; i < strings.size(); ++i) {
+            uses_before[i + 1] = uses_before[i] + strings[i].second;
+        }
+
+        std::vector<std::pair<std::uint64_t, string_key>> candidates; // Bytes saved, prefix
+        for (std::size_t i = 1; i < strings.size(); ++i) {
+            const auto &a = strings[i - 1].first;
+            const auto &b = strings[i].first;
+            if (a.text != b.text) {
+                continue;
+            }
+            auto length = static_cast<std::size_t>(std::ranges::mismatch(a.bytes, b.bytes).in1 - a.bytes.begin());
+            if (a.text) {
+                // Do not split a UTF-8 sequence, both halves must stay valid text
+                while (length > 0 && length < a.bytes.size() && (static_cast<unsigned char>(a.bytes[length]) & 0xC0) == 0x80) {
+                    --length;
+                }
+            }
+            const string_key prefix{a.bytes.substr(0, length), a.text};
+            const auto       first = std::ranges::lower_bound(strings, prefix, {}, &std::pair<string_key, std::uint64_t>::first);
+            const auto       last  = std::find_if_not(first, strings.end(), [&](const auto &s) {
+                return s.first.text == prefix.text && s.first.bytes.starts_with(prefix.bytes);
+            });
+            const auto uses  = uses_before[last - strings.begin()] - uses_before[first - strings.begin()];
+            const auto cost  = header_length(length) + length;
+            const auto saved = length > 2 ? uses * (length - 2) : 0; // Tag 224 + i takes two bytes
+            if (saved > cost) {
+                candidates.emplace_back(saved - cost, prefix);
+            }
+        }
+
+        std::ranges::sort(candidates, [](const auto &a, const auto &b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+        for (const auto &[saved, prefix] : candidates) {
+            if (arguments.size() == max_arguments) {
+                break;
+            }
+            const auto overlaps = std::ranges::any_of(arguments, [&](const string_key &argument) {
+                return argument.text == prefix.text &&
+                       (argument.bytes.starts_with(prefix.bytes) || prefix.bytes.starts_with(argument.bytes));
+            });
+            if (!overlaps) {
+                arguments.push_back(prefix);
+            }
+        }
+    }
+};
+
+struct packed_decode_table {
+    struct entry {
+        std::span<const std::byte> bytes;
+        bool                       text;
+        bool                       string; // Only strings can be referred to in place of a string
+    };
+    std::vector<entry> shared;
+    std::vector<entry> arguments;
+};
+
+// Shared values (tags 28/29): shareable values are numbered in order of appearance, and referred to by number. The address of
+// type_key<T> identifies the type a value was decoded as, so a reference cannot be resolved to an object of another type.
+template <typename T> inline constexpr char type_key{};
+
+struct shared_encode_table {
+    struct key {
+        const void *object;
+        const void *type;
+        bool        operator==(const key &) const = default;
+    };
+    struct key_hash {
+        std::size_t operator()(const key &k) const noexcept {
+            return std::hash<const void *>{}(k.object) ^ (std::hash<const void *>{}(k.type) << 1);
+        }
+    };
+
+    std::unordered_map<key, std::uint64_t, key_hash> index;
+    std::uint64_t                                    next{0};
+
+    // The number of an object seen earlier, otherwise numbers this one
+    std::optional<std::uint64_t> find_or_add(const void *object, const void *type) {
+        const auto [it, inserted] = index.try_emplace(key{object, type}, next);
+        if (inserted) {
+            ++next;
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    void clear() noexcept {
+        if (next != 0) {
+            index.clear();
+            next = 0;
+        }
     }
 };
 
+struct shared_decode_table {
+    struct entry {
+        std::shared_ptr<void> object; // Empty for values that were skipped, those cannot be referred to
+        const void           *type{nullptr};
+    };
+    std::vector<entry> values;
+};
+
+// Assigns value to slot for the lifetime of the object, then puts the previous value back
+template <typename T> struct scoped_assign {
+    T &slot;
+    T  previous;
+    constexpr scoped_assign(T &target, T value) : slot(target), previous(std::exchange(target, value)) {}
+    constexpr ~scoped_assign() { slot = previous; }
+};
+
+constexpr std::uint64_t fnv1a(std::string_view bytes) noexcept {
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (const char c : bytes) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+// Finalizer of splitmix64, gives a different hash of the same string for every seed
+constexpr std::uint64_t mix(std::uint64_t hash, std::uint64_t seed) noexcept {
+    hash ^= seed * 0x9e3779b97f4a7c15;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+    return hash ^ (hash >> 31);
+}
+
+// Names of an enum with enum_names, found through a perfect hash built at compile time (hash and displace). Names are spread over
+// buckets by one hash, and every bucket has a seed that sends its names to slots no other name uses. A lookup hashes the string once,
+// mixes twice and compares against the one name in its slot.
+template <HasEnumNames E> struct enum_name_table {
+    static constexpr auto &entries  = enum_names<E>::values;
+    static constexpr auto  size     = std::ranges::size(entries);
+    static constexpr auto  buckets  = size / 2 + 1;
+    static constexpr auto  capacity = std::bit_ceil(size + size / 4 + 1);
+    static_assert(size > 0, "enum_names must name at least one value");
+
+    struct layout {
+        std::array<std::uint32_t, buckets>  seeds{};
+        std::array<std::uint32_t, capacity> slots{}; // Entry index + 1, 0 if free
+        std::array<std::uint32_t, size>     by_value{};
+    };
+
+    static constexpr bool names_unique() {
+        std::array<std::string_view, size> names{};
+        std::ranges::transform(entries, names.begin(), [](const auto &entry) { return entry.second; });
+        std::ranges::sort(names);
+        return std::ranges::adjacent_find(names) == names.end();
+    }
+
+    static constexpr layout build() {
+        static_assert(names_unique(), "enum_names must not repeat a name");
+        layout result;
+        std::array<std::uint64_t, size>    hashes{};
+        std::array<std::size_t, size>      buckets_of{};
+        std::array<std::uint32_t, size>    order{};
+        std::array<std::uint32_t, buckets> counts{};
+        for (std::uint32_t i = 0; i < size; ++i) {
+            hashes[i]     = fnv1a(entries[i].second);
+            buckets_of[i] = mix(hashes[i], 0) % buckets;
+            order[i]      = i;
+            ++counts[buckets_of[i]];
+        }
+        // Names grouped by bucket, the fullest buckets first while most slots are free
+        const auto bucket = [&](std::uint32_t i) { return buckets_of[i]; };
+        std::ranges::sort(order, [&](std::uint32_t a, std::uint32_t b) {
+            return counts[bucket(a)] != counts[bucket(b)] ? counts[bucket(a)] > counts[bucket(b)] : bucket(a) < bucket(b);
+        });
+
+        for (std::size_t first = 0; first < size;) {
+            const auto b    = bucket(order[first]);
+            auto       last = first;
+            while (last < size && bucket(order[last]) == b) {
+                ++last;
+            }
+            for (std::uint32_t seed = 1;; ++seed) {
+                auto placed = first;
+                for (; placed < last; ++placed) {
+                    auto &slot = result.slots[mix(hashes[order[placed]], seed) & (capacity - 1)];
+                    if (slot != 0) {
+                        break;
+                    }
+                    slot = order[placed] + 1;
+                }
+                if (placed == last) {
+                    result.seeds[b] = seed;
+                    break;
+                }
+                for (auto i = first; i < placed; ++i) {
+                    result.slots[mix(hashes[order[i]], seed) & (capacity - 1)] = 0;
+                }
+            }
+            first = last;
+        }
+
+        for (std::uint32_t i = 0; i < size; ++i) {
+            result.by_value[i] = i;
+        }
+        std::ranges::sort(result.by_value, {}, [](std::uint32_t i) { return entries[i].first; });
+        return result;
+    }
+
+    static constexpr layout table = build();
+
+    static constexpr std::optional<E> find(std::string_view name) noexcept {
+        const auto hash = fnv1a(name);
+        const auto seed = table.seeds[mix(hash, 0) % buckets];
+        const auto slot = table.slots[mix(hash, seed) & (capacity - 1)];
+        if (slot != 0 && entries[slot - 1].second == name) {
+            return entries[slot - 1].first;
+        }
+        return std::nullopt;
+    }
+
+    static constexpr std::optional<std::string_view> name(E value) noexcept {
+        const auto it = std::ranges::lower_bound(table.by_value, value, {}, [](std::uint32_t i) { return entries[i].first; });
+        if (it != table.by_value.end() && entries[*it].first == value) {
+            return entries[*it].second;
+        }
+        return std::nullopt;
+    }
+
+    static constexpr std::size_t max_length =
+        std::ranges::max(entries, {}, [](const auto &entry) { return entry.second.size(); }).second.size();
+};
+
 template <typename T, bool IsContiguous = IsContiguous<T>>
     requires ValidCborBuffer<T>
 struct reader;
@@ -109,13 +671,52 @@ template <typename T> struct reader<T, false> {
         return result;
     }
 
+    constexpr value_type read(const T &, size_type offset) noexcept { return static_cast<value_type>(*std::next(position_, offset)); }
+};
+
+// Chained buffers, steps a pointer within the current segment and only does extra work at segment boundaries
+template <typename T>
+    requires IsSegmented<T>
+struct reader<T, false> {
+    using size_type  = T::size_type;
+    using value_type = std::byte;
+    using iterator   = typename T::const_iterator;
+    iterator position_;
+
+    constexpr reader(const T &container) : position_(container.cbegin()) {}
+
+    constexpr bool empty(const T &container) const noexcept { return position_.offset() >= container.size(); }
+    constexpr bool empty(const T &container, size_type offset) const noexcept { return position_.offset() + offset >= container.size(); }
+    constexpr value_type read(const T &) noexcept {
+        auto result = *position_;
+        ++position_;
+        return result;
+    }
     constexpr value_type read(const T &, size_type offset) noexcept {
-        throw std::runtime_error("Not implemented");
-        auto it = std::next(position_, offset);
-        return static_cast<value_type>(*it);
+        const auto segment = position_.segment();
+        return offset < segment.size() ? segment[offset] : *std::next(position_, offset);
     }
 };
 
+// Copies n bytes starting at first into out, one memcpy per segment for chained buffers
+template <typename Iterator, typename Byte> constexpr void copy_bytes(Iterator first, std::size_t n, Byte *out) {
+    static_assert(sizeof(Byte) == 1, "copy_bytes requires a byte sized output");
+    if constexpr (requires { first.segment(); }) {
+        while (n > 0) {
+            const auto segment = first.segment();
+            const auto count   = std::min(n, segment.size());
+            std::memcpy(out, segment.data(), count);
+            out += count;
+            n -= count;
+            first += static_cast<std::iter_difference_t<Iterator>>(count);
+        }
+    } else if constexpr (std::is_same_v<std::iter_value_t<Iterator>, Byte>) {
+        std::copy_n(first, n, out); // segment aware for e.g std::deque in most standard libraries
+    } else {
+        std::transform(first, std::next(first, n), out, [](auto c) { return static_cast<Byte>(c); });
+    }
+}
+
 template <typename Tuple> constexpr auto tuple_tail(Tuple &&tuple) {
     return std::apply([](auto &&, auto &&...tail) { return std::forward_as_tuple(std::forward<decltype(tail)>(tail)...); },
                       std::forward<Tuple>(tuple));
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace cbor::tags {
+
+// Encoded CBOR data item, tag 24 wrapping a byte string that holds the encoding of T. Decoding only records the byte string, T is
+// decoded from it on the first call to get(), so consumers that never look inside do not pay for it. The recorded bytes point into
+// the decoded buffer, and are written back verbatim when the wrapper is encoded again without being replaced.
+//
+// get() caches the decoded value in the wrapper, concurrent first calls on the same object must be synchronized by the caller.
+template <typename T> class embedded {
+  public:
+    using embedded_type                     = T;
+    static constexpr std::uint64_t cbor_tag = 24;
+
+    embedded() : value_(std::in_place) {}
+    embedded(T value) : value_(std::move(value)) {}
+
+    embedded &operator=(T value) {
+        value_ = std::move(value);
+        bytes_ = {};
+        return *this;
+    }
+
+    // Decodes T from the recorded bytes on first use
+    expected<const T *, status_code> get() const {
+        if (!value_) {
+            T    value{};
+            auto bytes  = bytes_;
+            auto dec    = make_decoder(bytes);
+            auto result = dec(value);
+            if (!result) {
+                return unexpected<status_code>(result.error());
+            }
+            value_ = std::move(value);
+        }
+        return &*value_;
+    }
+
+    // The encoded bytes when decoded, empty when holding a value that has not been encoded
+    std::span<const std::byte> encoded() const noexcept { return bytes_; }
+
+    // The value when constructed from one or already decoded by get()
+    const std::optional<T> &decoded() const noexcept { return value_; }
+
+    // Used by the decoder
+    void assign_encoded(std::span<const std::byte> bytes) noexcept {
+        bytes_ = bytes;
+        value_.reset();
+    }
+
+  private:
+    std::span<const std::byte> bytes_;
+    mutable std::optional<T>   value_;
+};
+
+} // namespace cbor::tags
@@ -10,16 +10,25 @@
 #include "cbor_tags/variant_handling.h"
 #include "tl/expected.hpp"
 
+#include <algorithm>
+#include <array>
 #include <bit>
 #include <bitset>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
+#include <memory>
+#include <span>
 // #include <fmt/base.h>
 // #include <nameof.hpp>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace cbor::tags {
 
@@ -42,14 +51,51 @@ struct encoder : Encoders<encoder<OutputBuffer, Options, Encoders...>>... {
 
     template <typename... T> expected_type operator()(const T &...args) noexcept {
         try {
+            appender_.start_staging();
             (encode(args), ...);
+            appender_.flush(data_);
+            shared_.clear();
+            if constexpr (IsFixedArray<OutputBuffer>) {
+                if (appender_.overflowed(data_)) {
+                    return unexpected<status_code>(status_code::buffer_overflow);
+                }
+            }
             return expected_type{};
-        } catch (const std::bad_alloc &) { return unexpected<status_code>(status_code::out_of_memory); } catch (...) {
+        } catch (const std::bad_alloc &) {
+            appender_.discard_staged();
+            shared_.clear();
+            return unexpected<status_code>(status_code::out_of_memory);
+        } catch (...) {
             // std::rethrow_exception(std::current_exception()); // for debugging, this handling is TODO!
+            appender_.discard_staged();
+            shared_.clear();
             return unexpected<status_code>(status_code::error);
         }
     }
 
+    // Fixed size buffers: the size of everything encoded so far, including what did not fit
+    constexpr size_type bytes_needed() const noexcept
+        requires IsFixedArray<OutputBuffer>
+    {
+        return appender_.head_;
+    }
+
+    // Fixed size buffers: bytes actually written into this buffer
+    constexpr size_type bytes_written() const noexcept
+        requires IsFixedArray<OutputBuffer>
+    {
+        return appender_.written(data_);
+    }
+
+    // Fixed size buffers: the following encode only writes the stream from offset onwards, so encoding the same values again after an
+    // overflow continues where the previous buffer ended, e.g resume_from(previous.bytes_written())
+    constexpr void resume_from(size_type offset) noexcept
+        requires IsFixedArray<OutputBuffer>
+    {
+        appender_.head_ = 0;
+        appender_.skip_ = offset;
+    }
+
     constexpr void encode_major_and_size(std::uint64_t value, byte_type majorType) {
         if (value < 24) {
             appender_(data_, static_cast<byte_type>(value) | majorType);
@@ -93,16 +139,160 @@ struct encoder : Encoders<encoder<OutputBuffer, Options, Encoders...>>... {
         }
     }
 
+#if defined(__SIZEOF_INT128__)
+    template <IsInt128 T> constexpr void encode(T value) {
+        bool negative = false;
+        if constexpr (std::is_same_v<T, int128_t>) {
+            negative = value < 0;
+        }
+        const auto magnitude = negative ? static_cast<uint128_t>(-1 - value) : static_cast<uint128_t>(value);
+        if (magnitude <= std::numeric_limits<std::uint64_t>::max()) {
+            encode_major_and_size(static_cast<std::uint64_t>(magnitude), static_cast<byte_type>(negative ? 0x20 : 0x00));
+            return;
+        }
+        std::array<std::byte, 16> bytes;
+        for (std::size_t i = 0; i < bytes.size(); ++i) {
+            bytes[i] = static_cast<std::byte>(magnitude >> (8 * (bytes.size() - 1 - i)));
+        }
+        encode_bignum(negative, detail::strip_leading_zeros(bytes));
+    }
+#endif
+
+    template <IsBignum T> constexpr void encode(const T &value) {
+        const auto magnitude = detail::strip_leading_zeros(value.magnitude());
+        const bool negative  = value.is_negative() && !magnitude.empty();
+        if (!negative) {
+            encode_bignum(false, magnitude);
+            return;
+        }
+        // -1 - n has the magnitude of n less one, worked out in a copy that is only on the heap past 256 bits
+        std::array<std::byte, 32> small;
+        std::vector<std::byte>    large;
+        std::span<std::byte>      lowered;
+        if (magnitude.size() <= small.size()) {
+            lowered = std::span(small).first(magnitude.size());
+        } else {
+            large.resize(magnitude.size());
+            lowered = large;
+        }
+        std::ranges::copy(magnitude, lowered.begin());
+        detail::decrement_big_endian(lowered);
+        encode_bignum(true, detail::strip_leading_zeros(lowered));
+    }
+
+    // A magnitude without leading zeros, already adjusted for a negative value. Up to 64 bits it is a basic integer, the preferred
+    // serialization, otherwise a bignum (tags 2/3).
+    constexpr void encode_bignum(bool negative, std::span<const std::byte> magnitude) {
+        if (magnitude.size() <= 8) {
+            std::uint64_t n = 0;
+            for (const auto b : magnitude) {
+                n = (n << 8) | std::to_integer<std::uint64_t>(b);
+            }
+            encode_major_and_size(n, static_cast<byte_type>(negative ? 0x20 : 0x00));
+            return;
+        }
+        encode_major_and_size(negative ? 3 : 2, static_cast<byte_type>(0xC0));
+        encode_major_and_size(magnitude.size(), static_cast<byte_type>(0x40));
+        appender_(data_, magnitude);
+    }
+
+    // Tag 4 or 5 and the array [exponent, mantissa], the mantissa is a basic integer or a bignum
+    template <IsDecimalOrBigfloat T> constexpr void encode(const T &value) {
+        encode_major_and_size(T::cbor_tag, static_cast<byte_type>(0xC0));
+        encode_major_and_size(2, static_cast<byte_type>(0x80));
+        encode(value.exponent);
+        encode(value.mantissa);
+    }
+
     template <std::uint64_t N> constexpr void encode(static_tag<N>) { encode_major_and_size(N, static_cast<byte_type>(0xC0)); }
     template <IsUnsigned T> constexpr void    encode(dynamic_tag<T> value) {
         encode_major_and_size(value.value, static_cast<byte_type>(0xC0));
     }
 
     template <IsString T> constexpr void encode(const T &value) {
+        if constexpr (std::ranges::contiguous_range<T>) {
+            if (packed_ != nullptr) [[unlikely]] {
+                const auto bytes = std::string_view(reinterpret_cast<const char *>(std::ranges::data(value)), std::ranges::size(value));
+                if (encode_packed(bytes, IsTextString<T>)) {
+                    return;
+                }
+            }
+        }
+        if (stringrefs_ != nullptr) [[unlikely]] {
+            if constexpr (std::ranges::contiguous_range<T>) {
+                const auto bytes = std::string_view(reinterpret_cast<const char *>(std::ranges::data(value)), std::ranges::size(value));
+                if (const auto index = stringrefs_->find_or_add(bytes, IsTextString<T>)) {
+                    encode_major_and_size(25, static_cast<byte_type>(0xC0));
+                    encode_major_and_size(*index, static_cast<byte_type>(0x00));
+                    return;
+                }
+            } else {
+                stringrefs_->skip(value.size());
+            }
+        }
         encode_major_and_size(value.size(), static_cast<byte_type>(get_major_3_bit_tag<T>()));
         appender_(data_, value);
     }
 
+    template <IsStringrefNamespace T> constexpr void encode(const T &value) {
+        encode_major_and_size(T::cbor_tag, static_cast<byte_type>(0xC0));
+        detail::stringref_encode_table                 table;
+        detail::scoped_assign<decltype(stringrefs_)> scope(stringrefs_, &table);
+        detail::scoped_assign<decltype(packed_)>     not_packed(packed_, nullptr);
+        encode(value.value());
+    }
+
+    template <IsPacked T> constexpr void encode(const T &value) {
+        detail::packed_encode_table table;
+        {
+            // Counting pass, nothing is written
+            std::span<byte_type>                                 none;
+            encoder<std::span<byte_type>, Options, Encoders...> counting(none);
+            counting.packed_ = &table;
+            counting.encode(value.value());
+        }
+        table.select();
+
+        encode_major_and_size(T::cbor_tag, static_cast<byte_type>(0xC0));
+        encode_major_and_size(3, static_cast<byte_type>(0x80));
+        for (const auto *items : {&table.shared, &table.arguments}) {
+            encode_major_and_size(items->size(), static_cast<byte_type>(0x80));
+            for (const auto &item : *items) {
+                encode_major_and_size(item.bytes.size(), static_cast<byte_type>(item.text ? 0x60 : 0x40));
+                appender_(data_, item.bytes);
+            }
+        }
+        detail::scoped_assign<decltype(packed_)>     scope(packed_, &table);
+        detail::scoped_assign<decltype(stringrefs_)> no_stringrefs(stringrefs_, nullptr);
+        encode(value.value());
+    }
+
+    // Counts the string in the counting pass, after that writes a reference to a shared item or the string minus its argument
+    constexpr bool encode_packed(std::string_view bytes, bool text) {
+        if (packed_->counting) {
+            packed_->count(bytes, text);
+            return false;
+        }
+        if (const auto index = packed_->find_shared(bytes, text)) {
+            if (*index < 16) {
+                appender_(data_, static_cast<byte_type>(0xE0 + *index));
+            } else {
+                const auto offset = *index - 16;
+                encode_major_and_size(6, static_cast<byte_type>(0xC0));
+                encode_major_and_size(offset / 2, static_cast<byte_type>(offset % 2 == 0 ? 0x00 : 0x20));
+            }
+            return true;
+        }
+        if (const auto argument = packed_->find_argument(bytes, text)) {
+            const auto rest = bytes.substr(packed_->arguments[*argument].bytes.size());
+            encode_major_and_size(detail::packed_encode_table::first_argument + *argument, static_cast<byte_type>(0xC0));
+            encode_major_and_size(rest.size(), static_cast<byte_type>(text ? 0x60 : 0x40));
+            appender_(data_, rest);
+            return true;
+        }
+        return false;
+    }
+
     template <IsArray T> constexpr void encode(const T &value) {
         encode_major_and_size(value.size(), static_cast<byte_type>(0x80));
         for (const auto &item : value) {
@@ -198,6 +388,121 @@ struct encoder : Encoders<encoder<OutputBuffer, Options, Encoders...>>... {
 
     constexpr void encode(std::nullptr_t) { appender_(data_, static_cast<byte_type>(0xF6)); }
 
+    // An object held by more than one shared_ptr is marked shareable (tag 28) where it is first seen, and referred to (tag 29) after
+    // that. An object owned by this pointer alone cannot be seen twice, so it is written without the tag.
+    template <typename T> constexpr void encode(const std::shared_ptr<T> &value) {
+        if (!value) {
+            encode(nullptr);
+            return;
+        }
+        if (value.use_count() > 1) {
+            if (const auto index = shared_.find_or_add(value.get(), &detail::type_key<std::remove_cv_t<T>>)) {
+                encode_major_and_size(29, static_cast<byte_type>(0xC0));
+                encode_major_and_size(*index, static_cast<byte_type>(0x00));
+                return;
+            }
+            encode_major_and_size(28, static_cast<byte_type>(0xC0));
+        }
+        encode(*value);
+    }
+
+    // Already encoded, written as is. Inside a stringref namespace it gets a namespace of its own, since its strings are not numbered.
+    // Shareable values inside it are not numbered either, so it must not hold any when shared_ptr values follow it.
+    constexpr void encode(const raw_cbor &value) {
+        if (stringrefs_ != nullptr) [[unlikely]] {
+            encode_major_and_size(256, static_cast<byte_type>(0xC0));
+        }
+        appender_(data_, value.data);
+    }
+
+    template <IsEmbedded T> constexpr void encode(const T &value) {
+        encode_major_and_size(T::cbor_tag, static_cast<byte_type>(0xC0));
+        if (const auto bytes = value.encoded(); bytes.data() != nullptr || !value.decoded()) {
+            // Written as is, never replaced by a stringref, which could not stand for the byte string tag 24 requires
+            encode_major_and_size(bytes.size(), static_cast<byte_type>(0x40));
+            appender_(data_, bytes);
+            if (stringrefs_ != nullptr) {
+                stringrefs_->skip(bytes.size());
+            }
+            return;
+        }
+
+        // The content is a separate item. Its strings are neither packed nor numbered and its shared values are numbered apart, but the
+        // byte string holding it is numbered.
+        auto size = std::size_t{};
+        {
+            detail::scoped_assign<decltype(stringrefs_)> scope(stringrefs_, nullptr);
+            detail::scoped_assign<decltype(packed_)>     not_packed(packed_, nullptr);
+            detail::shared_encode_table                  shared;
+            std::swap(shared_, shared);
+            if constexpr (IsContiguous<OutputBuffer> && !IsFixedArray<OutputBuffer>) {
+                size = encode_backpatched(*value.decoded());
+            } else {
+                // Without cheap insertion in the middle of the buffer, measure the item first
+                std::span<byte_type>                                 none;
+                encoder<std::span<byte_type>, Options, Encoders...> measure(none);
+                measure.encode(*value.decoded());
+                size = measure.bytes_needed();
+                encode_major_and_size(size, static_cast<byte_type>(0x40));
+                encode(*value.decoded());
+            }
+            std::swap(shared_, shared);
+        }
+        if (stringrefs_ != nullptr) {
+            stringrefs_->skip(size);
+        }
+    }
+
+    // Encodes value as the content of a byte string. Room for a one byte length argument is reserved up front, and the content is only
+    // moved when the final length needs a shorter or longer header.
+    template <typename T> constexpr std::size_t encode_backpatched(const T &value) {
+        constexpr std::size_t reserved = 2;
+        const auto            start    = data_.size();
+        appender_.multi_append(data_, static_cast<byte_type>(0x58), static_cast<byte_type>(0));
+        encode(value);
+
+        const auto content = data_.size() - start - reserved;
+        const auto header  = size_header(content, static_cast<byte_type>(0x40));
+        if (header.size() > reserved) {
+            data_.resize(data_.size() + header.size() - reserved);
+        }
+        if (header.size() != reserved) {
+            auto *base = std::ranges::data(data_) + start;
+            std::memmove(base + header.size(), base + reserved, content);
+        }
+        if (header.size() < reserved) {
+            data_.resize(data_.size() - (reserved - header.size()));
+        }
+        std::ranges::copy(header, std::ranges::data(data_) + start);
+        return content;
+    }
+
+    // The initial byte and argument encode_major_and_size() would write, as a small inline buffer
+    struct size_header_bytes {
+        std::array<byte_type, 9> bytes{};
+        std::size_t              size_{};
+        constexpr std::size_t    size() const noexcept { return size_; }
+        constexpr auto           begin() const noexcept { return bytes.begin(); }
+        constexpr auto           end() const noexcept { return bytes.begin() + size_; }
+    };
+
+    static constexpr size_header_bytes size_header(std::uint64_t value, byte_type majorType) {
+        size_header_bytes header;
+        if (value < 24) {
+            header.bytes[0] = static_cast<byte_type>(static_cast<byte_type>(value) | majorType);
+            header.size_    = 1;
+            return header;
+        }
+        const int width_index = value <= 0xFF ? 0 : value <= 0xFFFF ? 1 : value <= 0xFFFFFFFF ? 2 : 3;
+        const int width       = 1 << width_index;
+        header.bytes[0]       = static_cast<byte_type>(static_cast<byte_type>(24 + width_index) | majorType);
+        for (int i = 0; i < width; ++i) {
+            header.bytes[1 + i] = static_cast<byte_type>(value >> (8 * (width - 1 - i)));
+        }
+        header.size_ = 1 + width;
+        return header;
+    }
+
     constexpr void encode(simple value) {
         if (value.value < 24 || value.value > 31) {
             encode_major_and_size(value.value, static_cast<byte_type>(0xE0));
@@ -207,16 +512,88 @@ struct encoder : Encoders<encoder<OutputBuffer, Options, Encoders...>>... {
     }
 
     // Variadic friends only in c++26, must be public
-    detail::appender<OutputBuffer> appender_;
-    OutputBuffer                  &data_;
+    detail::appender<OutputBuffer>  appender_;
+    OutputBuffer                   &data_;
+    detail::stringref_encode_table *stringrefs_{nullptr}; // Set while encoding inside a stringref namespace
+    detail::shared_encode_table     shared_;              // Shareable values seen in the current call
+    detail::packed_encode_table    *packed_{nullptr};     // Set while encoding or counting inside packed CBOR
 };
 
 template <typename T> struct enum_encoder {
     template <IsEnum U> constexpr void encode(U value) {
+        if constexpr (HasEnumNames<U>) {
+            if (const auto name = detail::enum_name_table<U>::name(value)) {
+                detail::underlying<T>(this).encode(*name);
+                return;
+            }
+        }
         detail::underlying<T>(this).encode(static_cast<std::underlying_type_t<U>>(value));
     }
 };
 
+// System clock time points as tag 1 epoch seconds, an integer when whole, otherwise a float when that reads back exactly at the
+// precision of the time point and is no longer than extended time. Extended time, tag 1001, is {1: seconds, -3/-6/-9: fraction}.
+// Durations are tag 1002 in the same form. Parts finer than nanoseconds are not encoded.
+template <typename T> struct chrono_encoder {
+    template <typename Duration>
+        requires(!std::chrono::treat_as_floating_point_v<typename Duration::rep>)
+    constexpr void encode(const std::chrono::time_point<std::chrono::system_clock, Duration> &value) {
+        auto      &self        = detail::underlying<T>(this);
+        const auto since_epoch = value.time_since_epoch();
+        const auto time        = detail::split_seconds(since_epoch);
+        if (time.nanoseconds == 0) {
+            self.encode_major_and_size(1, static_cast<typename T::byte_type>(0xC0));
+            self.encode(time.seconds);
+            return;
+        }
+
+        const auto seconds   = static_cast<double>(time.seconds) + static_cast<double>(time.nanoseconds) / 1e9;
+        const auto single    = static_cast<double>(static_cast<float>(seconds)) == seconds;
+        const auto extended  = 3 + 1 + 1 + seconds_length(time.seconds) + 1 + fraction_length(time.nanoseconds);
+        const auto as_float  = std::size_t{2} + (single ? 4 : 8);
+        auto       read_back = Duration{};
+        if (const auto exact = detail::split_seconds(seconds);
+            as_float <= extended && exact && detail::to_duration(*exact, read_back) && read_back == since_epoch) {
+            self.encode_major_and_size(1, static_cast<typename T::byte_type>(0xC0));
+            if (single) {
+                self.encode(static_cast<float>(seconds));
+            } else {
+                self.encode(seconds);
+            }
+            return;
+        }
+        self.encode_major_and_size(1001, static_cast<typename T::byte_type>(0xC0));
+        encode_extended_time(time);
+    }
+
+    template <typename Rep, typename Period>
+        requires(!std::chrono::treat_as_floating_point_v<Rep>)
+    constexpr void encode(const std::chrono::duration<Rep, Period> &value) {
+        detail::underlying<T>(this).encode_major_and_size(1002, static_cast<typename T::byte_type>(0xC0));
+        encode_extended_time(detail::split_seconds(value));
+    }
+
+    constexpr void encode_extended_time(detail::epoch_time time) {
+        auto &self = detail::underlying<T>(this);
+        self.encode_major_and_size(time.nanoseconds == 0 ? 1 : 2, static_cast<typename T::byte_type>(0xA0));
+        self.encode(std::uint64_t{1});
+        self.encode(time.seconds);
+        if (time.nanoseconds != 0) {
+            const auto key = detail::fraction_key(time.nanoseconds);
+            self.encode(key);
+            self.encode(static_cast<std::uint64_t>(time.nanoseconds / detail::fraction_scale(key)));
+        }
+    }
+
+    static constexpr std::size_t seconds_length(std::int64_t seconds) noexcept {
+        return detail::header_length(static_cast<std::uint64_t>(seconds < 0 ? -1 - seconds : seconds));
+    }
+
+    static constexpr std::size_t fraction_length(std::int64_t nanoseconds) noexcept {
+        return detail::header_length(static_cast<std::uint64_t>(nanoseconds / detail::fraction_scale(detail::fraction_key(nanoseconds))));
+    }
+};
+
 template <typename T> struct cbor_variant_encoder {
     template <typename... Ts> constexpr void encode(const std::variant<Ts...> &value) {
         // encoding a variant is less strict than decoding
@@ -249,6 +626,6 @@ template <typename T> struct cbor_header_encoder {
 
 template <typename OutputBuffer> inline auto make_encoder(OutputBuffer &buffer) {
     return encoder<OutputBuffer, Options<default_expected, default_wrapping>, cbor_header_encoder, enum_encoder, cbor_optional_encoder,
-                   cbor_variant_encoder>(buffer);
+                   cbor_variant_encoder, chrono_encoder>(buffer);
 }
 } // namespace cbor::tags
\ No newline at end of file
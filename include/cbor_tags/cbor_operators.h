@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cbor_tags/cbor_concepts.h"
+#include "cbor_tags/cbor_detail.h"
 #include "cbor_tags/cbor_integer.h"
 #include "cbor_tags/cbor_simple.h"
 #include "cbor_tags/float16_ieee754.h"
@@ -76,7 +77,7 @@ struct variant_hasher {
 
         // Combine with value hash
         return std::visit(
-            [seed](const auto &arg) mutable -> size_t {
+            [seed](const auto &arg) -> size_t {
                 using T = std::decay_t<decltype(arg)>;
 
                 size_t value_hash;
@@ -87,12 +88,10 @@ struct variant_hasher {
                     value_hash =
                         std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char *>(std::data(arg)), std::size(arg)));
                 } else if constexpr (IsArray<T> || IsMap<T>) {
-                    // Hash each element in the container
-                    value_hash = 0;
+                    // Hash each element in the container, chained through the splitmix64 finalizer so the order counts
+                    value_hash = std::size(arg);
                     for (const auto &elem : arg) {
-                        // Combine hashes using FNV-1a-like algorithm
-                        value_hash ^= std::hash<std::decay_t<decltype(elem)>>{}(elem);
-                        value_hash *= 16777619;
+                        value_hash = detail::mix(value_hash, std::hash<std::decay_t<decltype(elem)>>{}(elem));
                     }
                 } else if constexpr (IsTag<T>) {
                     value_hash = std::hash<T>{}(arg);
@@ -107,10 +106,7 @@ struct variant_hasher {
                 }
 
                 // Combine the seed (index hash) with the value hash
-                // Using FNV-1a-like combining
-                seed ^= value_hash;
-                seed *= 16777619;
-                return seed;
+                return static_cast<size_t>(detail::mix(value_hash, seed));
             },
             v);
     }
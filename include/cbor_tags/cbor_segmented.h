@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace cbor::tags {
+
+// A read-only chain of contiguous byte segments, e.g a list of receive buffers, that can be decoded without flattening it first.
+// The segments are not owned, only the list of spans is. Empty segments are dropped on construction.
+struct segmented_buffer {
+    using value_type   = std::byte;
+    using size_type    = std::size_t;
+    using segment_type = std::span<const std::byte>;
+
+    class const_iterator {
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using iterator_concept  = std::random_access_iterator_tag;
+        using value_type        = std::byte;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const std::byte *;
+        using reference         = const std::byte &;
+
+        constexpr const_iterator() = default;
+        constexpr const_iterator(const segment_type *segment, const segment_type *last, size_type offset)
+            : segment_(segment), last_(last), offset_(offset) {
+            load_segment();
+        }
+
+        constexpr reference operator*() const noexcept { return *cur_; }
+        constexpr pointer   operator->() const noexcept { return cur_; }
+        constexpr reference operator[](difference_type n) const { return *(*this + n); }
+
+        constexpr const_iterator &operator++() noexcept {
+            ++offset_;
+            if (++cur_ == end_) {
+                ++segment_;
+                load_segment();
+            }
+            return *this;
+        }
+        constexpr const_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        constexpr const_iterator &operator--() noexcept {
+            if (segment_ == last_ || cur_ == segment_->data()) {
+                --segment_;
+                cur_ = end_ = segment_->data() + segment_->size();
+            }
+            --cur_;
+            --offset_;
+            return *this;
+        }
+        constexpr const_iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        // Skips whole segments at a time, O(number of segments crossed)
+        constexpr const_iterator &operator+=(difference_type n) noexcept {
+            offset_ += n;
+            while (n > 0) {
+                const auto left = end_ - cur_;
+                if (n < left) {
+                    cur_ += n;
+                    return *this;
+                }
+                n -= left;
+                ++segment_;
+                load_segment();
+            }
+            while (n < 0) {
+                if (segment_ == last_ || cur_ == segment_->data()) {
+                    --segment_;
+                    cur_ = end_ = segment_->data() + segment_->size();
+                }
+                const auto step = std::min<difference_type>(-n, cur_ - segment_->data());
+                cur_ -= step;
+                n += step;
+            }
+            return *this;
+        }
+        constexpr const_iterator &operator-=(difference_type n) noexcept { return *this += -n; }
+
+        friend constexpr const_iterator operator+(const_iterator it, difference_type n) noexcept { return it += n; }
+        friend constexpr const_iterator operator+(difference_type n, const_iterator it) noexcept { return it += n; }
+        friend constexpr const_iterator operator-(const_iterator it, difference_type n) noexcept { return it -= n; }
+        friend constexpr difference_type operator-(const const_iterator &lhs, const const_iterator &rhs) noexcept {
+            return static_cast<difference_type>(lhs.offset_) - static_cast<difference_type>(rhs.offset_);
+        }
+
+        friend constexpr bool operator==(const const_iterator &lhs, const const_iterator &rhs) noexcept {
+            return lhs.offset_ == rhs.offset_;
+        }
+        friend constexpr auto operator<=>(const const_iterator &lhs, const const_iterator &rhs) noexcept {
+            return lhs.offset_ <=> rhs.offset_;
+        }
+
+        // Absolute position in the chain
+        constexpr size_type offset() const noexcept { return offset_; }
+
+        // The contiguous bytes left in the current segment, starting at this position
+        constexpr segment_type segment() const noexcept { return segment_type(cur_, end_); }
+
+      private:
+        constexpr void load_segment() noexcept {
+            if (segment_ != last_) {
+                cur_ = segment_->data();
+                end_ = cur_ + segment_->size();
+            } else {
+                cur_ = end_ = nullptr;
+            }
+        }
+
+        const segment_type *segment_{nullptr};
+        const segment_type *last_{nullptr};
+        const std::byte    *cur_{nullptr};
+        const std::byte    *end_{nullptr};
+        size_type           offset_{0};
+    };
+    using iterator = const_iterator;
+
+    segmented_buffer() = default;
+
+    explicit segmented_buffer(std::vector<segment_type> segments) : segments_(std::move(segments)) {
+        std::erase_if(segments_, [](const segment_type &s) { return s.empty(); });
+        for (const auto &s : segments_) {
+            size_ += s.size();
+        }
+    }
+
+    // Any range of contiguous byte-sized chunks, e.g std::deque<std::vector<std::byte>> or std::list<std::array<char, 4096>>
+    template <std::ranges::input_range R>
+        requires std::ranges::contiguous_range<std::ranges::range_value_t<R>> &&
+                 (sizeof(std::ranges::range_value_t<std::ranges::range_value_t<R>>) == 1) &&
+                 (!std::is_same_v<std::remove_cvref_t<R>, std::vector<segment_type>>)
+    explicit segmented_buffer(R &&chunks) {
+        for (auto &&chunk : chunks) {
+            if (!std::ranges::empty(chunk)) {
+                segments_.emplace_back(reinterpret_cast<const std::byte *>(std::ranges::data(chunk)), std::ranges::size(chunk));
+                size_ += std::ranges::size(chunk);
+            }
+        }
+    }
+
+    // A joined view of chunks is decoded through its underlying chunks, so the segment boundaries are not lost
+    template <typename V> explicit segmented_buffer(std::ranges::join_view<V> joined) : segmented_buffer(joined.base()) {}
+
+    const_iterator begin() const noexcept { return {segments_.data(), segments_.data() + segments_.size(), 0}; }
+    const_iterator end() const noexcept { return {segments_.data() + segments_.size(), segments_.data() + segments_.size(), size_}; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    size_type size() const noexcept { return size_; }
+    bool      empty() const noexcept { return size_ == 0; }
+
+    std::span<const segment_type> segments() const noexcept { return segments_; }
+
+  private:
+    std::vector<segment_type> segments_;
+    size_type                 size_{0};
+};
+
+} // namespace cbor::tags
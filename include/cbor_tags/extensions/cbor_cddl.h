@@ -2,9 +2,19 @@
 #include "cbor_tags/cbor_decoder.h"
 #include "cbor_tags/cbor_integer.h"
 #include "cbor_tags/cbor_reflection.h"
+#include "cbor_tags/extensions/cbor_cddl_schema.h"
+#include "cbor_tags/extensions/cbor_json.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cbor_tags/cbor_concepts.h>
+#include <charconv>
+#include <cmath>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <fmt/base.h>
 #include <fmt/format.h>
 #include <functional>
@@ -13,7 +23,6 @@
 #include <nameof.hpp>
 #include <optional>
 #include <span>
-#include <stack>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -27,6 +36,8 @@ struct AnnotationOptions {
     size_t indent_level{0};
     size_t offset{0};
     size_t max_depth{std::numeric_limits<size_t>::max()};
+    size_t range_begin{0};
+    size_t range_end{std::numeric_limits<size_t>::max()};
 };
 
 struct CDDLOptions {
@@ -84,38 +95,187 @@ struct CDDLContext {
     }
 };
 
-using catch_all_variant = std::variant<positive, negative, as_text_any, as_bstr_any, as_array_any, as_map_any, as_tag_any, float16_t, float,
-                                       double, bool, std::nullptr_t>;
+// Two hex digits for each byte value
+inline constexpr auto annotation_hex = [] {
+    constexpr std::string_view digits = "0123456789abcdef";
+    std::array<char, 512>      table{};
+    for (std::size_t i = 0; i < 256; ++i) {
+        table[2 * i]     = digits[i >> 4];
+        table[2 * i + 1] = digits[i & 0xf];
+    }
+    return table;
+}();
+
+// One linear pass over the heads with the open containers on a fixed size stack. Heads are written from their decoded fields and
+// payloads are streamed from the cursor, so nothing is decoded into values or allocated.
+template <ValidCborBuffer CborBuffer, typename OutputBuffer> class annotator {
+  public:
+    annotator(const CborBuffer &buffer, OutputBuffer &output, AnnotationOptions options)
+        : cursor_(buffer), out_(output), options_(options) {}
+
+    status_code operator()() {
+        auto status = status_code::success;
+        while (status == status_code::success && cursor_.offset() < options_.range_end) {
+            if (cursor_.at_end()) {
+                status = depth_ == 0 ? status_code::success : status_code::incomplete;
+                break;
+            }
+            status = item();
+        }
+        out_.flush();
+        return status;
+    }
 
-template <typename Iterator> void format_bytes(auto &output_buffer, Iterator begin, Iterator end, AnnotationOptions options = {}) {
-    std::string indent(options.indent_level * 2, ' ');
-    std::string offset(options.offset, ' ');
+  private:
+    struct frame {
+        major_type    major;
+        bool          indefinite;
+        std::uint64_t items; // Left to read, or read so far when indefinite
+    };
 
-    const size_t bytes_per_line = options.max_depth == std::numeric_limits<size_t>::max()
-                                      ? std::distance(begin, end) // no wrapping if max_depth is max
-                                      : options.max_depth;
+    status_code item() {
+        const bool shown = cursor_.offset() >= options_.range_begin;
 
-    size_t current_count = 0;
-    bool   is_first_line = true;
+        item_head head;
+        if (auto status = cursor_.read_head(head); status != status_code::success) {
+            return status;
+        }
+        if (head.is_break()) {
+            if (depth_ == 0 || !stack_[depth_ - 1].indefinite ||
+                (stack_[depth_ - 1].major == major_type::Map && stack_[depth_ - 1].items % 2 != 0)) {
+                return status_code::malformed;
+            }
+            if (shown) {
+                write_head(head, depth_);
+            }
+            --depth_;
+            finished();
+            return status_code::success;
+        }
+        if (depth_ != 0 && (stack_[depth_ - 1].major == major_type::ByteString || stack_[depth_ - 1].major == major_type::TextString) &&
+            (head.major != stack_[depth_ - 1].major || head.indefinite())) {
+            return status_code::malformed;
+        }
+        if (shown) {
+            write_head(head, depth_);
+        }
 
-    while (begin != end) {
-        if (current_count == 0) {
-            if (!is_first_line) {
-                fmt::format_to(std::back_inserter(output_buffer), "\n");
+        switch (head.major) {
+        case major_type::ByteString:
+        case major_type::TextString: {
+            if (head.indefinite()) {
+                return open(head.major, true, 0);
             }
-            fmt::format_to(std::back_inserter(output_buffer), "{}{}", indent, offset);
-            is_first_line = false;
+            auto status = shown ? payload(head.argument, depth_ + 1) : cursor_.skip_bytes(head.argument);
+            finished();
+            return status;
         }
+        case major_type::Array:
+        case major_type::Map:
+        case major_type::Tag: {
+            if (head.indefinite()) {
+                return open(head.major, true, 0);
+            }
+            // Every item takes at least a byte, so counts past the rest of the buffer are cut off
+            const auto items = head.major == major_type::Tag ? 1 : head.argument;
+            if (items > cursor_.remaining() || (head.major == major_type::Map && items > cursor_.remaining() / 2)) {
+                return status_code::incomplete;
+            }
+            if (items == 0) {
+                finished();
+                return status_code::success;
+            }
+            return open(head.major, false, head.major == major_type::Map ? items * 2 : items);
+        }
+        default: finished(); return status_code::success;
+        }
+    }
 
-        fmt::format_to(std::back_inserter(output_buffer), "{:02x}", static_cast<std::uint8_t>(*begin));
-        ++begin;
+    status_code open(major_type major, bool indefinite, std::uint64_t items) {
+        if (depth_ == stack_.size()) {
+            return status_code::nesting_too_deep;
+        }
+        stack_[depth_++] = {major, indefinite, items};
+        return status_code::success;
+    }
 
-        ++current_count;
-        if (current_count >= bytes_per_line) {
-            current_count = 0;
+    // Counts a complete item against the containers it closes
+    void finished() {
+        while (depth_ != 0) {
+            auto &top = stack_[depth_ - 1];
+            if (top.indefinite) {
+                ++top.items;
+                return;
+            }
+            if (--top.items != 0) {
+                return;
+            }
+            --depth_;
         }
     }
-}
+
+    // The initial byte and the argument bytes apart, e.g 1a 000f4240
+    void write_head(const item_head &head, std::size_t depth) {
+        indent(depth);
+        const auto info = static_cast<std::uint8_t>(head.info);
+        hex(static_cast<std::uint8_t>(static_cast<std::uint8_t>(head.major) << 5 | info));
+        if (info >= 24 && info < 28) {
+            out_.put(' ');
+            for (int shift = 8 * ((1 << (info - 24)) - 1); shift >= 0; shift -= 8) {
+                hex(static_cast<std::uint8_t>(head.argument >> shift));
+            }
+        }
+        out_.put('\n');
+    }
+
+    // String bytes on the lines below the head, wrapped every max_depth bytes
+    status_code payload(std::uint64_t size, std::size_t depth) {
+        if (cursor_.remaining() < size) {
+            return status_code::incomplete;
+        }
+        if (size == 0) {
+            return status_code::success;
+        }
+        std::size_t column = 0;
+        indent(depth);
+        auto status = cursor_.read_bytes(size, [&](std::span<const std::byte> bytes) {
+            for (const auto b : bytes) {
+                if (column == options_.max_depth) {
+                    out_.put('\n');
+                    indent(depth);
+                    column = 0;
+                }
+                hex(static_cast<std::uint8_t>(b));
+                ++column;
+            }
+        });
+        out_.put('\n');
+        return status;
+    }
+
+    void hex(std::uint8_t value) {
+        auto *p = out_.reserve(2);
+        p[0]    = annotation_hex[2 * value];
+        p[1]    = annotation_hex[2 * value + 1];
+        out_.advance(p + 2);
+    }
+
+    void indent(std::size_t depth) {
+        constexpr std::string_view spaces = "                                ";
+        for (auto n = options_.offset + 3 * (options_.indent_level + depth); n != 0;) {
+            const auto run = std::min(n, spaces.size());
+            out_.put(spaces.substr(0, run));
+            n -= run;
+        }
+    }
+
+    cursor<CborBuffer>                                       cursor_;
+    json_writer<OutputBuffer>                                out_;
+    AnnotationOptions                                        options_;
+    std::array<frame, cursor<CborBuffer>::default_max_depth> stack_;
+    std::size_t                                              depth_{0};
+};
+
 } // namespace detail
 
 template <typename T> constexpr auto getName(const T &);
@@ -285,192 +445,217 @@ auto cddl_to(OutputBuffer &output_buffer, CDDLOptions options) {
     cddl_to(output_buffer, T{}, options);
 }
 
-template <typename CborBuffer, typename OutputBuffer>
-auto buffer_annotate(const CborBuffer &cbor_buffer, OutputBuffer &output_buffer, AnnotationOptions options = {}) {
-    if (cbor_buffer.empty()) {
-        return;
-    }
+// Writes the items in buffer as an indented hex dump, one head per line with string bytes on the lines below it. Only the items that
+// start in [range_begin, range_end) are written, the rest are walked through by their heads to keep track of the nesting.
+template <ValidCborBuffer CborBuffer, typename OutputBuffer>
+expected<void, status_code> buffer_annotate(const CborBuffer &cbor_buffer, OutputBuffer &output_buffer, AnnotationOptions options = {}) {
     if (options.diagnostic_data) {
         throw std::runtime_error("Diagnostic data not supported");
     }
+    const auto status = detail::annotator<CborBuffer, OutputBuffer>(cbor_buffer, output_buffer, options)();
+    if (status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    return {};
+}
 
-    auto dec = make_decoder(cbor_buffer);
-
-    detail::catch_all_variant value;
-    std::stack<size_t>        indent_stack;
-
-    auto indentation_visitor = [&indent_stack](auto &&value) {
-        if constexpr (IsArrayHeader<std::remove_cvref_t<decltype(value)>>) {
-            indent_stack.push(value.size + 1);
-            return true;
-        } else if constexpr (IsMapHeader<std::remove_cvref_t<decltype(value)>>) {
-            indent_stack.push(value.size * 2 + 1);
-            return true;
-        } else if constexpr (IsTagHeader<std::remove_cvref_t<decltype(value)>>) {
-            indent_stack.push(1 + 1);
-            return true;
-        } else {
-            return false;
-        }
-    };
-    constexpr auto string_size_visitor = [](auto &&value) {
-        if constexpr (IsTextHeader<std::remove_cvref_t<decltype(value)>>) {
-            return value.size;
-        } else if constexpr (IsBinaryHeader<std::remove_cvref_t<decltype(value)>>) {
-            return value.size;
-        } else {
-            return std::uint64_t{0};
+template <typename OutputBuffer> constexpr void cddl_prelude_to(OutputBuffer &buffer) {
+    fmt::format_to(std::back_inserter(buffer), "{}", cddl_prelude);
+}
+
+namespace detail {
+
+// Floats with a decimal point or an exponent so they read back as floats, in fixed notation for everyday magnitudes
+template <typename Writer, std::floating_point T> void diagnostic_float(Writer &out, T value) {
+    if (std::isnan(value)) {
+        out.put("NaN");
+        return;
+    }
+    if (std::isinf(value)) {
+        out.put(value < 0 ? "-Infinity" : "Infinity");
+        return;
+    }
+    const auto magnitude = std::abs(value);
+    const auto format    = magnitude == 0 || (magnitude >= T(1e-5) && magnitude < T(1e16)) ? std::chars_format::fixed
+                                                                                           : std::chars_format::scientific;
+
+    std::array<char, 40> text;
+    const auto           number   = std::string_view(text.data(), std::to_chars(text.data(), text.data() + text.size(), value, format).ptr);
+    const auto           exponent = std::min(number.find('e'), number.size());
+    out.put(number.substr(0, exponent));
+    if (number.find('.') == std::string_view::npos) {
+        out.put(".0");
+    }
+    if (exponent != number.size()) {
+        // e+05 as e+5
+        const auto digits = number.find_first_not_of('0', exponent + 2);
+        out.put(number.substr(exponent, 2));
+        out.put(digits == std::string_view::npos ? "0" : number.substr(digits));
+    }
+}
+
+// RFC 8949 8 diagnostic notation, written straight into the output through a small staging buffer, see json_writer
+template <ValidCborBuffer CborBuffer, typename OutputBuffer> class diagnostic_writer {
+  public:
+    diagnostic_writer(const CborBuffer &buffer, OutputBuffer &output) : cursor_(buffer), out_(output) {}
+
+    // The items of a CBOR sequence are separated by commas (RFC 8742), one per line
+    status_code operator()() {
+        auto status = status_code::success;
+        for (bool first = true; status == status_code::success && !cursor_.at_end(); first = false) {
+            if (!first) {
+                out_.put(",\n");
+            }
+            status = item(cursor<CborBuffer>::default_max_depth);
         }
-    };
+        out_.flush();
+        return status;
+    }
 
-    constexpr auto string_length_to_header_size = [](std::uint64_t length) {
-        if (length < 24) {
-            return 1;
-        } else if (length < 0xFF) {
-            return 2;
-        } else if (length < 0xFFFF) {
-            return 3;
-        } else if (length < 0xFFFFFFFF) {
-            return 5;
-        } else {
-            return 9;
+  private:
+    status_code item(std::size_t depth) {
+        item_head head;
+        if (auto status = cursor_.read_head(head); status != status_code::success) {
+            return status;
         }
-    };
+        return head.is_break() ? status_code::malformed : content(head, depth);
+    }
 
-    auto                  it   = dec.reader_.position_;
-    [[maybe_unused]] auto span = std::span<const std::byte>{};
-
-    while (dec(value)) {
-        auto next_it       = dec.reader_.position_;
-        auto should_indent = std::visit(indentation_visitor, value);
-
-        if constexpr (IsContiguous<CborBuffer>) {
-            span            = std::span<const std::byte>(reinterpret_cast<const std::byte *>(cbor_buffer.data() + it), next_it - it);
-            auto span_begin = span.begin();
-            auto span_end   = span.end();
-
-            if (std::holds_alternative<as_text_any>(value) || std::holds_alternative<as_bstr_any>(value)) {
-                auto size        = std::visit(string_size_visitor, value);
-                auto header_size = string_length_to_header_size(size);
-                detail::format_bytes(output_buffer, span_begin, span_begin + 1, options); // Major type
-                detail::format_bytes(output_buffer, span_begin + 1, span_begin + header_size,
-                                     {.indent_level = 0, .offset = 1}); // extra header
-                fmt::format_to(std::back_inserter(output_buffer), "\n");
-                options.indent_level++;
-                options.offset++;
-                detail::format_bytes(output_buffer, span_begin + header_size, span_end, options);
-                options.indent_level--;
-                options.offset--;
-            } else {
-                detail::format_bytes(output_buffer, span_begin, span_begin + 1, options);
-                detail::format_bytes(output_buffer, span_begin + 1, span_end, {.indent_level = 0, .offset = 1});
-            }
-        } else {
-            if (std::holds_alternative<as_text_any>(value) || std::holds_alternative<as_bstr_any>(value)) {
-                auto size        = std::visit(string_size_visitor, value);
-                auto header_size = string_length_to_header_size(size);
-                detail::format_bytes(output_buffer, it, it + 1, options);                                        // Major type
-                detail::format_bytes(output_buffer, it + 1, it + header_size, {.indent_level = 0, .offset = 1}); // extra header
-                fmt::format_to(std::back_inserter(output_buffer), "\n");
-                options.indent_level++;
-                options.offset++;
-                detail::format_bytes(output_buffer, it + header_size, next_it, options);
-                options.indent_level--;
-                options.offset--;
-            } else {
-                detail::format_bytes(output_buffer, it, it + 1, options);
-                detail::format_bytes(output_buffer, it + 1, next_it, {.indent_level = 0, .offset = 1});
+    status_code content(const item_head &head, std::size_t depth) {
+        switch (head.major) {
+        case major_type::UnsignedInteger:
+        case major_type::NegativeInteger: json_integer(out_, head); return status_code::success;
+        case major_type::ByteString:
+        case major_type::TextString: return strings(head);
+        case major_type::Array:
+        case major_type::Map: return container(head, depth);
+        case major_type::Tag: {
+            if (depth == 0) {
+                return status_code::nesting_too_deep;
             }
+            json_integer(out_, {major_type::UnsignedInteger, head.info, head.argument});
+            out_.put('(');
+            auto status = item(depth - 1);
+            out_.put(')');
+            return status;
+        }
+        case major_type::Simple: simple(head); return status_code::success;
         }
+        return status_code::malformed;
+    }
 
-        if (!indent_stack.empty()) {
-            indent_stack.top()--;
+    void simple(const item_head &head) {
+        switch (static_cast<std::uint8_t>(head.info)) {
+        case 20: out_.put("false"); break;
+        case 21: out_.put("true"); break;
+        case 22: out_.put("null"); break;
+        case 23: out_.put("undefined"); break;
+        case 25: diagnostic_float(out_, static_cast<float>(float16_t{static_cast<std::uint16_t>(head.argument)})); break;
+        case 26: diagnostic_float(out_, std::bit_cast<float>(static_cast<std::uint32_t>(head.argument))); break;
+        case 27: diagnostic_float(out_, std::bit_cast<double>(head.argument)); break;
+        default:
+            out_.put("simple(");
+            json_integer(out_, {major_type::UnsignedInteger, head.info, head.argument});
+            out_.put(')');
+        }
+    }
 
-            if (indent_stack.top() == 0) {
-                indent_stack.pop();
-                options.indent_level--;
+    // h'..' and "..", the chunks of indefinite length strings as (_ h'01', h'02')
+    status_code strings(const item_head &head) {
+        if (!head.indefinite()) {
+            return string(head);
+        }
+        out_.put("(_ ");
+        for (bool first = true;; first = false) {
+            item_head chunk;
+            if (auto status = cursor_.read_head(chunk); status != status_code::success) {
+                return status;
+            }
+            if (chunk.is_break()) {
+                break;
+            }
+            if (chunk.major != head.major || chunk.indefinite()) {
+                return status_code::malformed;
+            }
+            if (!first) {
+                out_.put(", ");
+            }
+            if (auto status = string(chunk); status != status_code::success) {
+                return status;
             }
         }
-        options.indent_level += should_indent;
-        options.offset = indent_stack.size();
-        fmt::format_to(std::back_inserter(output_buffer), "\n");
-        it = next_it;
+        out_.put(')');
+        return status_code::success;
     }
-}
 
-template <typename OutputBuffer> constexpr void cddl_prelude_to(OutputBuffer &buffer) {
-    fmt::format_to(std::back_inserter(buffer), "any = #\n"
-                                               "\n"
-                                               "uint = #0\n"
-                                               "nint = #1\n"
-                                               "int = uint / nint\n"
-                                               "\n"
-                                               "bstr = #2\n"
-                                               "bytes = bstr\n"
-                                               "tstr = #3\n"
-                                               "text = tstr\n"
-                                               "\n"
-                                               "tdate = #6.0(tstr)\n"
-                                               "time = #6.1(number)\n"
-                                               "number = int / float\n"
-                                               "biguint = #6.2(bstr)\n"
-                                               "bignint = #6.3(bstr)\n"
-                                               "bigint = biguint / bignint\n"
-                                               "integer = int / bigint\n"
-                                               "unsigned = uint / biguint\n"
-                                               "decfrac = #6.4([e10: int, m: integer])\n"
-                                               "bigfloat = #6.5([e2: int, m: integer])\n"
-                                               "eb64url = #6.21(any)\n"
-                                               "eb64legacy = #6.22(any)\n"
-                                               "eb16 = #6.23(any)\n"
-                                               "encoded-cbor = #6.24(bstr)\n"
-                                               "uri = #6.32(tstr)\n"
-                                               "b64url = #6.33(tstr)\n"
-                                               "b64legacy = #6.34(tstr)\n"
-                                               "regexp = #6.35(tstr)\n"
-                                               "mime-message = #6.36(tstr)\n"
-                                               "cbor-any = #6.55799(any)\n"
-                                               "\n"
-                                               "float16 = #7.25\n"
-                                               "float32 = #7.26\n"
-                                               "float64 = #7.27\n"
-                                               "float16-32 = float16 / float32\n"
-                                               "float32-64 = float32 / float64\n"
-                                               "float = float16-32 / float64\n"
-                                               "\n"
-                                               "false = #7.20\n"
-                                               "true = #7.21\n"
-                                               "bool = false / true\n"
-                                               "nil = #7.22\n"
-                                               "null = nil\n"
-                                               "undefined = #7.23\n");
-}
-
-template <ValidCborBuffer CborBuffer, typename OutputBuffer>
-constexpr void diagnostic_buffer(const CborBuffer &buffer, OutputBuffer &output_buffer) {
-    detail::catch_all_variant values;
-    auto                      dec                         = make_decoder(buffer);
-    auto                      diagnostic_notation_visitor = [&](auto &&arg) {
-        if constexpr (IsUnsigned<std::remove_cvref_t<decltype(arg)>>) {
-            return fmt::format("unsigned({})", arg);
-        } else if constexpr (IsNegative<std::remove_cvref_t<decltype(arg)>>) {
-            return fmt::format("negative({})", arg.value);
-        } else if constexpr (IsBinaryHeader<std::remove_cvref_t<decltype(arg)>>) {
-            return fmt::format(R"('{}')", "bstr");
+    status_code string(const item_head &head) {
+        if (head.major == major_type::TextString) {
+            out_.put('"');
+            auto status = cursor_.read_bytes(head.argument, [this](std::span<const std::byte> bytes) { json_escaped(out_, bytes); });
+            out_.put('"');
+            return status;
         }
+        json_binary_text<json_writer<OutputBuffer>> hex(out_, json_bytes::base16);
+        out_.put("h'");
+        auto status = cursor_.read_bytes(head.argument, hex);
+        out_.put('\'');
+        return status;
+    }
 
-        else {
-            return fmt::format("{}", "NOT IMPLEMENTED");
+    // [1, 2] and {1: 2}, indefinite length ones as [_ 1, 2] and {_ 1: 2}
+    status_code container(const item_head &head, std::size_t depth) {
+        if (depth == 0) {
+            return status_code::nesting_too_deep;
         }
-    };
+        const bool map = head.major == major_type::Map;
+        out_.put(map ? '{' : '[');
+        if (head.indefinite()) {
+            out_.put("_ ");
+        }
+        for (std::uint64_t i = 0; head.indefinite() || i < head.argument; ++i) {
+            item_head key;
+            if (auto status = cursor_.read_head(key); status != status_code::success) {
+                return status;
+            }
+            if (key.is_break()) {
+                if (!head.indefinite()) {
+                    return status_code::malformed;
+                }
+                break;
+            }
+            if (i != 0) {
+                out_.put(", ");
+            }
+            if (auto status = content(key, depth - 1); status != status_code::success) {
+                return status;
+            }
+            if (map) {
+                out_.put(": ");
+                if (auto status = item(depth - 1); status != status_code::success) {
+                    return status;
+                }
+            }
+        }
+        out_.put(map ? '}' : ']');
+        return status_code::success;
+    }
 
-    fmt::format_to(std::back_inserter(output_buffer), "[\n");
+    cursor<CborBuffer>        cursor_;
+    json_writer<OutputBuffer> out_;
+};
 
-    while (dec(values)) {
-        fmt::format_to(std::back_inserter(output_buffer), "  {}\n", std::visit(diagnostic_notation_visitor, values));
-    }
+} // namespace detail
 
-    fmt::format_to(std::back_inserter(output_buffer), "]");
+// Writes the items in buffer in diagnostic notation (RFC 8949 8), e.g 18([h'a10126', {4: h'6b6579'}]). Nothing is decoded into values
+// and nothing is allocated per item. The output is a buffer of chars such as fmt::memory_buffer or std::string, or a callable taking
+// std::string_view. On an error it holds the notation up to the bad item.
+template <ValidCborBuffer CborBuffer, typename OutputBuffer>
+expected<void, status_code> diagnostic_buffer(const CborBuffer &buffer, OutputBuffer &output_buffer) {
+    const auto status = detail::diagnostic_writer<CborBuffer, OutputBuffer>(buffer, output_buffer)();
+    if (status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    return {};
 }
 
 } // namespace cbor::tags
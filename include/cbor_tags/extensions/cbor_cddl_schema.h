@@ -0,0 +1,1319 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_cursor.h"
+#include "cbor_tags/float16_ieee754.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cbor::tags {
+
+// The standard prelude (RFC 8610 Appendix D), written by cddl_prelude_to and compiled into every schema
+inline constexpr std::string_view cddl_prelude = "any = #\n"
+                                                 "\n"
+                                                 "uint = #0\n"
+                                                 "nint = #1\n"
+                                                 "int = uint / nint\n"
+                                                 "\n"
+                                                 "bstr = #2\n"
+                                                 "bytes = bstr\n"
+                                                 "tstr = #3\n"
+                                                 "text = tstr\n"
+                                                 "\n"
+                                                 "tdate = #6.0(tstr)\n"
+                                                 "time = #6.1(number)\n"
+                                                 "number = int / float\n"
+                                                 "biguint = #6.2(bstr)\n"
+                                                 "bignint = #6.3(bstr)\n"
+                                                 "bigint = biguint / bignint\n"
+                                                 "integer = int / bigint\n"
+                                                 "unsigned = uint / biguint\n"
+                                                 "decfrac = #6.4([e10: int, m: integer])\n"
+                                                 "bigfloat = #6.5([e2: int, m: integer])\n"
+                                                 "eb64url = #6.21(any)\n"
+                                                 "eb64legacy = #6.22(any)\n"
+                                                 "eb16 = #6.23(any)\n"
+                                                 "encoded-cbor = #6.24(bstr)\n"
+                                                 "uri = #6.32(tstr)\n"
+                                                 "b64url = #6.33(tstr)\n"
+                                                 "b64legacy = #6.34(tstr)\n"
+                                                 "regexp = #6.35(tstr)\n"
+                                                 "mime-message = #6.36(tstr)\n"
+                                                 "cbor-any = #6.55799(any)\n"
+                                                 "\n"
+                                                 "float16 = #7.25\n"
+                                                 "float32 = #7.26\n"
+                                                 "float64 = #7.27\n"
+                                                 "float16-32 = float16 / float32\n"
+                                                 "float32-64 = float32 / float64\n"
+                                                 "float = float16-32 / float64\n"
+                                                 "\n"
+                                                 "false = #7.20\n"
+                                                 "true = #7.21\n"
+                                                 "bool = false / true\n"
+                                                 "nil = #7.22\n"
+                                                 "null = nil\n"
+                                                 "undefined = #7.23\n";
+
+namespace detail {
+
+inline constexpr std::uint32_t cddl_no_node           = std::numeric_limits<std::uint32_t>::max();
+inline constexpr std::uint64_t cddl_unbounded         = std::numeric_limits<std::uint64_t>::max();
+inline constexpr std::size_t   cddl_max_map_members     = 64;
+inline constexpr std::size_t   cddl_max_array_positions = 64;
+inline constexpr std::size_t   cddl_max_group_nesting   = 16;
+
+// A CBOR integer by its head: the value is argument for major type 0 and -1 - argument for major type 1, so -2^64 to 2^64 - 1 fit
+struct cddl_integer {
+    bool          negative{};
+    std::uint64_t argument{};
+
+    friend constexpr bool operator==(cddl_integer, cddl_integer) = default;
+    friend constexpr bool operator<=(cddl_integer a, cddl_integer b) noexcept {
+        if (a.negative != b.negative) {
+            return a.negative;
+        }
+        return a.negative ? a.argument >= b.argument : a.argument <= b.argument;
+    }
+};
+
+// The next value up or down, false at the ends of the range
+constexpr bool cddl_increment(cddl_integer &value) noexcept {
+    if (value.negative) {
+        value = value.argument == 0 ? cddl_integer{false, 0} : cddl_integer{true, value.argument - 1};
+        return true;
+    }
+    return value.argument != cddl_unbounded && (++value.argument, true);
+}
+
+constexpr bool cddl_decrement(cddl_integer &value) noexcept {
+    if (!value.negative) {
+        value = value.argument == 0 ? cddl_integer{true, 0} : cddl_integer{false, value.argument - 1};
+        return true;
+    }
+    return value.argument != cddl_unbounded && (++value.argument, true);
+}
+
+// Occurrence counts, cddl_unbounded stays unbounded
+constexpr std::uint64_t cddl_saturating_multiply(std::uint64_t a, std::uint64_t b) noexcept {
+    if (a == cddl_unbounded || b == cddl_unbounded || (b != 0 && a > cddl_unbounded / b)) {
+        return cddl_unbounded;
+    }
+    return a * b;
+}
+
+enum class cddl_kind : std::uint8_t {
+    any,
+    major,
+    integer,
+    floating,
+    simple,
+    bytes,
+    text,
+    text_literal,
+    array,
+    map,
+    tag,
+    choice,
+    reference
+};
+
+// One node of the compiled table. Integers, strings and floats carry their ranges, so ranges and controls like .size cost nothing
+// extra when validating.
+struct cddl_node {
+    cddl_kind     kind{};
+    major_type    major{};         // major: any item of this major type
+    std::uint8_t  widths{0b111};   // floating: float16, float32 and float64 as bits 0 to 2
+    cddl_integer  low{};           // integer: values, bytes and text: lengths, tag: number, simple: value
+    cddl_integer  high{};
+    double        float_low{-std::numeric_limits<double>::infinity()};
+    double        float_high{std::numeric_limits<double>::infinity()};
+    std::uint32_t first{};         // array: positions, map: entries, choice: edges, text_literal, reference: characters, tag: enclosed node
+    std::uint32_t count{};
+
+    constexpr bool unbounded_float() const noexcept {
+        return float_low == -std::numeric_limits<double>::infinity() && float_high == std::numeric_limits<double>::infinity();
+    }
+};
+
+// An entry of an array or map group with its occurrence. Entries without a value node stand for a nested group of entries.
+struct cddl_entry {
+    std::uint64_t min{1};
+    std::uint64_t max{1};
+    std::uint32_t key{cddl_no_node}; // Member key, only matched in maps
+    std::uint32_t value{cddl_no_node};
+    std::uint32_t first{}; // Nested group
+    std::uint32_t count{};
+    bool          cut{};               // key: value, a matching key rules out the other members when the value does not match
+};
+
+// One position of the automaton an array's entries compile to, with the positions that may match the next item as bits relative to
+// the first position of the array. That first position matches nothing, it stands for the start of the array.
+struct cddl_position {
+    std::uint32_t value{cddl_no_node};
+    std::uint64_t follow{};
+    bool          last{}; // The array may end after this position
+};
+
+struct cddl_tables {
+    std::vector<cddl_node>     nodes;
+    std::vector<cddl_entry>    entries;
+    std::vector<std::uint32_t> edges;
+    std::vector<cddl_position> positions;
+    std::string                strings;
+};
+
+// Recursive descent parser for a practical subset of CDDL (RFC 8610): type and group rules, /=, choices, integer and float ranges,
+// text and number literals, arrays, maps with bareword, literal and => keys, occurrences, #n and #6.n(type), and the controls .size,
+// .lt, .le, .gt, .ge, .eq and .default. Generics, sockets, group choices and byte string literals are rejected.
+class cddl_compiler {
+  public:
+    struct rule {
+        std::string_view name;
+        bool             group;
+        std::uint32_t    node;
+        std::uint32_t    first;
+        std::uint32_t    count;
+        bool             extended; // Only defined by /= so far
+    };
+
+    explicit cddl_compiler(cddl_tables &tables) : t_(tables) {}
+
+    const std::vector<rule> &rules() const noexcept { return rules_; }
+
+    bool parse(std::string_view text) {
+        text_       = text;
+        pos_        = 0;
+        first_rule_ = rules_.size();
+        for (space(); pos_ < text_.size(); space()) {
+            const auto name = identifier();
+            space();
+            if (name.empty() || peek("//=")) {
+                return false;
+            }
+            const bool extend = consume("/=");
+            if (!extend && !consume('=')) {
+                return false;
+            }
+            cddl_entry entry;
+            if (!group_entry(entry) || !define(name, entry, extend)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Points every edge, entry and rule at the node it names, folds choices of adjacent integer ranges or of float widths into single
+    // nodes, flattens the groups in maps into one member list and compiles the entries of arrays to position automata
+    bool resolve() {
+        for (auto &edge : t_.edges) {
+            if ((edge = follow(edge)) == cddl_no_node) {
+                return false;
+            }
+        }
+        for (auto &node : t_.nodes) {
+            if (node.kind == cddl_kind::tag && (node.first = follow(node.first)) == cddl_no_node) {
+                return false;
+            }
+        }
+        for (auto &entry : t_.entries) {
+            if (entry.key != cddl_no_node && (entry.key = follow(entry.key)) == cddl_no_node) {
+                return false;
+            }
+            if (entry.value == cddl_no_node) {
+                continue;
+            }
+            if (const auto *r = group_rule(entry.value)) {
+                if (entry.key != cddl_no_node) {
+                    return false;
+                }
+                entry.value = cddl_no_node;
+                entry.first = r->first;
+                entry.count = r->count;
+            } else if ((entry.value = follow(entry.value)) == cddl_no_node) {
+                return false;
+            }
+        }
+        for (auto &r : rules_) {
+            if (!r.group && (r.node = follow(r.node)) == cddl_no_node) {
+                return false;
+            }
+        }
+        for (std::uint32_t i = 0; i < t_.nodes.size(); ++i) {
+            if (t_.nodes[i].kind == cddl_kind::choice) {
+                fold(i);
+            }
+        }
+        if (!acyclic_choices()) {
+            return false;
+        }
+        for (std::uint32_t i = 0; i < t_.nodes.size(); ++i) {
+            if (t_.nodes[i].kind != cddl_kind::map) {
+                continue;
+            }
+            std::vector<cddl_entry> members;
+            if (!flatten(t_.nodes[i].first, t_.nodes[i].count, false, 1, members, 0) || members.size() > cddl_max_map_members) {
+                return false;
+            }
+            t_.nodes[i].first = static_cast<std::uint32_t>(t_.entries.size());
+            t_.nodes[i].count = static_cast<std::uint32_t>(members.size());
+            t_.entries.insert(t_.entries.end(), members.begin(), members.end());
+        }
+        for (std::uint32_t i = 0; i < t_.nodes.size(); ++i) {
+            if (t_.nodes[i].kind == cddl_kind::array && !automaton(t_.nodes[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    // Rules
+
+    // A rule is a type unless its entry is a group, name = (type) is a type too. Alternatives added with /= may come before or after the
+    // = of the rule, any other second definition of a name is an error.
+    bool define(std::string_view name, const cddl_entry &entry, bool extend) {
+        const auto plain = [](const cddl_entry &e) { return e.value != cddl_no_node && e.key == cddl_no_node && e.min == 1 && e.max == 1; };
+
+        auto type = plain(entry) ? entry.value : cddl_no_node;
+        if (entry.value == cddl_no_node && entry.count == 1 && plain(t_.entries[entry.first])) {
+            type = t_.entries[entry.first].value; // (type)
+        }
+        auto      *r   = find_rule(name);
+        const bool own = r != nullptr && static_cast<std::size_t>(r - rules_.data()) >= first_rule_;
+        if (type == cddl_no_node) {
+            if (extend || own) {
+                return false;
+            }
+            if (entry.value == cddl_no_node) {
+                rules_.push_back({name, true, cddl_no_node, entry.first, entry.count, false});
+            } else {
+                rules_.push_back({name, true, cddl_no_node, static_cast<std::uint32_t>(t_.entries.size()), 1, false});
+                t_.entries.push_back(entry);
+            }
+            return true;
+        }
+        if (r != nullptr && (extend || (own && r->extended))) {
+            if (r->group) {
+                return false;
+            }
+            const auto edges = static_cast<std::uint32_t>(t_.edges.size());
+            t_.edges.push_back(r->node);
+            t_.edges.push_back(type);
+            r->node     = add({.kind = cddl_kind::choice, .first = edges, .count = 2});
+            r->extended = r->extended && extend;
+            return true;
+        }
+        if (own) {
+            return false;
+        }
+        rules_.push_back({name, false, type, 0, 0, extend});
+        return true;
+    }
+
+    rule *find_rule(std::string_view name) {
+        for (auto it = rules_.rbegin(); it != rules_.rend(); ++it) {
+            if (it->name == name) {
+                return &*it;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string_view name_of(std::uint32_t node) const {
+        return std::string_view(t_.strings).substr(t_.nodes[node].first, t_.nodes[node].count);
+    }
+
+    const rule *group_rule(std::uint32_t node) {
+        if (t_.nodes[node].kind != cddl_kind::reference) {
+            return nullptr;
+        }
+        const auto *r = find_rule(name_of(node));
+        return r != nullptr && r->group ? r : nullptr;
+    }
+
+    // The node a reference names, through chains of rules like null = nil
+    std::uint32_t follow(std::uint32_t node) {
+        for (std::size_t steps = 0; node != cddl_no_node && t_.nodes[node].kind == cddl_kind::reference; ++steps) {
+            const auto *r = find_rule(name_of(node));
+            if (r == nullptr || r->group || steps > rules_.size()) {
+                return cddl_no_node;
+            }
+            node = r->node;
+        }
+        return node;
+    }
+
+    // A choice of integer ranges that meet, e.g int = uint / nint, or of floats of any value becomes one node
+    bool fold(std::uint32_t choice) {
+        const auto edges = std::span(t_.edges).subspan(t_.nodes[choice].first, t_.nodes[choice].count);
+
+        cddl_node merged = t_.nodes[follow(edges[0])];
+        if (merged.kind != cddl_kind::integer && (merged.kind != cddl_kind::floating || !merged.unbounded_float())) {
+            return false;
+        }
+        for (const auto edge : edges.subspan(1)) {
+            const auto &alternative = t_.nodes[follow(edge)];
+            if (alternative.kind != merged.kind) {
+                return false;
+            }
+            if (merged.kind == cddl_kind::floating) {
+                if (!alternative.unbounded_float()) {
+                    return false;
+                }
+                merged.widths |= alternative.widths;
+                continue;
+            }
+            auto above_merged      = merged.high;
+            auto above_alternative = alternative.high;
+            if ((cddl_increment(above_merged) && !(alternative.low <= above_merged)) ||
+                (cddl_increment(above_alternative) && !(merged.low <= above_alternative))) {
+                return false;
+            }
+            merged.low  = merged.low <= alternative.low ? merged.low : alternative.low;
+            merged.high = merged.high <= alternative.high ? alternative.high : merged.high;
+        }
+        t_.nodes[choice] = merged;
+        return true;
+    }
+
+    // A choice that leads back to itself through choices alone, e.g a = a / int, would be tried again without reading anything.
+    // Alias cycles are already caught by follow(), this walks the choice edges depth first and fails on an edge back into the walk.
+    bool acyclic_choices() const {
+        enum class mark : std::uint8_t { unvisited, open, done };
+        std::vector<mark>                                    marks(t_.nodes.size(), mark::unvisited);
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> walk; // Choice node and its next edge
+        for (std::uint32_t root = 0; root < t_.nodes.size(); ++root) {
+            if (t_.nodes[root].kind != cddl_kind::choice || marks[root] != mark::unvisited) {
+                continue;
+            }
+            marks[root] = mark::open;
+            walk.emplace_back(root, 0);
+            while (!walk.empty()) {
+                auto &[node, next] = walk.back();
+                if (next == t_.nodes[node].count) {
+                    marks[node] = mark::done;
+                    walk.pop_back();
+                    continue;
+                }
+                const auto target = t_.edges[t_.nodes[node].first + next++];
+                if (t_.nodes[target].kind != cddl_kind::choice || marks[target] == mark::done) {
+                    continue;
+                }
+                if (marks[target] == mark::open) {
+                    return false;
+                }
+                marks[target] = mark::open;
+                walk.emplace_back(target, 0);
+            }
+        }
+        return true;
+    }
+
+    // The members of a map with nested groups spliced in, a group's occurrence carries over to its members
+    bool flatten(std::uint32_t first, std::uint32_t count, bool optional, std::uint64_t repeat, std::vector<cddl_entry> &members,
+                 std::size_t depth) {
+        if (depth > cddl_max_group_nesting) {
+            return false;
+        }
+        for (std::uint32_t i = first; i < first + count; ++i) {
+            auto entry = t_.entries[i];
+            if (entry.value == cddl_no_node) {
+                if (!flatten(entry.first, entry.count, optional || entry.min == 0, cddl_saturating_multiply(repeat, entry.max), members,
+                             depth + 1)) {
+                    return false;
+                }
+                continue;
+            }
+            if (entry.key == cddl_no_node) {
+                return false;
+            }
+            entry.min = optional ? 0 : entry.min;
+            entry.max = cddl_saturating_multiply(entry.max, repeat);
+            members.push_back(entry);
+        }
+        return true;
+    }
+
+    // Arrays
+
+    // The positions a run of entries may start and end with, and whether it may match no items at all
+    struct fragment {
+        std::uint64_t first{};
+        std::uint64_t last{};
+        bool          nullable{true};
+    };
+
+    // Compiles the entries of an array to a position automaton (Glushkov): every occurrence of an entry or of a nested group gets its
+    // own copy of the positions, an unbounded one loops back to its start. Validating then never goes back over an item.
+    bool automaton(cddl_node &array) {
+        const auto start = static_cast<std::uint32_t>(t_.positions.size());
+        t_.positions.emplace_back();
+        fragment run;
+        if (!unroll(array.first, array.count, start, run, 0)) {
+            return false;
+        }
+        t_.positions[start].follow = run.first;
+        t_.positions[start].last   = run.nullable;
+        for (auto bits = run.last; bits != 0; bits &= bits - 1) {
+            t_.positions[start + std::countr_zero(bits)].last = true;
+        }
+        array.first = start;
+        array.count = static_cast<std::uint32_t>(t_.positions.size() - start);
+        return true;
+    }
+
+    bool unroll(std::uint32_t first, std::uint32_t count, std::uint32_t start, fragment &run, std::size_t depth) {
+        if (depth > cddl_max_group_nesting) {
+            return false;
+        }
+        for (std::uint32_t i = first; i < first + count; ++i) {
+            if (!repeat(t_.entries[i], start, run, depth)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Appends min copies of an entry and then a loop for an unbounded one or max - min optional copies
+    bool repeat(const cddl_entry &entry, std::uint32_t start, fragment &run, std::size_t depth) {
+        for (std::uint64_t copies = 0; entry.max == cddl_unbounded ? copies <= entry.min : copies < entry.max; ++copies) {
+            const auto before = t_.positions.size();
+            fragment   copy{.nullable = false};
+            if (!once(entry, start, copy, depth)) {
+                return false;
+            }
+            if (t_.positions.size() == before) {
+                return true; // A group without items, any number of copies of it match nothing
+            }
+            if (copies >= entry.min) {
+                copy.nullable = true;
+                if (entry.max == cddl_unbounded) {
+                    link(copy.last, copy.first, start);
+                }
+            }
+            link(run.last, copy.first, start);
+            run.first    |= run.nullable ? copy.first : 0;
+            run.last      = copy.last | (copy.nullable ? run.last : 0);
+            run.nullable  = run.nullable && copy.nullable;
+        }
+        return true;
+    }
+
+    bool once(const cddl_entry &entry, std::uint32_t start, fragment &copy, std::size_t depth) {
+        if (entry.value == cddl_no_node) {
+            copy = {};
+            return unroll(entry.first, entry.count, start, copy, depth + 1);
+        }
+        const auto bit = t_.positions.size() - start;
+        if (bit >= cddl_max_array_positions) {
+            return false;
+        }
+        t_.positions.push_back({.value = entry.value});
+        copy = {std::uint64_t{1} << bit, std::uint64_t{1} << bit, false};
+        return true;
+    }
+
+    void link(std::uint64_t from, std::uint64_t to, std::uint32_t start) {
+        for (auto bits = from; bits != 0; bits &= bits - 1) {
+            t_.positions[start + std::countr_zero(bits)].follow |= to;
+        }
+    }
+
+    // Groups
+
+    bool group(char close, std::uint32_t &first, std::uint32_t &count) {
+        std::vector<cddl_entry> entries;
+        for (space(); !consume(close); space()) {
+            cddl_entry entry;
+            if (pos_ >= text_.size() || !group_entry(entry)) {
+                return false;
+            }
+            entries.push_back(entry);
+            space();
+            consume(',');
+        }
+        first = static_cast<std::uint32_t>(t_.entries.size());
+        count = static_cast<std::uint32_t>(entries.size());
+        t_.entries.insert(t_.entries.end(), entries.begin(), entries.end());
+        return true;
+    }
+
+    bool group_entry(cddl_entry &entry) {
+        space();
+        occurrence(entry);
+        space();
+        if (consume('(')) {
+            return group(')', entry.first, entry.count);
+        }
+
+        const auto start = pos_;
+        if (const auto bareword = identifier(); !bareword.empty()) {
+            space();
+            if (consume(':')) {
+                entry.key   = text_literal(bareword);
+                entry.cut   = true;
+                entry.value = type();
+                return entry.value != cddl_no_node;
+            }
+            pos_ = start;
+        }
+
+        const auto first = type1();
+        if (first == cddl_no_node) {
+            return false;
+        }
+        space();
+        const bool cut = consume('^');
+        space();
+        if (consume("=>")) {
+            entry.key = first;
+            entry.cut = cut;
+        } else if (cut) {
+            return false;
+        } else if (const auto kind = t_.nodes[first].kind;
+                   (kind == cddl_kind::text_literal || (kind == cddl_kind::integer && t_.nodes[first].low == t_.nodes[first].high)) &&
+                   consume(':')) {
+            entry.key = first;
+            entry.cut = true;
+        } else {
+            entry.value = choice(first);
+            return entry.value != cddl_no_node;
+        }
+        entry.value = type();
+        return entry.value != cddl_no_node;
+    }
+
+    // ?, *, +, n*m, n* and *m
+    void occurrence(cddl_entry &entry) {
+        if (consume('?')) {
+            entry.min = 0;
+        } else if (consume('+')) {
+            entry.max = cddl_unbounded;
+        } else {
+            const auto start = pos_;
+            const auto min   = unsigned_number();
+            if (!consume('*')) {
+                pos_ = start;
+                return;
+            }
+            const auto max = unsigned_number();
+            entry.min      = min.value_or(0);
+            entry.max      = max.value_or(cddl_unbounded);
+        }
+    }
+
+    // Types
+
+    std::uint32_t type() { return choice(type1()); }
+
+    std::uint32_t choice(std::uint32_t first) {
+        if (first == cddl_no_node) {
+            return cddl_no_node;
+        }
+        std::vector<std::uint32_t> alternatives{first};
+        for (space(); peek('/') && !peek("//") && !peek("/="); space()) {
+            ++pos_;
+            space();
+            const auto alternative = type1();
+            if (alternative == cddl_no_node) {
+                return cddl_no_node;
+            }
+            alternatives.push_back(alternative);
+        }
+        if (alternatives.size() == 1) {
+            return first;
+        }
+        const auto edges = static_cast<std::uint32_t>(t_.edges.size());
+        t_.edges.insert(t_.edges.end(), alternatives.begin(), alternatives.end());
+        return add({.kind = cddl_kind::choice, .first = edges, .count = static_cast<std::uint32_t>(alternatives.size())});
+    }
+
+    std::uint32_t type1() {
+        const auto low = type2();
+        if (low == cddl_no_node) {
+            return cddl_no_node;
+        }
+        space();
+        if (peek("..")) {
+            const bool exclusive = peek("...");
+            pos_ += exclusive ? 3 : 2;
+            space();
+            return range(low, type2(), exclusive);
+        }
+        if (peek('.') && pos_ + 1 < text_.size() && alpha(text_[pos_ + 1])) {
+            ++pos_;
+            const auto op = identifier();
+            space();
+            return control(low, op, type2());
+        }
+        return low;
+    }
+
+    std::uint32_t type2() {
+        space();
+        if (pos_ >= text_.size()) {
+            return cddl_no_node;
+        }
+        const char c = text_[pos_];
+        if (c == '"') {
+            return quoted_text();
+        }
+        if (digit(c) || (c == '-' && pos_ + 1 < text_.size() && digit(text_[pos_ + 1]))) {
+            return number();
+        }
+        if (c == '#') {
+            return hash();
+        }
+        if (consume('(')) {
+            const auto inner = type();
+            space();
+            return consume(')') ? inner : cddl_no_node;
+        }
+        if (consume('[') || consume('{')) {
+            cddl_node node{.kind = c == '[' ? cddl_kind::array : cddl_kind::map};
+            return group(c == '[' ? ']' : '}', node.first, node.count) ? add(node) : cddl_no_node;
+        }
+        if (alpha(c)) {
+            const auto name = identifier();
+            if (peek('\'')) {
+                return cddl_no_node; // h'..' and b64'..'
+            }
+            const auto at = static_cast<std::uint32_t>(t_.strings.size());
+            t_.strings += name;
+            return add({.kind = cddl_kind::reference, .first = at, .count = static_cast<std::uint32_t>(name.size())});
+        }
+        return cddl_no_node;
+    }
+
+    // #, #0 to #7, #6.n(type) and #7.n
+    std::uint32_t hash() {
+        ++pos_;
+        if (pos_ >= text_.size() || !digit(text_[pos_])) {
+            return add({.kind = cddl_kind::any});
+        }
+        const auto major = static_cast<major_type>(text_[pos_++] - '0');
+
+        std::optional<std::uint64_t> argument;
+        if (peek('.') && pos_ + 1 < text_.size() && digit(text_[pos_ + 1])) {
+            ++pos_;
+            argument = unsigned_number();
+        }
+
+        switch (major) {
+        case major_type::UnsignedInteger:
+            return argument ? cddl_no_node : add({.kind = cddl_kind::integer, .low = {false, 0}, .high = {false, cddl_unbounded}});
+        case major_type::NegativeInteger:
+            return argument ? cddl_no_node : add({.kind = cddl_kind::integer, .low = {true, cddl_unbounded}, .high = {true, 0}});
+        case major_type::ByteString:
+        case major_type::TextString:
+            return argument ? cddl_no_node
+                            : add({.kind = major == major_type::ByteString ? cddl_kind::bytes : cddl_kind::text,
+                                   .low  = {false, 0},
+                                   .high = {false, cddl_unbounded}});
+        case major_type::Tag: {
+            if (!argument) {
+                return add({.kind = cddl_kind::major, .major = major});
+            }
+            auto enclosed = cddl_no_node;
+            if (consume('(')) {
+                enclosed = type();
+                space();
+                if (enclosed == cddl_no_node || !consume(')')) {
+                    return cddl_no_node;
+                }
+            } else {
+                enclosed = add({.kind = cddl_kind::any});
+            }
+            return add({.kind = cddl_kind::tag, .low = {false, *argument}, .first = enclosed});
+        }
+        case major_type::Simple:
+            if (!argument) {
+                return add({.kind = cddl_kind::major, .major = major});
+            }
+            if (*argument >= 25 && *argument <= 27) {
+                return add({.kind = cddl_kind::floating, .widths = static_cast<std::uint8_t>(1U << (*argument - 25))});
+            }
+            if (*argument < 24 || (*argument >= 32 && *argument <= 255)) {
+                return add({.kind = cddl_kind::simple, .low = {false, *argument}});
+            }
+            return cddl_no_node;
+        default: return argument ? cddl_no_node : add({.kind = cddl_kind::major, .major = major});
+        }
+    }
+
+    // Integers in decimal or 0x hexadecimal, and decimal floats
+    std::uint32_t number() {
+        const auto start    = pos_;
+        const bool negative = consume('-');
+        const bool hex      = consume("0x");
+        const auto digits   = pos_;
+        bool       floating = false;
+        while (pos_ < text_.size() && (digit(text_[pos_]) || (hex && std::isxdigit(static_cast<unsigned char>(text_[pos_]))))) {
+            ++pos_;
+        }
+        if (!hex && peek('.') && pos_ + 1 < text_.size() && digit(text_[pos_ + 1])) {
+            floating = true;
+            for (++pos_; pos_ < text_.size() && digit(text_[pos_]); ++pos_) {
+            }
+        }
+        if (!hex && (consume('e') || consume('E'))) {
+            floating = true;
+            if (!consume('+')) {
+                consume('-');
+            }
+            for (; pos_ < text_.size() && digit(text_[pos_]); ++pos_) {
+            }
+        }
+
+        if (floating) {
+            double     value{};
+            const auto text   = text_.substr(start, pos_ - start);
+            const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (result.ec != std::errc{} || result.ptr != text.data() + text.size()) {
+                return cddl_no_node;
+            }
+            return add({.kind = cddl_kind::floating, .float_low = value, .float_high = value});
+        }
+        std::uint64_t magnitude{};
+        const auto    result = std::from_chars(text_.data() + digits, text_.data() + pos_, magnitude, hex ? 16 : 10);
+        if (result.ec != std::errc{} || result.ptr != text_.data() + pos_) {
+            return cddl_no_node;
+        }
+        const auto value = negative && magnitude != 0 ? cddl_integer{true, magnitude - 1} : cddl_integer{false, magnitude};
+        return add({.kind = cddl_kind::integer, .low = value, .high = value});
+    }
+
+    // low..high and low...high of integer or float literals, reusing the node of the lower bound
+    std::uint32_t range(std::uint32_t low, std::uint32_t high, bool exclusive) {
+        if (high == cddl_no_node) {
+            return cddl_no_node;
+        }
+        auto       &from = t_.nodes[low];
+        const auto &to   = t_.nodes[high];
+        if (from.kind == cddl_kind::integer && to.kind == cddl_kind::integer && from.low == from.high && to.low == to.high) {
+            auto last = to.low;
+            if ((exclusive && !cddl_decrement(last)) || !(from.low <= last)) {
+                return cddl_no_node;
+            }
+            from.high = last;
+            return low;
+        }
+        if (from.kind == cddl_kind::floating && to.kind == cddl_kind::floating && from.float_low == from.float_high &&
+            to.float_low == to.float_high) {
+            from.float_high = exclusive ? std::nextafter(to.float_low, -std::numeric_limits<double>::infinity()) : to.float_low;
+            return from.float_low <= from.float_high ? low : cddl_no_node;
+        }
+        return cddl_no_node;
+    }
+
+    // Controls narrow a copy of the node they apply to, e.g bstr .size 16 or uint .le 100
+    std::uint32_t control(std::uint32_t target, std::string_view op, std::uint32_t argument) {
+        if (op == "default") {
+            return argument == cddl_no_node ? cddl_no_node : target;
+        }
+        if (argument == cddl_no_node) {
+            return cddl_no_node;
+        }
+        const auto bound = t_.nodes[argument];
+        const auto node  = concrete(target);
+        if (node == cddl_no_node) {
+            return cddl_no_node;
+        }
+        auto &n = t_.nodes[node];
+
+        if (op == "size") {
+            if (bound.kind != cddl_kind::integer || bound.low.negative) {
+                return cddl_no_node;
+            }
+            if (n.kind == cddl_kind::bytes || n.kind == cddl_kind::text) {
+                n.low  = bound.low;
+                n.high = bound.high;
+                return node;
+            }
+            if (n.kind != cddl_kind::integer || n.low.negative) {
+                return cddl_no_node;
+            }
+            if (bound.high.argument < 8) {
+                const auto largest = cddl_integer{false, (std::uint64_t{1} << (8 * bound.high.argument)) - 1};
+                n.high             = n.high <= largest ? n.high : largest;
+            }
+            return n.low <= n.high ? node : cddl_no_node;
+        }
+
+        if (n.kind == cddl_kind::integer && bound.kind == cddl_kind::integer && bound.low == bound.high) {
+            auto value = bound.low;
+            if ((op == "lt" && !cddl_decrement(value)) || (op == "gt" && !cddl_increment(value))) {
+                return cddl_no_node;
+            }
+            if (op == "lt" || op == "le" || op == "eq") {
+                n.high = n.high <= value ? n.high : value;
+            }
+            if (op == "gt" || op == "ge" || op == "eq") {
+                n.low = value <= n.low ? n.low : value;
+            }
+            return (op == "lt" || op == "le" || op == "gt" || op == "ge" || op == "eq") && n.low <= n.high ? node : cddl_no_node;
+        }
+        if (n.kind == cddl_kind::floating && bound.kind == cddl_kind::floating && bound.float_low == bound.float_high) {
+            constexpr auto infinity = std::numeric_limits<double>::infinity();
+            const auto     value    = bound.float_low;
+            if (op == "lt" || op == "le" || op == "eq") {
+                n.float_high = std::min(n.float_high, op == "lt" ? std::nextafter(value, -infinity) : value);
+            }
+            if (op == "gt" || op == "ge" || op == "eq") {
+                n.float_low = std::max(n.float_low, op == "gt" ? std::nextafter(value, infinity) : value);
+            }
+            return (op == "lt" || op == "le" || op == "gt" || op == "ge" || op == "eq") && n.float_low <= n.float_high ? node
+                                                                                                                    : cddl_no_node;
+        }
+        return cddl_no_node;
+    }
+
+    // A copy of the node a type names, which must be defined by now
+    std::uint32_t concrete(std::uint32_t node) {
+        node = follow(node);
+        if (node == cddl_no_node) {
+            return cddl_no_node;
+        }
+        const auto copy = add(cddl_node(t_.nodes[node]));
+        if (t_.nodes[copy].kind == cddl_kind::choice) {
+            for (auto edge : std::span(t_.edges).subspan(t_.nodes[copy].first, t_.nodes[copy].count)) {
+                if (follow(edge) == cddl_no_node) {
+                    return cddl_no_node;
+                }
+            }
+            return fold(copy) ? copy : cddl_no_node;
+        }
+        return copy;
+    }
+
+    // Literals
+
+    std::uint32_t quoted_text() {
+        ++pos_;
+        const auto first = static_cast<std::uint32_t>(t_.strings.size());
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if (c == '\\' && pos_ < text_.size()) {
+                c = text_[pos_++];
+                c = c == 'n' ? '\n' : c == 't' ? '\t' : c == 'r' ? '\r' : c;
+            }
+            t_.strings += c;
+        }
+        if (!consume('"')) {
+            return cddl_no_node;
+        }
+        return add({.kind = cddl_kind::text_literal, .first = first, .count = static_cast<std::uint32_t>(t_.strings.size() - first)});
+    }
+
+    std::uint32_t text_literal(std::string_view text) {
+        const auto first = static_cast<std::uint32_t>(t_.strings.size());
+        t_.strings += text;
+        return add({.kind = cddl_kind::text_literal, .first = first, .count = static_cast<std::uint32_t>(text.size())});
+    }
+
+    std::optional<std::uint64_t> unsigned_number() {
+        std::uint64_t value{};
+        const auto    result = std::from_chars(text_.data() + pos_, text_.data() + text_.size(), value);
+        if (result.ec != std::errc{}) {
+            return std::nullopt;
+        }
+        pos_ = static_cast<std::size_t>(result.ptr - text_.data());
+        return value;
+    }
+
+    // Lexing
+
+    std::uint32_t add(const cddl_node &node) {
+        t_.nodes.push_back(node);
+        return static_cast<std::uint32_t>(t_.nodes.size() - 1);
+    }
+
+    static constexpr bool alpha(char c) noexcept {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '@' || c == '_' || c == '$';
+    }
+    static constexpr bool digit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+    std::string_view identifier() {
+        const auto start = pos_;
+        if (pos_ >= text_.size() || !alpha(text_[pos_])) {
+            return {};
+        }
+        for (++pos_; pos_ < text_.size(); ++pos_) {
+            const char c = text_[pos_];
+            if (alpha(c) || digit(c)) {
+                continue;
+            }
+            if ((c == '-' || c == '.') && pos_ + 1 < text_.size() && (alpha(text_[pos_ + 1]) || digit(text_[pos_ + 1]))) {
+                continue;
+            }
+            break;
+        }
+        return text_.substr(start, pos_ - start);
+    }
+
+    // Whitespace and ; comments
+    void space() {
+        while (pos_ < text_.size()) {
+            const char c = text_[pos_];
+            if (c == ';') {
+                pos_ = std::min(text_.find('\n', pos_), text_.size());
+            } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                ++pos_;
+            } else {
+                break;
+            }
+        }
+    }
+
+    bool peek(char c) const noexcept { return pos_ < text_.size() && text_[pos_] == c; }
+    bool peek(std::string_view s) const noexcept { return text_.substr(pos_).starts_with(s); }
+    bool consume(char c) noexcept { return peek(c) && (++pos_, true); }
+    bool consume(std::string_view s) noexcept { return peek(s) && (pos_ += s.size(), true); }
+
+    cddl_tables      &t_;
+    std::vector<rule> rules_;
+    std::string_view  text_;
+    std::size_t       pos_{0};
+    std::size_t       first_rule_{0};
+};
+
+// Matches one item against the compiled tables. Alternatives and array positions are tried from a copy of the cursor, and map
+// members are counted in a fixed size array on the stack, so validating allocates nothing.
+template <ValidCborBuffer CborBuffer> class cddl_validator {
+  public:
+    cddl_validator(const cddl_tables &tables, const CborBuffer &buffer) : t_(tables), cursor_(buffer) {}
+
+    status_code operator()(std::uint32_t root) {
+        if (item(root, cursor<CborBuffer>::default_max_depth) && cursor_.at_end()) {
+            return status_code::success;
+        }
+        return status_;
+    }
+
+  private:
+    bool item(std::uint32_t index, std::size_t depth) {
+        const auto &node = t_.nodes[index];
+        if (node.kind == cddl_kind::choice) {
+            if (!deeper(depth)) {
+                return false;
+            }
+            const auto start = cursor_;
+            for (const auto alternative : std::span(t_.edges).subspan(node.first, node.count)) {
+                if (item(alternative, depth - 1)) {
+                    return true;
+                }
+                cursor_ = start;
+            }
+            return false;
+        }
+
+        item_head head;
+        if (!check(cursor_.read_head(head)) || head.is_break()) {
+            return false;
+        }
+        switch (node.kind) {
+        case cddl_kind::any: return check(cursor_.skip_content(head, depth));
+        case cddl_kind::major: return head.major == node.major && check(cursor_.skip_content(head, depth));
+        case cddl_kind::integer: {
+            if (head.major != major_type::UnsignedInteger && head.major != major_type::NegativeInteger) {
+                return false;
+            }
+            const auto value = cddl_integer{head.major == major_type::NegativeInteger, head.argument};
+            return node.low <= value && value <= node.high;
+        }
+        case cddl_kind::floating: return floating(head, node);
+        case cddl_kind::simple: {
+            const auto info = static_cast<std::uint8_t>(head.info);
+            return head.major == major_type::Simple && info <= 24 && head.argument == node.low.argument;
+        }
+        case cddl_kind::bytes:
+        case cddl_kind::text: {
+            std::uint64_t length{};
+            if (head.major != (node.kind == cddl_kind::bytes ? major_type::ByteString : major_type::TextString) ||
+                !string_length(head, length)) {
+                return false;
+            }
+            return node.low.argument <= length && length <= node.high.argument;
+        }
+        case cddl_kind::text_literal: return text_literal(head, node);
+        case cddl_kind::array: return head.major == major_type::Array && deeper(depth) && array(head, node, depth - 1);
+        case cddl_kind::map: return head.major == major_type::Map && deeper(depth) && map(head, node, depth - 1);
+        case cddl_kind::tag:
+            return head.major == major_type::Tag && head.argument == node.low.argument && deeper(depth) && item(node.first, depth - 1);
+        default: return false;
+        }
+    }
+
+    bool floating(const item_head &head, const cddl_node &node) const {
+        const auto info = static_cast<std::uint8_t>(head.info);
+        if (head.major != major_type::Simple || info < 25 || info > 27 || (node.widths & (1U << (info - 25))) == 0) {
+            return false;
+        }
+        if (node.unbounded_float()) {
+            return true;
+        }
+        double value{};
+        switch (info) {
+        case 25: value = static_cast<float>(float16_t{static_cast<std::uint16_t>(head.argument)}); break;
+        case 26: value = std::bit_cast<float>(static_cast<std::uint32_t>(head.argument)); break;
+        default: value = std::bit_cast<double>(head.argument);
+        }
+        return node.float_low <= value && value <= node.float_high;
+    }
+
+    // The length of a string, summed over the chunks of an indefinite length one, with its bytes skipped
+    bool string_length(const item_head &head, std::uint64_t &length) {
+        if (!head.indefinite()) {
+            length = head.argument;
+            return check(cursor_.skip_bytes(length));
+        }
+        length = 0;
+        for (item_head chunk;;) {
+            if (!check(cursor_.read_head(chunk))) {
+                return false;
+            }
+            if (chunk.is_break()) {
+                return true;
+            }
+            if (chunk.major != head.major || chunk.indefinite()) {
+                return check(status_code::malformed);
+            }
+            length += chunk.argument;
+            if (!check(cursor_.skip_bytes(chunk.argument))) {
+                return false;
+            }
+        }
+    }
+
+    bool text_literal(const item_head &head, const cddl_node &node) {
+        const auto  literal = std::string_view(t_.strings).substr(node.first, node.count);
+        std::size_t matched = 0;
+        bool        equal   = true;
+        const auto  compare = [&](std::span<const std::byte> bytes) {
+            equal = equal && bytes.size() <= literal.size() - matched &&
+                    std::memcmp(bytes.data(), literal.data() + matched, bytes.size()) == 0;
+            matched += equal ? bytes.size() : 0;
+        };
+
+        if (head.major != major_type::TextString) {
+            return false;
+        }
+        if (!head.indefinite()) {
+            return head.argument == literal.size() && check(cursor_.read_bytes(head.argument, compare)) && equal;
+        }
+        for (item_head chunk;;) {
+            if (!check(cursor_.read_head(chunk))) {
+                return false;
+            }
+            if (chunk.is_break()) {
+                return equal && matched == literal.size();
+            }
+            if (chunk.major != head.major || chunk.indefinite()) {
+                return check(status_code::malformed);
+            }
+            if (!check(cursor_.read_bytes(chunk.argument, compare))) {
+                return false;
+            }
+        }
+    }
+
+    // Runs the automaton of the array's entries over its items, the positions reached so far are the bits of a mask. Every item is
+    // matched once against each position that may come next, so the time grows with the items and not with the ways to split them.
+    bool array(const item_head &head, const cddl_node &node, std::size_t depth) {
+        const auto    positions = std::span(t_.positions).subspan(node.first, node.count);
+        std::uint64_t reached   = 1;
+        for (std::uint64_t i = 0; head.indefinite() || i < head.argument; ++i) {
+            if (head.indefinite()) {
+                auto      peek = cursor_;
+                item_head end;
+                if (peek.read_head(end) == status_code::success && end.is_break()) {
+                    cursor_ = peek;
+                    break;
+                }
+            }
+            std::uint64_t next = 0;
+            for (auto bits = reached; bits != 0; bits &= bits - 1) {
+                next |= positions[std::countr_zero(bits)].follow;
+            }
+            if (!advance(positions, next, depth)) {
+                return false;
+            }
+            reached = next;
+        }
+        for (auto bits = reached; bits != 0; bits &= bits - 1) {
+            if (positions[std::countr_zero(bits)].last) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Keeps the positions of candidates that match the next item and moves past it, positions of the same node are matched once
+    bool advance(std::span<const cddl_position> positions, std::uint64_t &candidates, std::size_t depth) {
+        const auto    start   = cursor_;
+        auto          after   = cursor_;
+        std::uint64_t tried   = 0;
+        std::uint64_t matched = 0;
+        for (auto bits = candidates & ~tried; bits != 0; bits = candidates & ~tried) {
+            const auto value = positions[std::countr_zero(bits)].value;
+            cursor_          = start;
+            const bool match = item(value, depth);
+            if (match) {
+                after = cursor_;
+            }
+            for (; bits != 0; bits &= bits - 1) {
+                if (const auto p = std::countr_zero(bits); positions[p].value == value) {
+                    tried   |= std::uint64_t{1} << p;
+                    matched |= match ? std::uint64_t{1} << p : 0;
+                }
+            }
+        }
+        cursor_    = after;
+        candidates = matched;
+        return matched != 0;
+    }
+
+    bool map(const item_head &head, const cddl_node &node, std::size_t depth) {
+        std::array<std::uint64_t, cddl_max_map_members> counts{};
+        for (std::uint64_t pair = 0; head.indefinite() || pair < head.argument; ++pair) {
+            if (head.indefinite()) {
+                auto      peek = cursor_;
+                item_head end;
+                if (peek.read_head(end) == status_code::success && end.is_break()) {
+                    cursor_ = peek;
+                    break;
+                }
+            }
+            if (!member(node, counts, depth)) {
+                return false;
+            }
+        }
+        for (std::uint32_t i = 0; i < node.count; ++i) {
+            if (counts[i] < t_.entries[node.first + i].min) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The first member whose key and value match the next pair, a cut key that matches without its value fails the map
+    bool member(const cddl_node &node, std::array<std::uint64_t, cddl_max_map_members> &counts, std::size_t depth) {
+        const auto start = cursor_;
+        for (std::uint32_t i = 0; i < node.count; ++i) {
+            const auto &entry = t_.entries[node.first + i];
+            if (counts[i] >= entry.max) {
+                continue;
+            }
+            cursor_ = start;
+            if (!item(entry.key, depth)) {
+                continue;
+            }
+            if (item(entry.value, depth)) {
+                ++counts[i];
+                return true;
+            }
+            if (entry.cut) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool deeper(std::size_t depth) { return depth != 0 || check(status_code::nesting_too_deep); }
+
+    // Keeps the first error of the buffer itself, which is reported instead of a mismatch
+    bool check(status_code status) {
+        if (status == status_code::success) {
+            return true;
+        }
+        if (status_ == status_code::schema_mismatch) {
+            status_ = status;
+        }
+        return false;
+    }
+
+    const cddl_tables &t_;
+    cursor<CborBuffer> cursor_;
+    status_code        status_{status_code::schema_mismatch};
+};
+
+} // namespace detail
+
+// A CDDL schema compiled to flat tables of nodes, group entries and choice edges. Compiling allocates, validating does not: it is a
+// single pass over the cursor, trying alternatives from copies of it.
+//
+//     auto schema = cddl_schema::compile(R"(reading = {sensor: tstr, values: [* int], ? unit: "C" / "F"})");
+//     if (schema && schema->validate(buffer)) { ... }
+//
+// Compiling reports invalid_schema for text outside the supported subset or names that are not defined. Validating reports
+// schema_mismatch, or the status of the first malformed or truncated item it ran into.
+class cddl_schema {
+  public:
+    static constexpr std::size_t max_map_members     = detail::cddl_max_map_members;
+    static constexpr std::size_t max_array_positions = detail::cddl_max_array_positions - 1;
+
+    static expected<cddl_schema, status_code> compile(std::string_view cddl) {
+        cddl_schema           schema;
+        detail::cddl_compiler compiler(schema.tables_);
+        if (!compiler.parse(cddl_prelude)) {
+            return unexpected<status_code>(status_code::invalid_schema);
+        }
+        const auto prelude = compiler.rules().size();
+        if (!compiler.parse(cddl) || compiler.rules().size() == prelude || !compiler.resolve() || compiler.rules()[prelude].group) {
+            return unexpected<status_code>(status_code::invalid_schema);
+        }
+        for (const auto &r : std::span(compiler.rules()).subspan(prelude)) {
+            if (!r.group) {
+                schema.rules_.emplace_back(std::string(r.name), r.node);
+            }
+        }
+        schema.root_ = compiler.rules()[prelude].node;
+        return schema;
+    }
+
+    // Validates that buffer holds exactly one item matching the first rule
+    template <ValidCborBuffer CborBuffer> expected<void, status_code> validate(const CborBuffer &buffer) const {
+        return validate_node(buffer, root_);
+    }
+
+    // Validates against a named type rule instead of the first one
+    template <ValidCborBuffer CborBuffer> expected<void, status_code> validate(const CborBuffer &buffer, std::string_view rule) const {
+        for (auto it = rules_.rbegin(); it != rules_.rend(); ++it) {
+            if (it->first == rule) {
+                return validate_node(buffer, it->second);
+            }
+        }
+        return unexpected<status_code>(status_code::invalid_schema);
+    }
+
+  private:
+    template <ValidCborBuffer CborBuffer> expected<void, status_code> validate_node(const CborBuffer &buffer, std::uint32_t node) const {
+        const auto status = detail::cddl_validator<CborBuffer>(tables_, buffer)(node);
+        if (status != status_code::success) {
+            return unexpected<status_code>(status);
+        }
+        return {};
+    }
+
+    detail::cddl_tables                                tables_;
+    std::vector<std::pair<std::string, std::uint32_t>> rules_;
+    std::uint32_t                                      root_{};
+};
+
+} // namespace cbor::tags
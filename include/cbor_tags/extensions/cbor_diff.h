@@ -0,0 +1,527 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_cursor.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/extensions/cbor_patch.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace cbor::tags {
+
+// A diff is itself CBOR, a list of operations applied in order:
+//
+//     diff  = [* op]
+//     op    = [path, item]         ; replace the item at path, or add it when the last step is a key missing from its map
+//           / [path]               ; remove the item at path, a key and its value from their map or an element from its array
+//           / [path, item, true]   ; insert item into an array before the element at path, or at its end for the index past it
+//     path  = [* step]             ; a map key as encoded in the document, or an array index
+//
+// Keys are copied byte for byte, so maps with keys of any type, including keys that are arrays or maps, can be diffed.
+
+namespace detail {
+
+using byte_span = std::span<const std::byte>;
+
+inline bool same_bytes(byte_span a, byte_span b) noexcept {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+inline bool bytes_less(byte_span a, byte_span b) noexcept {
+    const auto common = std::min(a.size(), b.size());
+    const auto order  = common == 0 ? 0 : std::memcmp(a.data(), b.data(), common);
+    return order < 0 || (order == 0 && a.size() < b.size());
+}
+
+// The first item of bytes split into its tags, its head and its children, a map has its keys and values interleaved
+struct split_item {
+    item_head              head;
+    std::size_t            tags{};   // Bytes of the tags in front of the head
+    std::size_t            prefix{}; // Bytes of the tags and the head
+    std::size_t            size{};   // Bytes of the whole item
+    std::vector<byte_span> children;
+};
+
+inline status_code split(byte_span bytes, std::size_t depth, split_item &out) {
+    cursor<byte_span> cur(bytes);
+    out.children.clear();
+    do {
+        out.tags = cur.offset();
+        if (auto status = cur.read_head(out.head); status != status_code::success) {
+            return status;
+        }
+    } while (out.head.major == major_type::Tag);
+    out.prefix = cur.offset();
+    if (out.head.is_break()) {
+        return status_code::malformed;
+    }
+    if (out.head.major != major_type::Array && out.head.major != major_type::Map) {
+        const auto status = cur.skip_content(out.head, depth);
+        out.size          = cur.offset();
+        return status;
+    }
+    if (depth == 0) {
+        return status_code::nesting_too_deep;
+    }
+    if (!out.head.indefinite() && out.head.argument > cur.remaining()) {
+        return status_code::incomplete; // Every child takes at least a byte
+    }
+
+    const std::uint64_t per_entry = out.head.major == major_type::Map ? 2 : 1;
+    for (std::uint64_t i = 0; out.head.indefinite() || i < out.head.argument * per_entry; ++i) {
+        if (out.head.indefinite() && i % per_entry == 0) {
+            auto      probe = cur;
+            item_head next;
+            if (auto status = probe.read_head(next); status != status_code::success) {
+                return status;
+            }
+            if (next.is_break()) {
+                cur = probe;
+                break;
+            }
+        }
+        const auto start = cur.offset();
+        if (auto status = cur.skip(depth - 1); status != status_code::success) {
+            return status;
+        }
+        out.children.push_back(bytes.subspan(start, cur.offset() - start));
+    }
+    out.size = cur.offset();
+    return status_code::success;
+}
+
+// Walks two documents side by side. Subtrees with the same bytes are passed over with a single memcmp, and arrays and maps are only
+// entered when the operations inside them rebuild the new document byte for byte, otherwise the whole item is replaced. Arrays keep
+// the elements they start and end with, and the ones in between are diffed by position, with the rest removed or inserted.
+class document_differ {
+  public:
+    status_code operator()(byte_span from, byte_span to) {
+        cursor<byte_span> a(from);
+        cursor<byte_span> b(to);
+        if (auto status = a.skip(cursor<byte_span>::default_max_depth); status != status_code::success) {
+            return status;
+        }
+        if (auto status = b.skip(cursor<byte_span>::default_max_depth); status != status_code::success) {
+            return status;
+        }
+        return item(from.first(a.offset()), to.first(b.offset()), cursor<byte_span>::default_max_depth);
+    }
+
+    std::size_t                   count() const noexcept { return count_; }
+    const std::vector<std::byte> &operations() const noexcept { return operations_; }
+
+  private:
+    struct step {
+        byte_span     key;
+        std::uint64_t index{};
+    };
+
+    // from and to are exactly one item each
+    status_code item(byte_span from, byte_span to, std::size_t depth) {
+        if (same_bytes(from, to)) {
+            return status_code::success;
+        }
+        split_item a;
+        split_item b;
+        if (auto status = split(from, depth, a); status != status_code::success) {
+            return status;
+        }
+        if (auto status = split(to, depth, b); status != status_code::success) {
+            return status;
+        }
+
+        const bool same_container = a.head.major == b.head.major && a.head.indefinite() == b.head.indefinite() &&
+                                    (a.head.major == major_type::Array || a.head.major == major_type::Map) &&
+                                    same_bytes(from.first(a.tags), to.first(b.tags));
+        if (same_container && a.head.major == major_type::Array) {
+            return array(from, to, a, b, depth);
+        }
+        if (same_container && a.head.major == major_type::Map) {
+            return map(from, to, a, b, depth);
+        }
+        return set(to);
+    }
+
+    // The head written back by the applier after adding or removing entries is the shortest one, otherwise the old head stays
+    static bool rebuilds_head(byte_span from, byte_span to, const split_item &a, const split_item &b, bool resized) {
+        if (a.head.indefinite()) {
+            return true;
+        }
+        std::vector<std::byte> head;
+        auto                   enc     = make_encoder(head);
+        const auto             entries = b.head.major == major_type::Map ? b.children.size() / 2 : b.children.size();
+        if (b.head.major == major_type::Map) {
+            enc(as_map{entries});
+        } else {
+            enc(as_array{entries});
+        }
+        const auto expected_head = resized ? byte_span(head) : from.subspan(a.tags, a.prefix - a.tags);
+        return same_bytes(expected_head, to.subspan(b.tags, b.prefix - b.tags));
+    }
+
+    status_code array(byte_span from, byte_span to, const split_item &a, const split_item &b, std::size_t depth) {
+        const auto m = a.children.size();
+        const auto n = b.children.size();
+        if (!rebuilds_head(from, to, a, b, m != n)) {
+            return set(to);
+        }
+
+        std::size_t first = 0;
+        while (first < std::min(m, n) && same_bytes(a.children[first], b.children[first])) {
+            ++first;
+        }
+        std::size_t last = 0; // Elements kept at the end
+        while (last < std::min(m, n) - first && same_bytes(a.children[m - 1 - last], b.children[n - 1 - last])) {
+            ++last;
+        }
+
+        // Indices are of the array as it is when each operation is applied: removals go from the back, then insertions from the front
+        const auto paired = std::min(m, n) - first - last;
+        for (std::size_t i = first; i < first + paired; ++i) {
+            path_.push_back({.key = {}, .index = i});
+            const auto status = item(a.children[i], b.children[i], depth - 1);
+            path_.pop_back();
+            if (status != status_code::success) {
+                return status;
+            }
+        }
+        for (std::size_t i = m - last; i-- > first + paired;) {
+            path_.push_back({.key = {}, .index = i});
+            const auto status = remove();
+            path_.pop_back();
+            if (status != status_code::success) {
+                return status;
+            }
+        }
+        for (std::size_t i = first + paired; i < n - last; ++i) {
+            path_.push_back({.key = {}, .index = i});
+            const auto status = insert(b.children[i]);
+            path_.pop_back();
+            if (status != status_code::success) {
+                return status;
+            }
+        }
+        return status_code::success;
+    }
+
+    status_code map(byte_span from, byte_span to, const split_item &a, const split_item &b, std::size_t depth) {
+        const auto a_pairs = a.children.size() / 2;
+        const auto b_pairs = b.children.size() / 2;
+
+        std::vector<std::size_t> sorted(a_pairs);
+        for (std::size_t i = 0; i < a_pairs; ++i) {
+            sorted[i] = i;
+        }
+        std::ranges::stable_sort(sorted, [&](std::size_t x, std::size_t y) { return bytes_less(a.children[2 * x], a.children[2 * y]); });
+
+        // Kept keys must stay in their order and come before the added ones, which the applier appends
+        std::vector<bool>                       kept(a_pairs, false);
+        std::vector<std::optional<std::size_t>> match(b_pairs);
+        std::size_t                             last_kept = 0;
+        bool                                    adding    = false;
+        for (std::size_t i = 0; i < b_pairs; ++i) {
+            const auto key = b.children[2 * i];
+            auto it = std::lower_bound(sorted.begin(), sorted.end(), key,
+                                       [&](std::size_t x, byte_span k) { return bytes_less(a.children[2 * x], k); });
+            while (it != sorted.end() && same_bytes(a.children[2 * *it], key) && kept[*it]) {
+                ++it;
+            }
+            if (it != sorted.end() && same_bytes(a.children[2 * *it], key)) {
+                if (adding || *it < last_kept) {
+                    return set(to);
+                }
+                kept[*it] = true;
+                match[i]  = *it;
+                last_kept = *it + 1;
+            } else {
+                adding = true;
+            }
+        }
+        if (!rebuilds_head(from, to, a, b, adding || std::ranges::find(kept, false) != kept.end())) {
+            return set(to);
+        }
+
+        for (std::size_t i = 0; i < a_pairs; ++i) {
+            if (!kept[i]) {
+                path_.push_back({.key = a.children[2 * i]});
+                const auto status = remove();
+                path_.pop_back();
+                if (status != status_code::success) {
+                    return status;
+                }
+            }
+        }
+        for (std::size_t i = 0; i < b_pairs; ++i) {
+            path_.push_back({.key = b.children[2 * i]});
+            const auto status =
+                match[i] ? item(a.children[2 * *match[i] + 1], b.children[2 * i + 1], depth - 1) : set(b.children[2 * i + 1]);
+            path_.pop_back();
+            if (status != status_code::success) {
+                return status;
+            }
+        }
+        return status_code::success;
+    }
+
+    status_code set(byte_span to) { return operation(to); }
+    status_code remove() { return operation(std::nullopt); }
+    status_code insert(byte_span item) { return operation(item, true); }
+
+    status_code operation(std::optional<byte_span> to, bool inserting = false) {
+        auto enc    = make_encoder(operations_);
+        auto result = enc(as_array{inserting ? 3u : to ? 2u : 1u}, as_array{path_.size()});
+        for (const auto &step : path_) {
+            if (!result) {
+                break;
+            }
+            result = step.key.empty() ? enc(step.index) : enc(raw_cbor{step.key});
+        }
+        if (result && to) {
+            result = enc(raw_cbor{*to});
+        }
+        if (result && inserting) {
+            result = enc(true);
+        }
+        if (!result) {
+            return result.error();
+        }
+        ++count_;
+        return status_code::success;
+    }
+
+    std::vector<step>      path_;
+    std::vector<std::byte> operations_;
+    std::size_t            count_{0};
+};
+
+// Where a path of a diff leads in a document
+struct diff_target {
+    item_range  item;       // The item at the path, or the map or array that misses its last step
+    item_range  pair;       // The last key and its value, in a map
+    std::size_t head_offset{};
+    std::size_t head_size{};
+    item_head   head;       // Of the container of the last step
+    bool        found{};
+};
+
+inline status_code locate(byte_span document, std::span<const byte_span> path, std::size_t depth, diff_target &target) {
+    cursor<byte_span> cur(document);
+    target = {};
+    if (auto status = cur.skip(depth); status != status_code::success) {
+        return status;
+    }
+    target.item  = {0, cur.offset()};
+    target.found = true;
+
+    for (std::size_t s = 0; s < path.size(); ++s, --depth) {
+        cur = cursor<byte_span>(document);
+        if (auto status = cur.skip_bytes(target.item.offset); status != status_code::success) {
+            return status;
+        }
+        do {
+            target.head_offset = cur.offset();
+            if (auto status = cur.read_head(target.head); status != status_code::success) {
+                return status;
+            }
+        } while (target.head.major == major_type::Tag);
+        target.head_size = cur.offset() - target.head_offset;
+        if (depth == 0) {
+            return status_code::nesting_too_deep;
+        }
+
+        const bool    is_map = target.head.major == major_type::Map;
+        std::uint64_t index  = 0;
+        if (target.head.major == major_type::Array) {
+            cursor<byte_span> step(path[s]);
+            item_head         step_head;
+            if (auto status = step.read_head(step_head); status != status_code::success) {
+                return status;
+            }
+            if (step_head.major != major_type::UnsignedInteger) {
+                return status_code::not_found;
+            }
+            index = step_head.argument;
+        } else if (!is_map) {
+            return status_code::not_found;
+        }
+
+        bool          found = false;
+        std::uint64_t count = 0;
+        for (; !found && (target.head.indefinite() || count < target.head.argument); ++count) {
+            if (target.head.indefinite()) {
+                auto      probe = cur;
+                item_head next;
+                if (auto status = probe.read_head(next); status != status_code::success) {
+                    return status;
+                }
+                if (next.is_break()) {
+                    break;
+                }
+            }
+            const auto start = cur.offset();
+            if (is_map) {
+                if (auto status = cur.skip(depth - 1); status != status_code::success) {
+                    return status;
+                }
+                found = same_bytes(document.subspan(start, cur.offset() - start), path[s]);
+            } else {
+                found = count == index;
+            }
+            const auto value = cur.offset();
+            if (auto status = cur.skip(depth - 1); status != status_code::success) {
+                return status;
+            }
+            if (found) {
+                target.pair = {start, cur.offset() - start};
+                target.item = {value, cur.offset() - value};
+            }
+        }
+        if (!found) {
+            // Only the last step may be missing, a key the operation adds to the map or the index past the end of the array
+            target.found = false;
+            return s + 1 == path.size() && (is_map || index == count) ? status_code::success : status_code::not_found;
+        }
+    }
+    return status_code::success;
+}
+
+} // namespace detail
+
+// Writes the operations that turn the first item of from into the first item of to, in the format above, as a single array appended
+// to output, and returns how many there are. Applying them to from with apply_diff rebuilds to byte for byte.
+template <ValidCborBuffer FromBuffer, ValidCborBuffer ToBuffer, ValidCborBuffer OutputBuffer>
+    requires IsContiguous<FromBuffer> && IsContiguous<ToBuffer>
+expected<std::size_t, status_code> diff(const FromBuffer &from, const ToBuffer &to, OutputBuffer &output) {
+    const auto as_bytes = [](const auto &buffer) {
+        return detail::byte_span(reinterpret_cast<const std::byte *>(std::ranges::data(buffer)), std::ranges::size(buffer));
+    };
+    detail::document_differ differ;
+    if (auto status = differ(as_bytes(from), as_bytes(to)); status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    auto enc = make_encoder(output);
+    if (auto result = enc(as_array{differ.count()}, raw_cbor{differ.operations()}); !result) {
+        return unexpected<status_code>(result.error());
+    }
+    return differ.count();
+}
+
+// Applies the operations of a diff to the first item of buffer in order, splicing each item in like patch_encoded does. Fails with
+// not_found when a path does not lead anywhere in buffer, e.g because the diff was made against another document; the operations
+// before the failing one stay applied.
+template <ValidCborBuffer CborBuffer, ValidCborBuffer DiffBuffer>
+    requires IsContiguous<CborBuffer> && IsContiguous<DiffBuffer>
+expected<void, status_code> apply_diff(CborBuffer &buffer, const DiffBuffer &diff) {
+    const detail::byte_span bytes(reinterpret_cast<const std::byte *>(std::ranges::data(diff)), std::ranges::size(diff));
+    const auto              fail = [](status_code status) { return unexpected<status_code>(status); };
+    const auto              read = [&](cursor<detail::byte_span> &cur, detail::byte_span &item) {
+        const auto start  = cur.offset();
+        const auto status = cur.skip(cursor<detail::byte_span>::default_max_depth);
+        item              = bytes.subspan(start, cur.offset() - start);
+        return status;
+    };
+
+    cursor<detail::byte_span> cur(bytes);
+    item_head                 head;
+    if (auto status = cur.read_head(head); status != status_code::success) {
+        return fail(status);
+    }
+    if (head.major != major_type::Array || head.indefinite()) {
+        return fail(status_code::malformed);
+    }
+
+    std::vector<detail::byte_span> path;
+    for (std::uint64_t op = 0; op < head.argument; ++op) {
+        item_head op_head;
+        item_head path_head;
+        if (auto status = cur.read_head(op_head); status != status_code::success) {
+            return fail(status);
+        }
+        if (op_head.major != major_type::Array || op_head.argument < 1 || op_head.argument > 3) {
+            return fail(status_code::malformed);
+        }
+        if (auto status = cur.read_head(path_head); status != status_code::success) {
+            return fail(status);
+        }
+        if (path_head.major != major_type::Array || path_head.indefinite()) {
+            return fail(status_code::malformed);
+        }
+        path.resize(path_head.argument);
+        for (auto &step : path) {
+            if (auto status = read(cur, step); status != status_code::success) {
+                return fail(status);
+            }
+        }
+        detail::byte_span item;
+        if (op_head.argument >= 2) {
+            if (auto status = read(cur, item); status != status_code::success) {
+                return fail(status);
+            }
+        }
+        if (op_head.argument == 3) {
+            item_head flag;
+            if (auto status = cur.read_head(flag); status != status_code::success) {
+                return fail(status);
+            }
+            if (flag.major != major_type::Simple || flag.argument != 21) {
+                return fail(status_code::malformed);
+            }
+        }
+
+        const detail::byte_span document(reinterpret_cast<const std::byte *>(std::ranges::data(buffer)), std::ranges::size(buffer));
+        detail::diff_target     target;
+        if (auto status = detail::locate(document, path, cursor<detail::byte_span>::default_max_depth, target);
+            status != status_code::success) {
+            return fail(status);
+        }
+
+        if (op_head.argument == 2) {
+            if (target.found) {
+                if (auto status = detail::splice(buffer, target.item.offset, target.item.size, item); status != status_code::success) {
+                    return fail(status);
+                }
+            } else if (auto added = detail::insert_pair(buffer, target.item, path.back(), item); !added) {
+                return fail(added.error());
+            }
+            continue;
+        }
+
+        // Insertions and removals change the count of their container, and the head is written back in its shortest form
+        const bool inserting = op_head.argument == 3;
+        if (path.empty() || (inserting ? target.head.major != major_type::Array : !target.found)) {
+            return fail(status_code::not_found);
+        }
+        auto status = status_code::success;
+        if (inserting) {
+            const auto end = target.item.offset + target.item.size - (target.head.indefinite() ? 1 : 0);
+            status         = detail::splice(buffer, target.found ? target.item.offset : end, 0, item);
+        } else {
+            status = detail::splice(buffer, target.pair.offset, target.pair.size, {});
+        }
+        if (status != status_code::success) {
+            return fail(status);
+        }
+        if (!target.head.indefinite()) {
+            const auto             count = inserting ? target.head.argument + 1 : target.head.argument - 1;
+            std::vector<std::byte> head;
+            auto                   enc = make_encoder(head);
+            if (target.head.major == major_type::Map) {
+                enc(as_map{count});
+            } else {
+                enc(as_array{count});
+            }
+            if (status = detail::splice(buffer, target.head_offset, target.head_size, head); status != status_code::success) {
+                return fail(status);
+            }
+        }
+    }
+    return {};
+}
+
+} // namespace cbor::tags
@@ -0,0 +1,486 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_cursor.h"
+#include "cbor_tags/float16_ieee754.h"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <span>
+
+namespace cbor::tags {
+
+struct hash128 {
+    std::uint64_t low{};  // XXH64 of the bytes
+    std::uint64_t high{}; // XXH64 of the same bytes with the seed xor content_hasher::high_seed
+
+    constexpr bool operator==(const hash128 &) const = default;
+};
+
+// Streaming XXH64 over bytes fed in pieces of any size, the result does not depend on how the input was split. Four 64 bit lanes
+// take 32 byte stripes and digest() finishes them exactly like XXH64. A second set of lanes runs XXH64 with another seed over the same
+// stripes, digest128() pairs both results for a 128 bit key. Fast and well distributed, but not a cryptographic hash: do not use it
+// where an attacker picks the documents and gains from a collision.
+class content_hasher {
+  public:
+    static constexpr std::uint64_t high_seed = 0x9E3779B97F4A7C15ULL;
+
+    constexpr explicit content_hasher(std::uint64_t seed = 0) noexcept : low_(seed), high_(seed ^ high_seed) {}
+
+    void update(std::span<const std::byte> bytes) noexcept {
+        total_ += bytes.size();
+        if (buffered_ + bytes.size() < stripe_.size()) {
+            if (!bytes.empty()) {
+                std::memcpy(stripe_.data() + buffered_, bytes.data(), bytes.size());
+            }
+            buffered_ += bytes.size();
+            return;
+        }
+        if (buffered_ > 0) {
+            const auto fill = stripe_.size() - buffered_;
+            std::memcpy(stripe_.data() + buffered_, bytes.data(), fill);
+            consume(stripe_.data());
+            bytes     = bytes.subspan(fill);
+            buffered_ = 0;
+        }
+        while (bytes.size() >= stripe_.size()) {
+            consume(bytes.data());
+            bytes = bytes.subspan(stripe_.size());
+        }
+        if (!bytes.empty()) {
+            std::memcpy(stripe_.data(), bytes.data(), bytes.size());
+        }
+        buffered_ = bytes.size();
+    }
+
+    void update(std::byte b) noexcept { update(std::span<const std::byte>(&b, 1)); }
+
+    std::uint64_t digest() const noexcept { return finish(low_); }
+
+    hash128 digest128() const noexcept { return {finish(low_), finish(high_)}; }
+
+  private:
+    struct state {
+        constexpr explicit state(std::uint64_t s) noexcept : lanes{s + prime1 + prime2, s + prime2, s, s - prime1}, seed(s) {}
+
+        std::array<std::uint64_t, 4> lanes;
+        std::uint64_t                seed;
+    };
+
+    static constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    static constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+    static constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+    static constexpr std::uint64_t read64(const std::byte *p) noexcept {
+        std::uint64_t value = 0;
+        for (int i = 7; i >= 0; --i) {
+            value = (value << 8) | static_cast<std::uint64_t>(p[i]);
+        }
+        return value;
+    }
+    static constexpr std::uint64_t read32(const std::byte *p) noexcept {
+        std::uint64_t value = 0;
+        for (int i = 3; i >= 0; --i) {
+            value = (value << 8) | static_cast<std::uint64_t>(p[i]);
+        }
+        return value;
+    }
+
+    static constexpr std::uint64_t round(std::uint64_t acc, std::uint64_t input) noexcept {
+        return std::rotl(acc + input * prime2, 31) * prime1;
+    }
+
+    static constexpr std::uint64_t avalanche(std::uint64_t hash) noexcept {
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        return hash ^ (hash >> 32);
+    }
+
+    void consume(const std::byte *stripe) noexcept {
+        for (std::size_t i = 0; i < 4; ++i) {
+            const auto input = read64(stripe + 8 * i);
+            low_.lanes[i]    = round(low_.lanes[i], input);
+            high_.lanes[i]   = round(high_.lanes[i], input);
+        }
+    }
+
+    std::uint64_t finish(const state &s) const noexcept {
+        auto hash = s.seed + prime5;
+        if (total_ >= stripe_.size()) {
+            const auto &lanes = s.lanes;
+            hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+            for (const auto lane : lanes) {
+                hash = (hash ^ round(0, lane)) * prime1 + prime4;
+            }
+        }
+        return avalanche(tail(hash + total_));
+    }
+
+    // The bytes left over after the last full stripe
+    std::uint64_t tail(std::uint64_t hash) const noexcept {
+        std::size_t i = 0;
+        for (; i + 8 <= buffered_; i += 8) {
+            hash ^= round(0, read64(stripe_.data() + i));
+            hash = std::rotl(hash, 27) * prime1 + prime4;
+        }
+        if (i + 4 <= buffered_) {
+            hash ^= read32(stripe_.data() + i) * prime1;
+            hash = std::rotl(hash, 23) * prime2 + prime3;
+            i += 4;
+        }
+        for (; i < buffered_; ++i) {
+            hash ^= static_cast<std::uint64_t>(stripe_[i]) * prime5;
+            hash = std::rotl(hash, 11) * prime1;
+        }
+        return hash;
+    }
+
+    state                     low_;
+    state                     high_;
+    std::array<std::byte, 32> stripe_{};
+    std::size_t               buffered_{0};
+    std::uint64_t             total_{0};
+};
+
+struct hash_options {
+    std::uint64_t seed{0};
+    // Hash the content rather than the encoding: heads in their shortest form, floats in the shortest width that holds them exactly
+    // (preferred serialization, RFC 8949 section 4.1) with every NaN as f97e00, indefinite lengths as definite ones and maps as
+    // unordered sets of pairs, so every encoding of the same data hashes the same.
+    bool canonical{false};
+};
+
+namespace detail {
+
+// Feeds an item to a content_hasher in its canonical form, see hash_options::canonical. The canonical form is never written out, each
+// head is rebuilt on the stack and string content is fed from the buffer as the cursor hands it out.
+template <ValidCborBuffer CborBuffer> class canonical_hasher {
+  public:
+    explicit canonical_hasher(const CborBuffer &buffer, std::uint64_t seed) : cursor_(buffer), seed_(seed) {}
+
+    status_code operator()(content_hasher &hasher) { return item(hasher, cursor<CborBuffer>::default_max_depth); }
+
+  private:
+    status_code item(content_hasher &hasher, std::size_t depth) {
+        item_head head;
+        do {
+            if (auto status = cursor_.read_head(head); status != status_code::success) {
+                return status;
+            }
+            if (head.major == major_type::Tag) {
+                feed_head(hasher, head.major, head.argument);
+            }
+        } while (head.major == major_type::Tag);
+
+        switch (head.major) {
+        case major_type::UnsignedInteger:
+        case major_type::NegativeInteger: feed_head(hasher, head.major, head.argument); return status_code::success;
+        case major_type::ByteString:
+        case major_type::TextString: return string(hasher, head);
+        case major_type::Array:
+        case major_type::Map: return container(hasher, head, depth);
+        default: break;
+        }
+        if (head.is_break()) {
+            return status_code::malformed;
+        }
+
+        // Simple values as they are, floats in their shortest exact width
+        auto info     = static_cast<std::uint8_t>(head.info);
+        auto argument = head.argument;
+        if (info >= 25 && info <= 27) {
+            shortest_float(info, argument);
+        }
+        std::array<std::byte, 9> bytes{static_cast<std::byte>(0xE0 | info)};
+        const auto               width = info >= 24 && info <= 27 ? 1 << (info - 24) : 0;
+        for (int i = 0; i < width; ++i) {
+            bytes[static_cast<std::size_t>(width - i)] = static_cast<std::byte>(argument >> (8 * i));
+        }
+        hasher.update(std::span<const std::byte>(bytes.data(), static_cast<std::size_t>(1 + width)));
+        return status_code::success;
+    }
+
+    // Narrows a float of additional info 25, 26 or 27 to the shortest of them that holds the same value
+    static void shortest_float(std::uint8_t &info, std::uint64_t &argument) noexcept {
+        double value{};
+        switch (info) {
+        case 25: value = static_cast<float>(float16_t{static_cast<std::uint16_t>(argument)}); break;
+        case 26: value = std::bit_cast<float>(static_cast<std::uint32_t>(argument)); break;
+        default: value = std::bit_cast<double>(argument);
+        }
+        if (std::isnan(value)) {
+            info     = 25;
+            argument = 0x7E00;
+            return;
+        }
+        const auto single = static_cast<float>(value);
+        if (static_cast<double>(single) != value) {
+            info     = 27;
+            argument = std::bit_cast<std::uint64_t>(value);
+            return;
+        }
+
+        // Half precision has 5 exponent and 10 mantissa bits, below 2^-14 it has subnormals down to 2^-24
+        const auto bits     = std::bit_cast<std::uint32_t>(single);
+        const auto sign     = static_cast<std::uint64_t>(bits >> 16 & 0x8000);
+        const auto exponent = static_cast<int>(bits >> 23 & 0xFF) - 127;
+        const auto mantissa = bits & 0x7FFFFF;
+        info                = 25;
+        if (std::isinf(single) || single == 0) {
+            argument = sign | (std::isinf(single) ? 0x7C00 : 0);
+            return;
+        }
+        if (exponent >= -24 && exponent <= 15) {
+            const bool normal = exponent >= -14;
+            const auto kept   = normal ? mantissa : mantissa | 0x800000; // Subnormals keep the implicit leading bit
+            const auto shift  = normal ? 13 : -1 - exponent;
+            if ((kept & ((1U << shift) - 1)) == 0) {
+                argument = sign | (normal ? static_cast<std::uint64_t>(exponent + 15) << 10 : 0) | kept >> shift;
+                return;
+            }
+        }
+        info     = 26;
+        argument = bits;
+    }
+
+    status_code string(content_hasher &hasher, const item_head &head) {
+        const auto feed = [&hasher](std::span<const std::byte> chunk) { hasher.update(chunk); };
+        if (!head.indefinite()) {
+            feed_head(hasher, head.major, head.argument);
+            return cursor_.read_bytes(head.argument, feed);
+        }
+
+        // The length of the definite string is the sum of the chunks, found on a copy of the cursor first
+        std::uint64_t length = 0;
+        for (auto probe = cursor_;;) {
+            item_head chunk;
+            if (auto status = probe.read_head(chunk); status != status_code::success) {
+                return status;
+            }
+            if (chunk.is_break()) {
+                break;
+            }
+            if (chunk.major != head.major || chunk.indefinite()) {
+                return status_code::malformed;
+            }
+            if (auto status = probe.skip_bytes(chunk.argument); status != status_code::success) {
+                return status;
+            }
+            length += chunk.argument;
+        }
+        feed_head(hasher, head.major, length);
+        for (item_head chunk;;) {
+            if (auto status = cursor_.read_head(chunk); status != status_code::success || chunk.is_break()) {
+                return status;
+            }
+            if (auto status = cursor_.read_bytes(chunk.argument, feed); status != status_code::success) {
+                return status;
+            }
+        }
+    }
+
+    status_code container(content_hasher &hasher, const item_head &head, std::size_t depth) {
+        if (depth == 0) {
+            return status_code::nesting_too_deep;
+        }
+        const bool is_map = head.major == major_type::Map;
+
+        std::uint64_t count = head.argument;
+        if (head.indefinite()) {
+            if (auto status = count_children(head, count, depth); status != status_code::success) {
+                return status;
+            }
+        }
+        feed_head(hasher, head.major, count);
+
+        // Pairs are hashed one by one and summed, so the order of the keys does not matter
+        std::uint64_t low  = 0;
+        std::uint64_t high = 0;
+        for (std::uint64_t i = 0; i < count; ++i) {
+            if (!is_map) {
+                if (auto status = item(hasher, depth - 1); status != status_code::success) {
+                    return status;
+                }
+                continue;
+            }
+            content_hasher pair(seed_);
+            if (auto status = item(pair, depth - 1); status != status_code::success) {
+                return status;
+            }
+            if (auto status = item(pair, depth - 1); status != status_code::success) {
+                return status;
+            }
+            const auto digest = pair.digest128();
+            low += digest.low;
+            high += digest.high;
+        }
+        if (head.indefinite()) {
+            item_head end; // The break, already seen by count_children
+            if (auto status = cursor_.read_head(end); status != status_code::success) {
+                return status;
+            }
+        }
+        if (is_map) {
+            std::array<std::byte, 16> sums{};
+            for (std::size_t b = 0; b < 8; ++b) {
+                sums[b]     = static_cast<std::byte>(low >> (8 * b));
+                sums[8 + b] = static_cast<std::byte>(high >> (8 * b));
+            }
+            hasher.update(sums);
+        }
+        return status_code::success;
+    }
+
+    // Counts the children of an indefinite array or map on a copy of the cursor
+    status_code count_children(const item_head &head, std::uint64_t &count, std::size_t depth) {
+        const std::uint64_t per_entry = head.major == major_type::Map ? 2 : 1;
+        std::uint64_t       items     = 0;
+        for (auto probe = cursor_;; ++items) {
+            if (items % per_entry == 0) {
+                auto      peek = probe;
+                item_head next;
+                if (auto status = peek.read_head(next); status != status_code::success) {
+                    return status;
+                }
+                if (next.is_break()) {
+                    break;
+                }
+            }
+            if (auto status = probe.skip(depth - 1); status != status_code::success) {
+                return status;
+            }
+        }
+        count = items / per_entry;
+        return status_code::success;
+    }
+
+    static void feed_head(content_hasher &hasher, major_type major, std::uint64_t argument) {
+        std::array<std::byte, 9> bytes{};
+        const auto               initial = static_cast<std::byte>(static_cast<std::uint8_t>(major) << 5);
+        std::size_t              width   = 0;
+        if (argument < 24) {
+            bytes[0] = initial | static_cast<std::byte>(argument);
+        } else {
+            width    = argument <= 0xFF ? 1 : argument <= 0xFFFF ? 2 : argument <= 0xFFFFFFFF ? 4 : 8;
+            bytes[0] = initial | static_cast<std::byte>(23 + std::countr_zero(width) + 1);
+            for (std::size_t i = 0; i < width; ++i) {
+                bytes[width - i] = static_cast<std::byte>(argument >> (8 * i));
+            }
+        }
+        hasher.update(std::span<const std::byte>(bytes.data(), 1 + width));
+    }
+
+    cursor<CborBuffer> cursor_;
+    std::uint64_t      seed_;
+};
+
+// Hides that an iterator is random access or contiguous, so a buffer exposing it is one the encoder only appends to
+template <typename Iterator> class forward_only_iterator {
+  public:
+    using iterator_concept  = std::forward_iterator_tag;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::iter_value_t<Iterator>;
+    using difference_type   = std::iter_difference_t<Iterator>;
+    using reference         = std::iter_reference_t<Iterator>;
+
+    forward_only_iterator() = default;
+    explicit forward_only_iterator(Iterator it) : it_(it) {}
+    template <typename Other>
+        requires std::convertible_to<Other, Iterator>
+    forward_only_iterator(const forward_only_iterator<Other> &other) : it_(other.base()) {}
+
+    reference              operator*() const { return *it_; }
+    forward_only_iterator &operator++() {
+        ++it_;
+        return *this;
+    }
+    forward_only_iterator operator++(int) {
+        auto copy = *this;
+        ++it_;
+        return copy;
+    }
+    bool operator==(const forward_only_iterator &) const = default;
+
+    const Iterator &base() const noexcept { return it_; }
+
+  private:
+    Iterator it_{};
+};
+
+} // namespace detail
+
+// Hashes the first item of buffer, by default its encoded bytes, with hash_options::canonical its content. low of the result is the
+// 64 bit hash, the pair the 128 bit one.
+template <ValidCborBuffer CborBuffer> expected<hash128, status_code> hash_item(const CborBuffer &buffer, hash_options options = {}) {
+    content_hasher hasher(options.seed);
+    if (options.canonical) {
+        detail::canonical_hasher<CborBuffer> canonical(buffer, options.seed);
+        if (auto status = canonical(hasher); status != status_code::success) {
+            return unexpected<status_code>(status);
+        }
+        return hasher.digest128();
+    }
+
+    cursor<CborBuffer> measure(buffer);
+    if (auto status = measure.skip(cursor<CborBuffer>::default_max_depth); status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    cursor<CborBuffer> read(buffer);
+    if (auto status = read.read_bytes(measure.offset(), [&hasher](std::span<const std::byte> chunk) { hasher.update(chunk); });
+        status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    return hasher.digest128();
+}
+
+// An output buffer for make_encoder that hashes the bytes on their way into buffer, so the hash of an encoded message is ready when
+// encoding ends, without reading the message again. Its iterators only step forward, so even over a std::vector the encoder treats it
+// as non-contiguous and only appends, and no byte reaches buffer without passing the hasher.
+template <ValidCborBuffer Buffer> class hashing_buffer {
+  public:
+    using value_type     = typename Buffer::value_type;
+    using size_type      = typename Buffer::size_type;
+    using iterator       = detail::forward_only_iterator<typename Buffer::iterator>;
+    using const_iterator = detail::forward_only_iterator<typename Buffer::const_iterator>;
+
+    explicit hashing_buffer(Buffer &buffer, std::uint64_t seed = 0) : buffer_(buffer), hasher_(seed) {}
+
+    void push_back(value_type value) {
+        hasher_.update(static_cast<std::byte>(value));
+        buffer_.push_back(value);
+    }
+    iterator insert(const_iterator position, const value_type *first, const value_type *last) {
+        hasher_.update(std::span<const std::byte>(reinterpret_cast<const std::byte *>(first), static_cast<std::size_t>(last - first)));
+        return iterator(buffer_.insert(position.base(), first, last));
+    }
+    iterator insert(const_iterator position, std::initializer_list<value_type> values) {
+        return insert(position, values.begin(), values.end());
+    }
+
+    iterator       begin() { return iterator(buffer_.begin()); }
+    iterator       end() { return iterator(buffer_.end()); }
+    const_iterator begin() const { return const_iterator(buffer_.cbegin()); }
+    const_iterator end() const { return const_iterator(buffer_.cend()); }
+    size_type      size() const { return buffer_.size(); }
+
+    const content_hasher &hasher() const noexcept { return hasher_; }
+    std::uint64_t         digest() const noexcept { return hasher_.digest(); }
+    hash128               digest128() const noexcept { return hasher_.digest128(); }
+
+  private:
+    Buffer        &buffer_;
+    content_hasher hasher_;
+};
+
+} // namespace cbor::tags
@@ -0,0 +1,864 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_cursor.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/float16_ieee754.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace cbor::tags {
+
+// How byte strings are written as JSON strings, tags 21 to 23 switch it for the items they enclose (RFC 8949 3.4.5.2)
+enum class json_bytes : std::uint8_t { base64url, base64, base16 };
+
+// How tags are written: content keeps only the enclosed item as RFC 8949 6.1 suggests, object writes {"tag": N, "value": item}
+enum class json_tags : std::uint8_t { content, object };
+
+struct json_options {
+    json_bytes  bytes{json_bytes::base64url};
+    json_tags   tags{json_tags::content};
+    std::size_t max_depth{256};
+};
+
+// Arrays and objects parsed from JSON are definite length by default, which needs a contiguous output buffer that can grow, e.g
+// std::vector. Other buffers always get indefinite length, since the item count is only known at the closing bracket.
+enum class json_containers : std::uint8_t { definite, indefinite };
+
+struct json_parse_options {
+    json_containers containers{json_containers::definite};
+    std::size_t     max_depth{256};
+};
+
+namespace detail {
+
+// Buffers JSON text in a small array and hands it to the output in blocks, so writing a character is a store and a compare. The output
+// is a callable taking std::string_view or a container of byte sized values, e.g std::string, std::vector<char> or fmt::memory_buffer.
+template <typename Output> class json_writer {
+  public:
+    static constexpr std::size_t capacity = 512;
+
+    constexpr explicit json_writer(Output &output) : output_(output) {}
+
+    constexpr void put(char c) {
+        if (used_ == capacity) {
+            flush();
+        }
+        buffer_[used_++] = c;
+    }
+
+    constexpr void put(std::string_view text) {
+        if (text.size() > capacity - used_) {
+            flush();
+            if (text.size() > capacity) {
+                write(text);
+                return;
+            }
+        }
+        std::ranges::copy(text, buffer_.data() + used_);
+        used_ += text.size();
+    }
+
+    // Room for n characters, to be committed with advance(). n is at most the capacity.
+    constexpr char *reserve(std::size_t n) {
+        if (n > capacity - used_) {
+            flush();
+        }
+        return buffer_.data() + used_;
+    }
+    constexpr void advance(const char *end) noexcept { used_ = static_cast<std::size_t>(end - buffer_.data()); }
+
+    constexpr void flush() {
+        if (used_ != 0) {
+            write({buffer_.data(), used_});
+            used_ = 0;
+        }
+    }
+
+  private:
+    constexpr void write(std::string_view text) {
+        if constexpr (std::invocable<Output &, std::string_view>) {
+            output_(text);
+        } else {
+            using value_type  = typename Output::value_type;
+            const auto *first = reinterpret_cast<const value_type *>(text.data());
+            if constexpr (requires { output_.insert(output_.end(), first, first); }) {
+                output_.insert(output_.end(), first, first + text.size());
+            } else {
+                output_.append(first, first + text.size()); // e.g fmt::memory_buffer
+            }
+        }
+    }
+
+    Output                    &output_;
+    std::array<char, capacity> buffer_;
+    std::size_t                used_{0};
+};
+
+// Offset of the first character JSON needs escaped in text (", \ or a control character), or its size. Eight bytes are tested at a
+// time with the usual has-zero-byte trick, which only errs on bytes above a real match, so a hit is settled by the bytewise tail.
+inline std::size_t json_escape_offset(const char *text, std::size_t size) noexcept {
+    constexpr std::uint64_t ones  = 0x0101010101010101;
+    constexpr std::uint64_t highs = 0x8080808080808080;
+
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, text + i, sizeof(word));
+        const auto quote     = word ^ (ones * '"');
+        const auto backslash = word ^ (ones * '\\');
+        const auto hits      = ((quote - ones) & ~quote) | ((backslash - ones) & ~backslash) | ((word - ones * 0x20) & ~word);
+        if ((hits & highs) != 0) {
+            break;
+        }
+    }
+    for (; i < size; ++i) {
+        const auto c = static_cast<unsigned char>(text[i]);
+        if (c < 0x20 || c == '"' || c == '\\') {
+            return i;
+        }
+    }
+    return size;
+}
+
+template <typename Writer> void json_escaped(Writer &out, std::span<const std::byte> bytes) {
+    constexpr std::string_view hex = "0123456789abcdef";
+
+    const auto *text = reinterpret_cast<const char *>(bytes.data());
+    auto        size = bytes.size();
+    while (size != 0) {
+        const auto run = json_escape_offset(text, size);
+        out.put(std::string_view(text, run));
+        if (run == size) {
+            return;
+        }
+        switch (const auto c = static_cast<unsigned char>(text[run])) {
+        case '"': out.put("\\\""); break;
+        case '\\': out.put("\\\\"); break;
+        case '\b': out.put("\\b"); break;
+        case '\f': out.put("\\f"); break;
+        case '\n': out.put("\\n"); break;
+        case '\r': out.put("\\r"); break;
+        case '\t': out.put("\\t"); break;
+        default: {
+            const std::array<char, 6> escape{'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+            out.put(std::string_view(escape.data(), escape.size()));
+        }
+        }
+        text += run + 1;
+        size -= run + 1;
+    }
+}
+
+// The value of a major type 0 or 1 head in decimal, -2^64 included
+template <typename Writer> void json_integer(Writer &out, const item_head &head) {
+    auto *p = out.reserve(24);
+    if (head.major == major_type::NegativeInteger) {
+        *p++ = '-';
+        if (head.argument == std::numeric_limits<std::uint64_t>::max()) {
+            constexpr std::string_view two_to_64 = "18446744073709551616";
+            out.advance(std::ranges::copy(two_to_64, p).out);
+            return;
+        }
+        out.advance(std::to_chars(p, p + 23, head.argument + 1).ptr);
+    } else {
+        out.advance(std::to_chars(p, p + 24, head.argument).ptr);
+    }
+}
+
+// Base64, base64url or base16 text of a byte string that may arrive in several chunks, up to two bytes are held back between them
+template <typename Writer> class json_binary_text {
+  public:
+    constexpr json_binary_text(Writer &out, json_bytes encoding) : out_(out), encoding_(encoding) {}
+
+    constexpr void operator()(std::span<const std::byte> bytes) {
+        if (encoding_ == json_bytes::base16) {
+            constexpr std::string_view hex = "0123456789abcdef";
+            for (const auto b : bytes) {
+                auto *p = out_.reserve(2);
+                p[0]    = hex[static_cast<std::uint8_t>(b) >> 4];
+                p[1]    = hex[static_cast<std::uint8_t>(b) & 0xf];
+                out_.advance(p + 2);
+            }
+            return;
+        }
+        auto it = bytes.begin();
+        while (pending_ != 0 && pending_ < 3 && it != bytes.end()) {
+            held_[pending_++] = *it++;
+        }
+        if (pending_ == 3) {
+            group(held_.data(), 3);
+            pending_ = 0;
+        }
+        for (; bytes.end() - it >= 3; it += 3) {
+            group(&*it, 3);
+        }
+        while (it != bytes.end()) {
+            held_[pending_++] = *it++;
+        }
+    }
+
+    // Writes the held back bytes, with padding for base64
+    constexpr void finish() {
+        if (pending_ != 0) {
+            group(held_.data(), pending_);
+            pending_ = 0;
+        }
+    }
+
+  private:
+    constexpr void group(const std::byte *bytes, std::size_t n) {
+        constexpr std::string_view base64    = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        constexpr std::string_view base64url = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        const auto                 alphabet  = encoding_ == json_bytes::base64 ? base64 : base64url;
+
+        const auto bits = (static_cast<std::uint32_t>(bytes[0]) << 16) | (n > 1 ? static_cast<std::uint32_t>(bytes[1]) << 8 : 0) |
+                          (n > 2 ? static_cast<std::uint32_t>(bytes[2]) : 0);
+        const auto chars = n + 1;
+        auto      *p     = out_.reserve(4);
+        for (std::size_t i = 0; i < 4; ++i) {
+            p[i] = i < chars ? alphabet[(bits >> (18 - 6 * i)) & 0x3f] : '=';
+        }
+        out_.advance(p + (encoding_ == json_bytes::base64 ? 4 : chars));
+    }
+
+    Writer                  &out_;
+    json_bytes               encoding_;
+    std::array<std::byte, 3> held_{};
+    std::size_t              pending_{0};
+};
+
+template <ValidCborBuffer CborBuffer, typename Output> class json_transcoder {
+  public:
+    json_transcoder(const CborBuffer &buffer, Output &output, const json_options &options)
+        : cursor_(buffer), out_(output), options_(options) {}
+
+    // Every item of a CBOR sequence as a JSON text on its own line
+    status_code operator()() {
+        auto status = status_code::success;
+        for (bool first = true; status == status_code::success && !cursor_.at_end(); first = false) {
+            if (!first) {
+                out_.put('\n');
+            }
+            status = value(options_.bytes, options_.max_depth, false);
+        }
+        out_.flush();
+        return status;
+    }
+
+  private:
+    status_code value(json_bytes bytes, std::size_t depth, bool key) {
+        item_head head;
+        if (auto status = cursor_.read_head(head); status != status_code::success) {
+            return status;
+        }
+        return head.is_break() ? status_code::malformed : content(head, bytes, depth, key);
+    }
+
+    // Map keys are JSON strings, other scalars are quoted the way they would be written as values
+    status_code content(const item_head &head, json_bytes bytes, std::size_t depth, bool key) {
+        switch (head.major) {
+        case major_type::UnsignedInteger:
+        case major_type::NegativeInteger: return quoted(key, [&] { json_integer(out_, head); });
+        case major_type::ByteString: return binary(head, bytes);
+        case major_type::TextString: return text(head);
+        case major_type::Array:
+        case major_type::Map: return key ? status_code::invalid_major_type_for_text_string : container(head, bytes, depth);
+        case major_type::Tag: return tag(head, bytes, depth, key);
+        case major_type::Simple: return quoted(key, [&] { simple(head); });
+        }
+        return status_code::malformed;
+    }
+
+    template <typename F> status_code quoted(bool key, F &&write) {
+        if (key) {
+            out_.put('"');
+        }
+        write();
+        if (key) {
+            out_.put('"');
+        }
+        return status_code::success;
+    }
+
+    // Floats as their shortest round trip text, NaN and infinities have no JSON number and become null like other simple values
+    void simple(const item_head &head) {
+        const auto number = [this](auto value) {
+            if (!std::isfinite(value)) {
+                out_.put("null");
+                return;
+            }
+            auto *p = out_.reserve(32);
+            out_.advance(std::to_chars(p, p + 32, value).ptr);
+        };
+        switch (static_cast<std::uint8_t>(head.info)) {
+        case 20: out_.put("false"); break;
+        case 21: out_.put("true"); break;
+        case 25: number(static_cast<float>(float16_t{static_cast<std::uint16_t>(head.argument)})); break;
+        case 26: number(std::bit_cast<float>(static_cast<std::uint32_t>(head.argument))); break;
+        case 27: number(std::bit_cast<double>(head.argument)); break;
+        default: out_.put("null");
+        }
+    }
+
+    template <typename F> status_code chunks(const item_head &head, F &&f) {
+        if (!head.indefinite()) {
+            return cursor_.read_bytes(head.argument, f);
+        }
+        for (item_head chunk;;) {
+            if (auto status = cursor_.read_head(chunk); status != status_code::success) {
+                return status;
+            }
+            if (chunk.is_break()) {
+                return status_code::success;
+            }
+            if (chunk.major != head.major || chunk.indefinite()) {
+                return status_code::malformed;
+            }
+            if (auto status = cursor_.read_bytes(chunk.argument, f); status != status_code::success) {
+                return status;
+            }
+        }
+    }
+
+    status_code text(const item_head &head) {
+        out_.put('"');
+        auto status = chunks(head, [this](std::span<const std::byte> bytes) { json_escaped(out_, bytes); });
+        out_.put('"');
+        return status;
+    }
+
+    status_code binary(const item_head &head, json_bytes bytes) {
+        json_binary_text<json_writer<Output>> encoded(out_, bytes);
+        out_.put('"');
+        auto status = chunks(head, encoded);
+        encoded.finish();
+        out_.put('"');
+        return status;
+    }
+
+    status_code container(const item_head &head, json_bytes bytes, std::size_t depth) {
+        if (depth == 0) {
+            return status_code::nesting_too_deep;
+        }
+        const bool map = head.major == major_type::Map;
+        out_.put(map ? '{' : '[');
+        for (std::uint64_t i = 0; head.indefinite() || i < head.argument; ++i) {
+            item_head item;
+            if (auto status = cursor_.read_head(item); status != status_code::success) {
+                return status;
+            }
+            if (item.is_break()) {
+                if (!head.indefinite()) {
+                    return status_code::malformed;
+                }
+                break;
+            }
+            if (i != 0) {
+                out_.put(',');
+            }
+            if (auto status = content(item, bytes, depth - 1, map); status != status_code::success) {
+                return status;
+            }
+            if (map) {
+                out_.put(':');
+                if (auto status = value(bytes, depth - 1, false); status != status_code::success) {
+                    return status;
+                }
+            }
+        }
+        out_.put(map ? '}' : ']');
+        return status_code::success;
+    }
+
+    status_code tag(const item_head &head, json_bytes bytes, std::size_t depth, bool key) {
+        if (depth == 0) {
+            return status_code::nesting_too_deep;
+        }
+        switch (head.argument) {
+        case 21: bytes = json_bytes::base64url; break;
+        case 22: bytes = json_bytes::base64; break;
+        case 23: bytes = json_bytes::base16; break;
+        default: break;
+        }
+
+        if (options_.tags == json_tags::object) {
+            if (key) {
+                return status_code::invalid_major_type_for_text_string;
+            }
+            out_.put(R"({"tag":)");
+            json_integer(out_, head);
+            out_.put(R"(,"value":)");
+            auto status = value(bytes, depth - 1, false);
+            out_.put('}');
+            return status;
+        }
+
+        // Negative bignums are their byte string behind a ~ (RFC 8949 6.1)
+        if (head.argument == 2 || head.argument == 3) {
+            item_head item;
+            if (auto status = cursor_.read_head(item); status != status_code::success) {
+                return status;
+            }
+            if (item.major != major_type::ByteString) {
+                return content(item, bytes, depth - 1, key);
+            }
+            if (head.argument == 3) {
+                json_binary_text<json_writer<Output>> encoded(out_, bytes);
+                out_.put("\"~");
+                auto status = chunks(item, encoded);
+                encoded.finish();
+                out_.put('"');
+                return status;
+            }
+            return binary(item, bytes);
+        }
+        return value(bytes, depth - 1, key);
+    }
+
+    cursor<CborBuffer>  cursor_;
+    json_writer<Output> out_;
+    json_options        options_;
+};
+
+// Single pass recursive descent over JSON text that writes each value through the encoder as soon as it is parsed, see json_to_cbor
+template <typename OutputBuffer> class json_parser {
+    using encoder_type = decltype(make_encoder(std::declval<OutputBuffer &>()));
+    using byte_type    = typename encoder_type::byte_type;
+
+    // Like encoder::encode_backpatched, headers are only patched where inserting in the middle of the buffer is a memmove
+    static constexpr bool can_backpatch = IsContiguous<OutputBuffer> && !IsFixedArray<OutputBuffer>;
+
+  public:
+    json_parser(std::string_view json, OutputBuffer &output, const json_parse_options &options)
+        : encoder_(output), position_(json.data()), end_(json.data() + json.size()),
+          definite_(can_backpatch && options.containers == json_containers::definite), max_depth_(options.max_depth) {}
+
+    // Every JSON text in the input, separated by whitespace, as an item of a CBOR sequence
+    status_code operator()() noexcept {
+        auto &appender = encoder_.appender_;
+        try {
+            appender.start_staging();
+            auto status = status_code::success;
+            while (status == status_code::success && skip_whitespace()) {
+                status = value(max_depth_);
+                if (status == status_code::success && position_ != end_ && !is_whitespace(*position_)) {
+                    status = status_code::malformed;
+                }
+            }
+            appender.flush(encoder_.data_);
+            if constexpr (IsFixedArray<OutputBuffer>) {
+                if (status == status_code::success && appender.overflowed(encoder_.data_)) {
+                    return status_code::buffer_overflow;
+                }
+            }
+            return status;
+        } catch (const std::bad_alloc &) {
+            appender.discard_staged();
+            return status_code::out_of_memory;
+        } catch (...) {
+            appender.discard_staged();
+            return status_code::error;
+        }
+    }
+
+  private:
+    static constexpr bool is_whitespace(char c) noexcept { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+    static constexpr bool is_digit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+    // False at the end of the input
+    constexpr bool skip_whitespace() noexcept {
+        while (position_ != end_ && is_whitespace(*position_)) {
+            ++position_;
+        }
+        return position_ != end_;
+    }
+
+    constexpr void put(byte_type b) { encoder_.appender_(encoder_.data_, b); }
+
+    status_code value(std::size_t depth) {
+        switch (*position_) {
+        case '{': return container(depth, true);
+        case '[': return container(depth, false);
+        case '"': return string();
+        case 't': return literal("true", static_cast<byte_type>(0xF5));
+        case 'f': return literal("false", static_cast<byte_type>(0xF4));
+        case 'n': return literal("null", static_cast<byte_type>(0xF6));
+        default: return number();
+        }
+    }
+
+    status_code literal(std::string_view word, byte_type simple) {
+        const auto available = std::min(word.size(), static_cast<std::size_t>(end_ - position_));
+        if (std::string_view(position_, available) != word.substr(0, available)) {
+            return status_code::malformed;
+        }
+        if (available < word.size()) {
+            return status_code::incomplete;
+        }
+        position_ += word.size();
+        put(simple);
+        return status_code::success;
+    }
+
+    // Definite length with a one byte header reserved up front and patched at the end, or indefinite length when headers cannot be
+    // patched or that was asked for
+    status_code container(std::size_t depth, bool map) {
+        if (depth == 0) {
+            return status_code::nesting_too_deep;
+        }
+        ++position_;
+        const auto major = static_cast<byte_type>(map ? 0xA0 : 0x80);
+        const auto close = map ? '}' : ']';
+        const auto start = definite_ ? std::ranges::size(encoder_.data_) : std::size_t{0};
+        put(definite_ ? major : static_cast<byte_type>(major | static_cast<byte_type>(31)));
+
+        std::uint64_t count = 0;
+        if (!skip_whitespace()) {
+            return status_code::incomplete;
+        }
+        if (*position_ == close) {
+            ++position_;
+        } else {
+            for (;; ++count) {
+                if (map) {
+                    if (*position_ != '"') {
+                        return status_code::malformed;
+                    }
+                    if (auto status = string(); status != status_code::success) {
+                        return status;
+                    }
+                    if (!skip_whitespace()) {
+                        return status_code::incomplete;
+                    }
+                    if (*position_++ != ':') {
+                        return status_code::malformed;
+                    }
+                    if (!skip_whitespace()) {
+                        return status_code::incomplete;
+                    }
+                }
+                if (auto status = value(depth - 1); status != status_code::success) {
+                    return status;
+                }
+                if (!skip_whitespace()) {
+                    return status_code::incomplete;
+                }
+                const auto next = *position_++;
+                if (next == close) {
+                    ++count;
+                    break;
+                }
+                if (next != ',' || !skip_whitespace()) {
+                    return next != ',' ? status_code::malformed : status_code::incomplete;
+                }
+            }
+        }
+
+        if (!definite_) {
+            put(static_cast<byte_type>(0xFF));
+        } else if constexpr (can_backpatch) {
+            auto      &data    = encoder_.data_;
+            const auto header  = encoder_type::size_header(count, major);
+            const auto content = std::ranges::size(data) - start - 1;
+            if (header.size() > 1) {
+                data.resize(std::ranges::size(data) + header.size() - 1);
+                auto *base = std::ranges::data(data) + start;
+                std::memmove(base + header.size(), base + 1, content);
+            }
+            std::ranges::copy(header, std::ranges::data(data) + start);
+        }
+        return status_code::success;
+    }
+
+    // The UTF-8 of the escape sequence at p, which is moved past it
+    status_code unescape(const char *&p, std::array<char, 4> &utf8, std::size_t &size) const noexcept {
+        if (end_ - p < 2) {
+            return status_code::incomplete;
+        }
+        size = 1;
+        switch (p[1]) {
+        case '"': utf8[0] = '"'; break;
+        case '\\': utf8[0] = '\\'; break;
+        case '/': utf8[0] = '/'; break;
+        case 'b': utf8[0] = '\b'; break;
+        case 'f': utf8[0] = '\f'; break;
+        case 'n': utf8[0] = '\n'; break;
+        case 'r': utf8[0] = '\r'; break;
+        case 't': utf8[0] = '\t'; break;
+        case 'u': {
+            const auto hex4 = [this](const char *q, std::uint32_t &code) {
+                if (end_ - q < 4) {
+                    return status_code::incomplete;
+                }
+                const auto [ptr, ec] = std::from_chars(q, q + 4, code, 16);
+                return ec == std::errc{} && ptr == q + 4 ? status_code::success : status_code::malformed;
+            };
+            std::uint32_t code = 0;
+            if (auto status = hex4(p + 2, code); status != status_code::success) {
+                return status;
+            }
+            p += 6;
+            if (code >= 0xDC00 && code <= 0xDFFF) {
+                return status_code::malformed;
+            }
+            // A high surrogate must be followed by an escaped low surrogate
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                if (end_ - p < 2) {
+                    return p != end_ && *p != '\\' ? status_code::malformed : status_code::incomplete;
+                }
+                std::uint32_t low = 0;
+                if (p[0] != '\\' || p[1] != 'u') {
+                    return status_code::malformed;
+                }
+                if (auto status = hex4(p + 2, low); status != status_code::success) {
+                    return status;
+                }
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    return status_code::malformed;
+                }
+                p += 6;
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            if (code < 0x80) {
+                utf8[0] = static_cast<char>(code);
+            } else if (code < 0x800) {
+                utf8 = {static_cast<char>(0xC0 | (code >> 6)), static_cast<char>(0x80 | (code & 0x3F))};
+                size = 2;
+            } else if (code < 0x10000) {
+                utf8 = {static_cast<char>(0xE0 | (code >> 12)), static_cast<char>(0x80 | ((code >> 6) & 0x3F)),
+                        static_cast<char>(0x80 | (code & 0x3F))};
+                size = 3;
+            } else {
+                utf8 = {static_cast<char>(0xF0 | (code >> 18)), static_cast<char>(0x80 | ((code >> 12) & 0x3F)),
+                        static_cast<char>(0x80 | ((code >> 6) & 0x3F)), static_cast<char>(0x80 | (code & 0x3F))};
+                size = 4;
+            }
+            return status_code::success;
+        }
+        default: return status_code::malformed;
+        }
+        p += 2;
+        return status_code::success;
+    }
+
+    // A text string with a definite length: the first scan finds the closing quote and the unescaped length, the second writes the
+    // runs between escapes. Strings without escapes are written in one piece.
+    status_code string() {
+        const auto *first   = ++position_;
+        const auto *p       = first;
+        auto        length  = std::uint64_t{0};
+        auto        escaped = false;
+        for (std::array<char, 4> utf8;;) {
+            const auto run = json_escape_offset(p, static_cast<std::size_t>(end_ - p));
+            length += run;
+            p += run;
+            if (p == end_) {
+                return status_code::incomplete;
+            }
+            if (*p == '"') {
+                break;
+            }
+            if (*p != '\\') {
+                return status_code::malformed; // Unescaped control character
+            }
+            std::size_t size = 0;
+            if (auto status = unescape(p, utf8, size); status != status_code::success) {
+                return status;
+            }
+            length += size;
+            escaped = true;
+        }
+        const auto *last = p;
+        position_        = last + 1;
+
+        encoder_.encode_major_and_size(length, static_cast<byte_type>(0x60));
+        if (!escaped) {
+            encoder_.appender_(encoder_.data_, std::string_view(first, last));
+            return status_code::success;
+        }
+        for (p = first; p != last;) {
+            const auto run = json_escape_offset(p, static_cast<std::size_t>(last - p));
+            encoder_.appender_(encoder_.data_, std::string_view(p, run));
+            p += run;
+            if (p != last) {
+                std::array<char, 4> utf8;
+                std::size_t         size = 0;
+                unescape(p, utf8, size);
+                encoder_.appender_(encoder_.data_, std::string_view(utf8.data(), size));
+            }
+        }
+        return status_code::success;
+    }
+
+    // Integers as major type 0 or 1, past 64 bits as a bignum while they fit 128 bits. Other numbers as the shortest float that holds
+    // the parsed double exactly (preferred serialization).
+    status_code number() {
+        const auto *first    = position_;
+        const bool  negative = *position_ == '-';
+        position_ += negative;
+        const auto *digits = position_;
+        if (position_ == end_) {
+            return status_code::incomplete;
+        }
+        if (*position_ == '0') {
+            ++position_;
+        } else if (is_digit(*position_)) {
+            while (position_ != end_ && is_digit(*position_)) {
+                ++position_;
+            }
+        } else {
+            return status_code::malformed;
+        }
+        const auto *integer_end = position_;
+
+        const auto digits_after = [this](const char *&p) {
+            if (p == end_) {
+                return status_code::incomplete;
+            }
+            if (!is_digit(*p)) {
+                return status_code::malformed;
+            }
+            while (p != end_ && is_digit(*p)) {
+                ++p;
+            }
+            return status_code::success;
+        };
+        auto        integral = true;
+        const char *fraction = nullptr;
+        const char *exponent = nullptr;
+        if (position_ != end_ && *position_ == '.') {
+            integral = false;
+            fraction = ++position_;
+            if (auto status = digits_after(position_); status != status_code::success) {
+                return status;
+            }
+        }
+        if (position_ != end_ && (*position_ == 'e' || *position_ == 'E')) {
+            integral = false;
+            exponent = ++position_;
+            if (position_ != end_ && (*position_ == '+' || *position_ == '-')) {
+                ++position_;
+            }
+            if (auto status = digits_after(position_); status != status_code::success) {
+                return status;
+            }
+        }
+
+        if (integral && encode_integer(negative, digits, integer_end)) {
+            return status_code::success;
+        }
+
+        double value = 0;
+        if (std::from_chars(first, position_, value).ec == std::errc::result_out_of_range) {
+            // Past the range of double: infinity when the decimal point of the value is right of its first digit, otherwise zero
+            long long scale = 0;
+            if (exponent != nullptr && std::from_chars(exponent + (*exponent == '+'), position_, scale).ec != std::errc{}) {
+                scale = *exponent == '-' ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+            }
+            if (*digits != '0') {
+                scale += integer_end - digits;
+            } else if (fraction != nullptr) {
+                scale -= std::find_if(fraction, position_, [](char c) { return c != '0'; }) - fraction;
+            }
+            value = scale > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+            value = negative ? -value : value;
+        }
+
+        const auto single = static_cast<float>(value);
+        if (static_cast<double>(single) != value) {
+            encoder_.encode(value);
+        } else if (const auto half = float16_t(single); static_cast<float>(half) == single) {
+            encoder_.encode(half);
+        } else {
+            encoder_.encode(single);
+        }
+        return status_code::success;
+    }
+
+    // False when the magnitude does not fit, the number is then written as a float
+    bool encode_integer(bool negative, const char *first, const char *last) {
+        std::uint64_t magnitude = 0;
+        if (std::from_chars(first, last, magnitude).ec == std::errc{}) {
+            if (negative && magnitude != 0) {
+                encoder_.encode_major_and_size(magnitude - 1, static_cast<byte_type>(0x20));
+            } else {
+                encoder_.encode(magnitude);
+            }
+            return true;
+        }
+#if defined(__SIZEOF_INT128__)
+        uint128_t wide = 0;
+        for (; first != last; ++first) {
+            const auto digit = static_cast<unsigned>(*first - '0');
+            if (wide > (std::numeric_limits<uint128_t>::max() - digit) / 10) {
+                return false;
+            }
+            wide = wide * 10 + digit;
+        }
+        if (!negative) {
+            encoder_.encode(wide);
+        } else if (wide <= static_cast<uint128_t>(1) << 127) {
+            encoder_.encode(static_cast<int128_t>(uint128_t{0} - wide));
+        } else {
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    encoder_type encoder_;
+    const char  *position_;
+    const char  *end_;
+    bool         definite_;
+    std::size_t  max_depth_;
+};
+
+} // namespace detail
+
+// Writes the items in buffer as JSON text without decoding them into values (RFC 8949 6.1). Numbers are written with std::to_chars,
+// byte strings as base64url, base64 or base16 and text is escaped eight bytes at a time. Map keys that are numbers or simple values
+// are quoted, arrays and maps as keys are rejected. Items of a CBOR sequence become one JSON text per line. Text strings are copied
+// as they are and not checked for valid UTF-8.
+//
+// The output is a container of byte sized values or a callable taking std::string_view, e.g to stream to a socket. On an error it
+// holds the text written up to the bad item.
+template <ValidCborBuffer CborBuffer, typename Output>
+expected<void, status_code> cbor_to_json(const CborBuffer &buffer, Output &output, json_options options = {}) {
+    const auto status = detail::json_transcoder<CborBuffer, Output>(buffer, output, options)();
+    if (status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    return {};
+}
+
+// Parses JSON text straight into CBOR (RFC 8949 6.2) without building a document first. Integers stay integers, other numbers become
+// the shortest float that holds the parsed double, strings are unescaped into definite length text strings. Several JSON texts
+// separated by whitespace, e.g JSON lines, become a CBOR sequence. On an error the output holds the items written up to it, possibly
+// with an unfinished container.
+template <typename OutputBuffer>
+expected<void, status_code> json_to_cbor(std::string_view json, OutputBuffer &output, json_parse_options options = {}) {
+    const auto status = detail::json_parser<OutputBuffer>(json, output, options)();
+    if (status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    return {};
+}
+
+} // namespace cbor::tags
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_cursor.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/extensions/cbor_query.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cbor::tags {
+
+// Buffers that can grow or shrink in the middle, like std::vector and std::deque
+template <typename T>
+concept IsResizableBuffer = requires(T &t, typename T::iterator it, std::size_t n) {
+    t.insert(it, n, typename T::value_type{});
+    t.erase(it, it);
+};
+
+namespace detail {
+
+// Replaces size bytes at offset with bytes. The tail of the buffer moves once, and only when the length changes, so a fixed size buffer
+// can take any patch that keeps the length.
+template <ValidCborBuffer CborBuffer>
+status_code splice(CborBuffer &buffer, std::size_t offset, std::size_t size, std::span<const std::byte> bytes) {
+    using value_type = typename CborBuffer::value_type;
+    const auto at    = static_cast<std::ptrdiff_t>(offset);
+    if (bytes.size() != size) {
+        if constexpr (IsResizableBuffer<CborBuffer>) {
+            if (bytes.size() > size) {
+                buffer.insert(std::ranges::begin(buffer) + at + static_cast<std::ptrdiff_t>(size), bytes.size() - size, value_type{});
+            } else {
+                buffer.erase(std::ranges::begin(buffer) + at + static_cast<std::ptrdiff_t>(bytes.size()),
+                             std::ranges::begin(buffer) + at + static_cast<std::ptrdiff_t>(size));
+            }
+        } else {
+            return status_code::buffer_overflow;
+        }
+    }
+    std::ranges::transform(bytes, std::ranges::begin(buffer) + at, [](std::byte b) { return static_cast<value_type>(b); });
+    return status_code::success;
+}
+
+// Adds the pair key: item at the end of the map at parent, the map head is rewritten with the new count, and grows only when the count
+// no longer fits its width
+template <ValidCborBuffer CborBuffer>
+expected<item_range, status_code> insert_pair(CborBuffer &buffer, item_range parent, std::span<const std::byte> key,
+                                              std::span<const std::byte> item) {
+    cursor<CborBuffer> cur(buffer);
+    if (auto status = cur.skip_bytes(parent.offset); status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    item_head   head;
+    std::size_t head_offset{};
+    do {
+        head_offset = cur.offset();
+        if (auto status = cur.read_head(head); status != status_code::success) {
+            return unexpected<status_code>(status);
+        }
+    } while (head.major == major_type::Tag);
+    if (head.major != major_type::Map) {
+        return unexpected<status_code>(status_code::not_found); // Only a missing map key can be added
+    }
+
+    std::vector<std::byte> pair(key.begin(), key.end());
+    pair.insert(pair.end(), item.begin(), item.end());
+    const auto end = parent.offset + parent.size - (head.indefinite() ? 1 : 0); // Before the break of an indefinite map
+    if (auto status = splice(buffer, end, 0, pair); status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    if (head.indefinite()) {
+        return item_range{end + key.size(), item.size()};
+    }
+
+    std::vector<std::byte> map_head;
+    auto                   enc = make_encoder(map_head);
+    if (auto result = enc(as_map{head.argument + 1}); !result) {
+        return unexpected<status_code>(result.error());
+    }
+    const auto old_size = cur.offset() - head_offset;
+    if (auto status = splice(buffer, head_offset, old_size, map_head); status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    return item_range{end + map_head.size() - old_size + key.size(), item.size()};
+}
+
+} // namespace detail
+
+// Replaces the item the path selects with item, which must be exactly one well-formed encoded item or the patch fails with malformed,
+// and returns where it now is. Only the bytes of the old item are replaced: arrays and maps count their children rather than their
+// bytes, so no head above it changes, and a patch of the same length is written in place without moving anything. When the last key
+// of the path is missing from its map the pair is added at the end of the map, with a segment of digits added as an integer key.
+// Paths with wildcards are invalid_path.
+//
+// Buffers that cannot resize, like std::span<std::byte>, take patches that keep the length and fail with buffer_overflow otherwise.
+// Patching inside packed or stringref (tag 256) items can change what their references resolve to.
+template <ValidCborBuffer CborBuffer>
+expected<item_range, status_code> patch_encoded(CborBuffer &buffer, const cbor_path &path, std::span<const std::byte> item) {
+    const auto view = path.view();
+    if (std::ranges::any_of(view.steps, [](const detail::path_step &step) { return step.kind == detail::path_step_kind::wildcard; })) {
+        return unexpected<status_code>(status_code::invalid_path);
+    }
+    // Anything but exactly one well-formed item would corrupt the document around it
+    if (cursor<std::span<const std::byte>> check(item); check.skip() != status_code::success || check.offset() != item.size()) {
+        return unexpected<status_code>(status_code::malformed);
+    }
+
+    const auto target = detail::first_range(std::as_const(buffer), view);
+    if (target) {
+        if (auto status = detail::splice(buffer, target->offset, target->size, item); status != status_code::success) {
+            return unexpected<status_code>(status);
+        }
+        return item_range{target->offset, item.size()};
+    }
+    if (target.error() != status_code::not_found || view.steps.empty()) {
+        return unexpected<status_code>(target.error());
+    }
+
+    const auto parent = detail::first_range(std::as_const(buffer), {view.steps.first(view.steps.size() - 1), view.keys});
+    if (!parent) {
+        return unexpected<status_code>(parent.error());
+    }
+    const auto            &step = view.steps.back();
+    std::vector<std::byte> key;
+    auto                   enc = make_encoder(key);
+    if (step.integer) {
+        enc.encode_major_and_size(step.argument, step.negative ? std::byte{0x20} : std::byte{0x00});
+    } else if (auto result = enc(view.key(step)); !result) {
+        return unexpected<status_code>(result.error());
+    }
+    return detail::insert_pair(buffer, *parent, key, item);
+}
+
+// Encodes value and patches it in at the path, see patch_encoded
+template <ValidCborBuffer CborBuffer, typename T>
+expected<item_range, status_code> patch(CborBuffer &buffer, const cbor_path &path, const T &value) {
+    std::vector<std::byte> item;
+    auto                   enc = make_encoder(item);
+    if (auto result = enc(value); !result) {
+        return unexpected<status_code>(result.error());
+    }
+    return patch_encoded(buffer, path, item);
+}
+
+} // namespace cbor::tags
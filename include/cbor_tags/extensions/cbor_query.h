@@ -0,0 +1,659 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_cursor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_reflection.h"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cbor::tags {
+
+// Where an item starts in the buffer and how many bytes it takes, its head and everything nested in it included
+struct item_range {
+    std::size_t offset{};
+    std::size_t size{};
+
+    constexpr bool operator==(const item_range &) const = default;
+};
+
+namespace detail {
+
+enum class path_step_kind : std::uint8_t { key, wildcard };
+
+struct path_step {
+    path_step_kind kind{};
+    bool           integer{};        // The key is also an integer, a non-negative one is an array index too
+    bool           negative{};       // Integer keys are kept as their major type and argument, -1 is negative with argument 0
+    bool           after_wildcard{}; // A wildcard comes earlier, so the siblings of a match still need visiting
+    std::uint64_t  argument{};
+    std::uint32_t  first{}; // Key text in the keys of the path
+    std::uint32_t  length{};
+};
+
+} // namespace detail
+
+namespace detail {
+
+struct path_view {
+    std::span<const path_step> steps;
+    std::string_view           keys;
+
+    constexpr std::string_view key(const path_step &step) const noexcept { return keys.substr(step.first, step.length); }
+};
+
+// Unescapes ~0 and ~1 and notes whether the key is an integer, without leading zeros like an array index in JSON Pointer
+constexpr bool parse_key(std::string_view segment, path_step &step, std::string &keys) {
+    step.first = static_cast<std::uint32_t>(keys.size());
+    for (std::size_t i = 0; i < segment.size(); ++i) {
+        if (segment[i] != '~') {
+            keys += segment[i];
+        } else if (i + 1 < segment.size() && (segment[i + 1] == '0' || segment[i + 1] == '1')) {
+            keys += segment[++i] == '0' ? '~' : '/';
+        } else {
+            return false;
+        }
+    }
+    step.length = static_cast<std::uint32_t>(keys.size() - step.first);
+
+    const auto text     = std::string_view(keys).substr(step.first, step.length);
+    const bool negative = text.starts_with('-');
+    const auto digits   = text.substr(negative ? 1 : 0);
+    if (digits.empty() || (digits.front() == '0' && (negative || digits.size() > 1))) {
+        return true;
+    }
+    std::uint64_t value{};
+    for (const char c : digits) {
+        const auto digit = static_cast<std::uint64_t>(c - '0');
+        if (c < '0' || c > '9' || value > (std::numeric_limits<std::uint64_t>::max() - digit) / 10) {
+            return true; // Only a text key
+        }
+        value = value * 10 + digit;
+    }
+    step.integer  = true;
+    step.negative = negative;
+    step.argument = negative ? value - 1 : value;
+    return true;
+}
+
+// Shared by cbor_path at runtime and path<Text, T> at compile time
+constexpr status_code parse_path(std::string_view text, std::vector<path_step> &steps, std::string &keys) {
+    if (text.empty()) {
+        return status_code::success;
+    }
+    if (text.front() != '/') {
+        return status_code::invalid_path;
+    }
+    bool wildcard = false;
+    for (std::size_t pos = 1;;) {
+        auto end = pos;
+        while (end < text.size() && text[end] != '/') {
+            ++end;
+        }
+        const auto segment = text.substr(pos, end - pos);
+
+        path_step step{.after_wildcard = wildcard};
+        if (segment == "*") {
+            step.kind = path_step_kind::wildcard;
+            wildcard  = true;
+        } else if (!parse_key(segment, step, keys)) {
+            return status_code::invalid_path;
+        }
+        steps.push_back(step);
+
+        if (end == text.size()) {
+            return status_code::success;
+        }
+        pos = end + 1;
+    }
+}
+
+} // namespace detail
+
+// A path to items inside an encoded document, parsed once and evaluated on many buffers. The syntax is JSON Pointer (RFC 6901) with
+// a wildcard segment:
+//
+//     ""               the whole item
+//     /users/3/name    key "users" of a map, element 3 of an array, then key "name"
+//     /-1/*            key -1 of a map, e.g a COSE header, then every element of an array or every value of a map
+//     /a~1b/~0         keys "a/b" and "~"
+//
+// A segment of digits selects an array element, or a map key that is that integer or that text. Tags on the way are stepped through,
+// the items selected keep theirs.
+class cbor_path {
+  public:
+    static expected<cbor_path, status_code> parse(std::string_view text) {
+        cbor_path path;
+        if (auto status = detail::parse_path(text, path.steps_, path.keys_); status != status_code::success) {
+            return unexpected<status_code>(status);
+        }
+        return path;
+    }
+
+    std::span<const detail::path_step> steps() const noexcept { return steps_; }
+    std::string_view key(const detail::path_step &step) const noexcept { return view().key(step); }
+    detail::path_view view() const noexcept { return {steps_, keys_}; }
+
+  private:
+    std::vector<detail::path_step> steps_;
+    std::string                    keys_;
+};
+
+namespace detail {
+
+// Follows a path down the first item of a buffer. Only the arrays and maps on the path are entered, keys are compared in place and
+// everything else is jumped over with cursor::skip. Once every step before the current one selected a single child, the first match
+// ends the walk, so a plain path reads no further than the item it selects.
+template <ValidCborBuffer CborBuffer, typename F> class path_walker {
+  public:
+    path_walker(path_view path, const CborBuffer &buffer, F &f) : path_(path), cursor_(buffer), f_(f) {}
+
+    status_code operator()() { return walk(0, cursor<CborBuffer>::default_max_depth); }
+
+    std::size_t matches() const noexcept { return matches_; }
+
+  private:
+    status_code walk(std::size_t index, std::size_t depth) {
+        if (index == path_.steps.size()) {
+            return match(depth);
+        }
+
+        item_head head;
+        do {
+            if (auto status = cursor_.read_head(head); status != status_code::success) {
+                return status;
+            }
+        } while (head.major == major_type::Tag);
+        if (head.is_break()) {
+            return status_code::malformed;
+        }
+        if (head.major != major_type::Array && head.major != major_type::Map) {
+            return cursor_.skip_content(head, depth);
+        }
+        if (depth == 0) {
+            return status_code::nesting_too_deep;
+        }
+
+        const auto &step = path_.steps[index];
+        for (std::uint64_t i = 0; head.indefinite() || i < head.argument; ++i) {
+            if (head.indefinite()) {
+                auto      probe = cursor_;
+                item_head next;
+                if (auto status = probe.read_head(next); status != status_code::success) {
+                    return status;
+                }
+                if (next.is_break()) {
+                    cursor_ = probe;
+                    return status_code::success;
+                }
+            }
+
+            bool selected = step.kind == path_step_kind::wildcard;
+            if (head.major == major_type::Map) {
+                if (auto status = selected ? cursor_.skip(depth - 1) : key(step, depth - 1, selected); status != status_code::success) {
+                    return status;
+                }
+            } else {
+                selected = selected || (step.integer && !step.negative && step.argument == i);
+            }
+
+            if (!selected) {
+                if (auto status = cursor_.skip(depth - 1); status != status_code::success) {
+                    return status;
+                }
+                continue;
+            }
+            if (auto status = walk(index + 1, depth - 1); status != status_code::success || done_) {
+                return status;
+            }
+            if (step.kind != path_step_kind::wildcard && !step.after_wildcard) {
+                done_ = true; // Nothing else in the document can match
+                return status_code::success;
+            }
+        }
+        return status_code::success;
+    }
+
+    status_code match(std::size_t depth) {
+        const auto offset = cursor_.offset();
+        if (auto status = cursor_.skip(depth); status != status_code::success) {
+            return status;
+        }
+        ++matches_;
+        const item_range range{offset, cursor_.offset() - offset};
+        if constexpr (std::is_same_v<std::invoke_result_t<F &, item_range>, bool>) {
+            done_ = !f_(range);
+        } else {
+            f_(range);
+        }
+        return status_code::success;
+    }
+
+    // Reads a map key and compares it to the step, text keys chunk by chunk as the cursor hands them out
+    status_code key(const path_step &step, std::size_t depth, bool &matched) {
+        matched = false;
+        item_head head;
+        if (auto status = cursor_.read_head(head); status != status_code::success) {
+            return status;
+        }
+        switch (head.major) {
+        case major_type::UnsignedInteger:
+        case major_type::NegativeInteger:
+            matched = step.integer && step.negative == (head.major == major_type::NegativeInteger) && step.argument == head.argument;
+            return status_code::success;
+        case major_type::TextString: break;
+        default: return head.is_break() ? status_code::malformed : cursor_.skip_content(head, depth);
+        }
+
+        const auto  text  = path_.key(step);
+        std::size_t at    = 0;
+        bool        equal = true;
+        const auto  compare = [&](std::span<const std::byte> chunk) {
+            equal = equal && chunk.size() <= text.size() - at &&
+                    (chunk.empty() || std::memcmp(chunk.data(), text.data() + at, chunk.size()) == 0);
+            at += equal ? chunk.size() : 0;
+        };
+        if (!head.indefinite()) {
+            if (head.argument != text.size()) {
+                return cursor_.skip_bytes(head.argument);
+            }
+            const auto status = cursor_.read_bytes(head.argument, compare);
+            matched           = equal;
+            return status;
+        }
+        for (item_head chunk;;) {
+            if (auto status = cursor_.read_head(chunk); status != status_code::success) {
+                return status;
+            }
+            if (chunk.is_break()) {
+                matched = equal && at == text.size();
+                return status_code::success;
+            }
+            if (chunk.major != major_type::TextString || chunk.indefinite()) {
+                return status_code::malformed;
+            }
+            if (auto status = equal ? cursor_.read_bytes(chunk.argument, compare) : cursor_.skip_bytes(chunk.argument);
+                status != status_code::success) {
+                return status;
+            }
+        }
+    }
+
+    path_view           path_;
+    cursor<CborBuffer>  cursor_;
+    F                  &f_;
+    std::size_t         matches_{0};
+    bool                done_{false};
+};
+
+} // namespace detail
+
+// Calls f(item_range) for every item the path selects in the first item of buffer, in the order they are encoded, and returns how
+// many there were. f may return false to stop after a match. Only the bytes walked are checked, a malformed item past the last
+// match of a plain path goes unnoticed.
+template <ValidCborBuffer CborBuffer, typename F>
+expected<std::size_t, status_code> query_each(const CborBuffer &buffer, const cbor_path &path, F &&f) {
+    detail::path_walker<CborBuffer, std::remove_reference_t<F>> walker(path.view(), buffer, f);
+    if (const auto status = walker(); status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    return walker.matches();
+}
+
+namespace detail {
+
+template <ValidCborBuffer CborBuffer> expected<item_range, status_code> first_range(const CborBuffer &buffer, path_view path) {
+    item_range found{};
+    const auto record = [&found](item_range range) {
+        found = range;
+        return false;
+    };
+    path_walker<CborBuffer, decltype(record)> walker(path, buffer, record);
+    if (const auto status = walker(); status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    if (walker.matches() == 0) {
+        return unexpected<status_code>(status_code::not_found);
+    }
+    return found;
+}
+
+} // namespace detail
+
+// The first item the path selects, not_found if there is none
+template <ValidCborBuffer CborBuffer> expected<item_range, status_code> query_range(const CborBuffer &buffer, const cbor_path &path) {
+    return detail::first_range(buffer, path.view());
+}
+
+// The encoded bytes of the first item the path selects, pointing into buffer
+template <ValidCborBuffer CborBuffer>
+    requires IsContiguous<CborBuffer>
+expected<std::span<const std::byte>, status_code> query(const CborBuffer &buffer, const cbor_path &path) {
+    const auto range = query_range(buffer, path);
+    if (!range) {
+        return unexpected<status_code>(range.error());
+    }
+    return std::span<const std::byte>(reinterpret_cast<const std::byte *>(std::ranges::data(buffer)) + range->offset, range->size);
+}
+
+// Decodes the first item the path selects into value with the static paths of the decoder, views like std::string_view point into
+// buffer
+template <ValidCborBuffer CborBuffer, typename T>
+    requires IsContiguous<CborBuffer>
+expected<void, status_code> query_decode(const CborBuffer &buffer, const cbor_path &path, T &value) {
+    auto bytes = query(buffer, path);
+    if (!bytes) {
+        return unexpected<status_code>(bytes.error());
+    }
+    auto dec = make_decoder(*bytes);
+    return dec(value);
+}
+
+// A path spelled as a template argument, e.g path<"/users/0/name", std::string_view>
+template <std::size_t N> struct path_string {
+    char value[N]{};
+
+    consteval path_string(const char (&text)[N]) { std::copy_n(text, N, value); }
+    constexpr std::string_view view() const noexcept { return {value, N - 1}; }
+};
+
+namespace detail {
+
+// The tables of a path parsed by the compiler, a bad path does not compile
+template <path_string Text> struct compiled_path {
+    struct counts {
+        status_code status;
+        bool        wildcard;
+        std::size_t steps;
+        std::size_t keys;
+    };
+    static constexpr counts sizes = [] {
+        std::vector<path_step> steps;
+        std::string            keys;
+        const auto             status   = parse_path(Text.view(), steps, keys);
+        const bool             wildcard =
+            std::ranges::any_of(steps, [](const path_step &step) { return step.kind == path_step_kind::wildcard; });
+        return counts{status, wildcard, steps.size(), keys.size()};
+    }();
+    static_assert(sizes.status == status_code::success, "Invalid path, see cbor_path for the syntax");
+    static_assert(!sizes.wildcard, "A path field selects a single item, use query_each for wildcards");
+
+    struct tables {
+        std::array<path_step, sizes.steps> steps{};
+        std::array<char, sizes.keys>       keys{};
+    };
+    static constexpr tables table = [] {
+        std::vector<path_step> steps;
+        std::string            keys;
+        parse_path(Text.view(), steps, keys);
+        tables result;
+        std::ranges::copy(steps, result.steps.begin());
+        std::ranges::copy(keys, result.keys.begin());
+        return result;
+    }();
+    static constexpr path_view view{table.steps, std::string_view(table.keys.data(), table.keys.size())};
+};
+
+// Follows several paths down the first item of a buffer at once. Paths that share a prefix share its traversal, each map key is read
+// once and compared to every path still looking for a key at that level, and children no path wants are jumped over. The walk ends as
+// soon as no path is left unresolved.
+template <ValidCborBuffer CborBuffer, std::size_t N, typename F> class multi_path_walker {
+  public:
+    multi_path_walker(const std::array<path_view, N> &paths, const CborBuffer &buffer, F &f) : paths_(paths), cursor_(buffer), f_(f) {}
+
+    status_code operator()() {
+        std::bitset<N> all;
+        all.set();
+        return walk(all, 0, cursor<CborBuffer>::default_max_depth);
+    }
+
+  private:
+    status_code walk(std::bitset<N> active, std::size_t index, std::size_t depth) {
+        std::bitset<N> ending;
+        for (std::size_t p = 0; p < N; ++p) {
+            ending[p] = active[p] && paths_[p].steps.size() == index;
+        }
+        if (ending.any()) {
+            // The item is skipped on a copy of the cursor, longer paths may still need to go inside it
+            auto       end    = cursor_;
+            const auto offset = cursor_.offset();
+            if (auto status = end.skip(depth); status != status_code::success) {
+                return status;
+            }
+            for (std::size_t p = 0; p < N; ++p) {
+                if (!ending[p]) {
+                    continue;
+                }
+                if (auto status = f_(p, item_range{offset, end.offset() - offset}); status != status_code::success) {
+                    return status;
+                }
+            }
+            active &= ~ending;
+            resolve(ending);
+            if (active.none()) {
+                cursor_ = end;
+                return status_code::success;
+            }
+        }
+
+        item_head head;
+        do {
+            if (auto status = cursor_.read_head(head); status != status_code::success) {
+                return status;
+            }
+        } while (head.major == major_type::Tag);
+        if (head.is_break()) {
+            return status_code::malformed;
+        }
+        if (head.major != major_type::Array && head.major != major_type::Map) {
+            resolve(active);
+            return done_ ? status_code::success : cursor_.skip_content(head, depth);
+        }
+        if (depth == 0) {
+            return status_code::nesting_too_deep;
+        }
+
+        if (head.major == major_type::Array) {
+            std::bitset<N> keyed;
+            for (std::size_t p = 0; p < N; ++p) {
+                keyed[p] = active[p] && (!paths_[p].steps[index].integer || paths_[p].steps[index].negative);
+            }
+            active &= ~keyed;
+            resolve(keyed);
+        }
+
+        for (std::uint64_t i = 0; !done_ && (head.indefinite() || i < head.argument); ++i) {
+            if (head.indefinite()) {
+                auto      probe = cursor_;
+                item_head next;
+                if (auto status = probe.read_head(next); status != status_code::success) {
+                    return status;
+                }
+                if (next.is_break()) {
+                    cursor_ = probe;
+                    break;
+                }
+            }
+
+            std::bitset<N> selected;
+            if (head.major == major_type::Map) {
+                if (auto status = active.none() ? cursor_.skip(depth - 1) : key(active, index, depth - 1, selected);
+                    status != status_code::success) {
+                    return status;
+                }
+            } else {
+                for (std::size_t p = 0; p < N; ++p) {
+                    selected[p] = active[p] && paths_[p].steps[index].argument == i;
+                }
+            }
+
+            if (selected.none()) {
+                if (auto status = cursor_.skip(depth - 1); status != status_code::success) {
+                    return status;
+                }
+                continue;
+            }
+            if (auto status = walk(selected, index + 1, depth - 1); status != status_code::success) {
+                return status;
+            }
+            active &= ~selected; // The first match of a key wins, like in query_range
+        }
+        resolve(active);
+        return status_code::success;
+    }
+
+    void resolve(const std::bitset<N> &paths) {
+        pending_ -= paths.count();
+        done_ = pending_ == 0;
+    }
+
+    // Reads a map key and compares it to the step of every active path at once
+    status_code key(const std::bitset<N> &active, std::size_t index, std::size_t depth, std::bitset<N> &matched) {
+        item_head head;
+        if (auto status = cursor_.read_head(head); status != status_code::success) {
+            return status;
+        }
+        switch (head.major) {
+        case major_type::UnsignedInteger:
+        case major_type::NegativeInteger:
+            for (std::size_t p = 0; p < N; ++p) {
+                const auto &step = paths_[p].steps[index];
+                matched[p] = active[p] && step.integer && step.negative == (head.major == major_type::NegativeInteger) &&
+                             step.argument == head.argument;
+            }
+            return status_code::success;
+        case major_type::TextString: break;
+        default: return head.is_break() ? status_code::malformed : cursor_.skip_content(head, depth);
+        }
+
+        std::array<std::size_t, N> at{};
+        std::bitset<N>             equal = active;
+        const auto                 compare = [&](std::span<const std::byte> chunk) {
+            for (std::size_t p = 0; p < N; ++p) {
+                const auto text = paths_[p].key(paths_[p].steps[index]);
+                equal[p]        = equal[p] && chunk.size() <= text.size() - at[p] &&
+                           (chunk.empty() || std::memcmp(chunk.data(), text.data() + at[p], chunk.size()) == 0);
+                at[p] += equal[p] ? chunk.size() : 0;
+            }
+        };
+        if (!head.indefinite()) {
+            for (std::size_t p = 0; p < N; ++p) {
+                equal[p] = equal[p] && paths_[p].steps[index].length == head.argument;
+            }
+            if (equal.none()) {
+                return cursor_.skip_bytes(head.argument);
+            }
+            const auto status = cursor_.read_bytes(head.argument, compare);
+            matched           = equal;
+            return status;
+        }
+        for (item_head chunk;;) {
+            if (auto status = cursor_.read_head(chunk); status != status_code::success) {
+                return status;
+            }
+            if (chunk.is_break()) {
+                for (std::size_t p = 0; p < N; ++p) {
+                    matched[p] = equal[p] && at[p] == paths_[p].steps[index].length;
+                }
+                return status_code::success;
+            }
+            if (chunk.major != major_type::TextString || chunk.indefinite()) {
+                return status_code::malformed;
+            }
+            if (auto status = equal.any() ? cursor_.read_bytes(chunk.argument, compare) : cursor_.skip_bytes(chunk.argument);
+                status != status_code::success) {
+                return status;
+            }
+        }
+    }
+
+    const std::array<path_view, N> &paths_;
+    cursor<CborBuffer>              cursor_;
+    F                              &f_;
+    std::size_t                     pending_{N};
+    bool                            done_{N == 0};
+};
+
+} // namespace detail
+
+// One field of a struct handed to extract, the item at Text decoded into value
+template <path_string Text, typename T> struct path {
+    using value_type = T;
+    using compiled   = detail::compiled_path<Text>;
+
+    T    value{};
+    bool found{false};
+};
+
+template <typename T> struct is_path_field : std::false_type {};
+template <path_string Text, typename T> struct is_path_field<path<Text, T>> : std::true_type {};
+
+// Fills every path<Text, T> member of fields from the first item of buffer in a single walk, and returns how many were found. The
+// walk stops once each path has been found or ruled out, fields that are not in the document keep found == false. Fields of type
+// item_range only record where their item is, so a struct made of them works on non-contiguous buffers too.
+template <ValidCborBuffer CborBuffer, IsAggregate Fields>
+expected<std::size_t, status_code> extract(const CborBuffer &buffer, Fields &fields) {
+    auto members = to_tuple(fields);
+    using tuple  = decltype(members);
+    using index  = std::make_index_sequence<std::tuple_size_v<tuple>>;
+    constexpr auto N = std::tuple_size_v<tuple>;
+
+    static constexpr auto paths = []<std::size_t... I>(std::index_sequence<I...>) {
+        static_assert((is_path_field<std::remove_cvref_t<std::tuple_element_t<I, tuple>>>::value && ...),
+                      "Every member of the fields must be a path<Text, T>");
+        return std::array<detail::path_view, N>{std::remove_cvref_t<std::tuple_element_t<I, tuple>>::compiled::view...};
+    }(index{});
+    constexpr bool ranges_only = []<std::size_t... I>(std::index_sequence<I...>) {
+        return (std::is_same_v<typename std::remove_cvref_t<std::tuple_element_t<I, tuple>>::value_type, item_range> && ...);
+    }(index{});
+    static_assert(ranges_only || IsContiguous<CborBuffer>, "Decoding fields needs a contiguous buffer, use item_range fields");
+
+    std::apply([](auto &...field) { ((field.found = false), ...); }, members);
+
+    std::size_t found = 0;
+    auto        store = [&](auto &field, item_range range) -> status_code {
+        using value_type = typename std::remove_cvref_t<decltype(field)>::value_type;
+        if constexpr (std::is_same_v<value_type, item_range>) {
+            field.value = range;
+        } else {
+            auto bytes =
+                std::span<const std::byte>(reinterpret_cast<const std::byte *>(std::ranges::data(buffer)) + range.offset, range.size);
+            auto dec = make_decoder(bytes);
+            if (auto result = dec(field.value); !result) {
+                return result.error();
+            }
+        }
+        field.found = true;
+        ++found;
+        return status_code::success;
+    };
+    auto sink = [&](std::size_t p, item_range range) {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            auto status = status_code::success;
+            ((p == I ? (status = store(std::get<I>(members), range), 0) : 0), ...);
+            return status;
+        }(index{});
+    };
+
+    detail::multi_path_walker<CborBuffer, N, decltype(sink)> walker(paths, buffer, sink);
+    if (const auto status = walker(); status != status_code::success) {
+        return unexpected<status_code>(status);
+    }
+    return found;
+}
+
+} // namespace cbor::tags
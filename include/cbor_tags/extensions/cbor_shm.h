@@ -0,0 +1,331 @@
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <new>
+#include <span>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+namespace cbor::tags {
+
+// A bounded multi-producer/multi-consumer ring of fixed size slots in POSIX shared memory, for passing CBOR messages between processes
+// on one machine. Producers encode straight into a claimed slot and consumers decode straight out of it, so string_view and span
+// members of the decoded type point into shared memory for as long as the received message is held. The slot protocol is the classic
+// per-slot sequence number ring, which only needs lock-free 64 bit atomics to work across process boundaries.
+//
+// Creating or mapping the memory throws std::system_error, sending and receiving report status_code like the encoder and decoder. The
+// geometry of the ring is read from the header once, when it is checked, so a peer cannot change it under a mapped ring.
+class shm_ring {
+    struct ring_header {
+        std::uint64_t                           magic;
+        std::uint64_t                           slot_size;
+        std::uint64_t                           slot_count;
+        std::uint64_t                           stride;
+        alignas(64) std::atomic<std::uint64_t> head; // Next position to claim for sending
+        alignas(64) std::atomic<std::uint64_t> tail; // Next position to claim for receiving
+    };
+
+    struct slot_header {
+        std::atomic<std::uint64_t> sequence;
+        std::uint64_t              size; // Zero marks a slot whose message did not fit, receivers skip it
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shm_ring needs lock-free 64 bit atomics to work across processes");
+
+    static constexpr std::uint64_t magic_value   = 0x63626f725f726e67; // "cbor_rng"
+    static constexpr std::size_t   slot_align    = 64;
+    static constexpr std::size_t   payload_align = 16;
+    static constexpr std::size_t   payload_start = (sizeof(slot_header) + payload_align - 1) / payload_align * payload_align;
+    static constexpr std::size_t   slots_start   = (sizeof(ring_header) + slot_align - 1) / slot_align * slot_align;
+
+  public:
+    // A received message, the slot stays owned by the receiver until this is destroyed
+    class message {
+      public:
+        message() = default;
+        message(message &&other) noexcept
+            : ring_(std::exchange(other.ring_, nullptr)), position_(other.position_), bytes_(other.bytes_) {}
+        message &operator=(message &&other) noexcept {
+            if (this != &other) {
+                release();
+                ring_     = std::exchange(other.ring_, nullptr);
+                position_ = other.position_;
+                bytes_    = other.bytes_;
+            }
+            return *this;
+        }
+        message(const message &)            = delete;
+        message &operator=(const message &) = delete;
+        ~message() { release(); }
+
+        std::span<const std::byte> bytes() const noexcept { return bytes_; }
+
+        // Views in the decoded values stay valid until the message is released
+        template <typename... T> auto decode(T &...values) const {
+            auto view = bytes_;
+            auto dec  = make_decoder(view);
+            return dec(values...);
+        }
+
+        void release() noexcept {
+            if (ring_ != nullptr) {
+                ring_->slot_at(position_)->sequence.store(position_ + ring_->slot_count_, std::memory_order_release);
+                ring_ = nullptr;
+            }
+        }
+
+      private:
+        friend class shm_ring;
+        message(const shm_ring *ring, std::uint64_t position, std::span<const std::byte> bytes) noexcept
+            : ring_(ring), position_(position), bytes_(bytes) {}
+
+        const shm_ring            *ring_{nullptr};
+        std::uint64_t              position_{0};
+        std::span<const std::byte> bytes_;
+    };
+
+    // Anonymous ring, share it with fd() across fork() or over a unix socket and map it there with attach()
+    static shm_ring create(std::size_t slot_size, std::size_t slot_count) {
+#if defined(__linux__)
+        const int fd = ::memfd_create("cbor_tags_shm_ring", MFD_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "memfd_create");
+        }
+#else
+        const auto name = "/cbor_tags_shm_ring_" + std::to_string(::getpid());
+        const int  fd   = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+        ::shm_unlink(name.c_str());
+#endif
+        return initialize(fd, slot_size, slot_count);
+    }
+
+    // Named ring, e.g "/my_channel", other processes map it with open(). The name is removed again with unlink().
+    static shm_ring create(const char *name, std::size_t slot_size, std::size_t slot_count) {
+        const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+        return initialize(fd, slot_size, slot_count);
+    }
+
+    static shm_ring open(const char *name) {
+        const int fd = ::shm_open(name, O_RDWR, 0);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+        return map_existing(fd);
+    }
+
+    // Maps a ring from a file descriptor created elsewhere, the descriptor is duplicated and the caller keeps its own
+    static shm_ring attach(int fd) {
+        const int own = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (own < 0) {
+            throw std::system_error(errno, std::generic_category(), "fcntl");
+        }
+        return map_existing(own);
+    }
+
+    static void unlink(const char *name) noexcept { ::shm_unlink(name); }
+
+    shm_ring(shm_ring &&other) noexcept
+        : fd_(std::exchange(other.fd_, -1)), base_(std::exchange(other.base_, nullptr)),
+          mapped_size_(std::exchange(other.mapped_size_, 0)), slot_size_(std::exchange(other.slot_size_, 0)),
+          slot_count_(std::exchange(other.slot_count_, 0)), stride_(std::exchange(other.stride_, 0)) {}
+    shm_ring &operator=(shm_ring &&other) noexcept {
+        if (this != &other) {
+            close();
+            fd_          = std::exchange(other.fd_, -1);
+            base_        = std::exchange(other.base_, nullptr);
+            mapped_size_ = std::exchange(other.mapped_size_, 0);
+            slot_size_   = std::exchange(other.slot_size_, 0);
+            slot_count_  = std::exchange(other.slot_count_, 0);
+            stride_      = std::exchange(other.stride_, 0);
+        }
+        return *this;
+    }
+    shm_ring(const shm_ring &)            = delete;
+    shm_ring &operator=(const shm_ring &) = delete;
+    ~shm_ring() { close(); }
+
+    int         fd() const noexcept { return fd_; }
+    std::size_t slot_size() const noexcept { return slot_size_; }
+    std::size_t slot_count() const noexcept { return slot_count_; }
+
+    // Encodes the values directly into the next free slot. Fails with would_block when the ring is full, and with buffer_overflow when
+    // the message is larger than a slot, in which case the slot is published empty and skipped by receivers.
+    template <typename... T> expected<void, status_code> try_send(const T &...values) {
+        auto *ring = header();
+        auto  pos  = ring->head.load(std::memory_order_relaxed);
+        for (;;) {
+            auto      *slot = slot_at(pos);
+            const auto seq  = slot->sequence.load(std::memory_order_acquire);
+            const auto dif  = static_cast<std::int64_t>(seq - pos);
+            if (dif == 0) {
+                if (ring->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return unexpected<status_code>(status_code::would_block);
+            } else {
+                pos = ring->head.load(std::memory_order_relaxed);
+            }
+        }
+
+        auto *slot    = slot_at(pos);
+        auto  payload = std::span<std::byte>(payload_of(slot), slot_size_);
+        auto  enc     = make_encoder(payload);
+        auto  result  = enc(values...);
+        slot->size    = result ? enc.bytes_written() : 0;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return result;
+    }
+
+    // Claims the oldest published message, or fails with would_block when there is none. A slot that claims to hold more than a slot
+    // does is released again and reported as malformed.
+    expected<message, status_code> try_receive() {
+        auto *ring = header();
+        auto  pos  = ring->tail.load(std::memory_order_relaxed);
+        for (;;) {
+            auto      *slot = slot_at(pos);
+            const auto seq  = slot->sequence.load(std::memory_order_acquire);
+            const auto dif  = static_cast<std::int64_t>(seq - (pos + 1));
+            if (dif == 0) {
+                if (ring->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    const auto size = slot->size;
+                    message    msg(this, pos, std::span<const std::byte>(payload_of(slot), size <= slot_size_ ? size : 0));
+                    if (size > slot_size_) {
+                        return unexpected<status_code>(status_code::malformed);
+                    }
+                    if (size != 0) {
+                        return msg;
+                    }
+                    msg.release();
+                    pos = ring->tail.load(std::memory_order_relaxed);
+                }
+            } else if (dif < 0) {
+                return unexpected<status_code>(status_code::would_block);
+            } else {
+                pos = ring->tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+  private:
+    shm_ring(int fd, void *base, std::size_t mapped_size) noexcept
+        : fd_(fd), base_(static_cast<std::byte *>(base)), mapped_size_(mapped_size) {}
+
+    static std::size_t stride_for(std::size_t slot_size) noexcept {
+        return (payload_start + slot_size + slot_align - 1) / slot_align * slot_align;
+    }
+
+    static void *map(int fd, std::size_t size) {
+        void *base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+        return base;
+    }
+
+    static shm_ring initialize(int fd, std::size_t slot_size, std::size_t slot_count) {
+        if (slot_size == 0 || slot_count == 0) {
+            ::close(fd);
+            throw std::system_error(std::make_error_code(std::errc::invalid_argument), "shm_ring needs at least one non-empty slot");
+        }
+        const auto stride = stride_for(slot_size);
+        const auto size   = slots_start + stride * slot_count;
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "ftruncate");
+        }
+
+        shm_ring ring(fd, map(fd, size), size);
+        ring.slot_size_  = slot_size;
+        ring.slot_count_ = slot_count;
+        ring.stride_     = stride;
+
+        auto *header       = new (ring.base_) ring_header{};
+        header->slot_size  = slot_size;
+        header->slot_count = slot_count;
+        header->stride     = stride;
+        for (std::size_t i = 0; i < slot_count; ++i) {
+            auto *slot = new (ring.base_ + slots_start + i * stride) slot_header{};
+            slot->sequence.store(i, std::memory_order_relaxed);
+        }
+        header->head.store(0, std::memory_order_relaxed);
+        header->tail.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = magic_value;
+        return ring;
+    }
+
+    static shm_ring map_existing(int fd) {
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "fstat");
+        }
+        const auto size = static_cast<std::size_t>(st.st_size);
+        if (size < slots_start) {
+            ::close(fd);
+            throw std::system_error(std::make_error_code(std::errc::invalid_argument), "shm_ring: not a ring");
+        }
+
+        shm_ring ring(fd, map(fd, size), size);
+        const auto *header = ring.header();
+        // The header comes from another process, check it without arithmetic that could wrap
+        if (header->magic != magic_value || header->slot_size == 0 || header->slot_size > size ||
+            header->stride != stride_for(header->slot_size) || header->slot_count == 0 ||
+            header->slot_count > (size - slots_start) / header->stride) {
+            throw std::system_error(std::make_error_code(std::errc::invalid_argument), "shm_ring: not a ring");
+        }
+        ring.slot_size_  = header->slot_size;
+        ring.slot_count_ = header->slot_count;
+        ring.stride_     = header->stride;
+        return ring;
+    }
+
+    void close() noexcept {
+        if (base_ != nullptr) {
+            ::munmap(base_, mapped_size_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    ring_header *header() const noexcept { return reinterpret_cast<ring_header *>(base_); }
+    slot_header *slot_at(std::uint64_t position) const noexcept {
+        return reinterpret_cast<slot_header *>(base_ + slots_start + (position % slot_count_) * stride_);
+    }
+    static std::byte *payload_of(slot_header *slot) noexcept { return reinterpret_cast<std::byte *>(slot) + payload_start; }
+
+    int         fd_{-1};
+    std::byte  *base_{nullptr};
+    std::size_t mapped_size_{0};
+    std::size_t slot_size_{0};
+    std::size_t slot_count_{0};
+    std::size_t stride_{0};
+};
+
+} // namespace cbor::tags
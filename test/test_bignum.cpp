@@ -0,0 +1,146 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+// Minimal arbitrary precision integer, sign and big-endian magnitude
+class BigInt {
+  public:
+    BigInt() = default;
+    BigInt(bool negative, std::vector<std::byte> magnitude) : negative_(negative), magnitude_(std::move(magnitude)) {}
+
+    bool                       is_negative() const { return negative_; }
+    std::span<const std::byte> magnitude() const { return magnitude_; }
+    void                       assign(bool negative, std::span<const std::byte> magnitude) {
+        negative_ = negative;
+        magnitude_.assign(magnitude.begin(), magnitude.end());
+    }
+
+    bool operator==(const BigInt &) const = default;
+
+  private:
+    bool                   negative_{false};
+    std::vector<std::byte> magnitude_;
+};
+
+struct Transfer {
+    std::string from;
+    std::string to;
+    int128_t    amount;
+    uint128_t   fee;
+};
+
+constexpr uint128_t two_to_64 = static_cast<uint128_t>(1) << 64;
+} // namespace
+
+TEST_CASE("bignum 128-bit integers") {
+    // RFC 8949 Appendix A
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(static_cast<uint128_t>(two_to_64 - 1), two_to_64, static_cast<int128_t>(-two_to_64),
+                               static_cast<int128_t>(-two_to_64) - 1));
+    CHECK_EQ(to_hex(data), "1bffffffffffffffff"
+                           "c249010000000000000000"
+                           "3bffffffffffffffff"
+                           "c349010000000000000000");
+
+    uint128_t a, b;
+    int128_t  c, d;
+    REQUIRE(make_decoder(data)(a, b, c, d));
+    CHECK(a == two_to_64 - 1);
+    CHECK(b == two_to_64);
+    CHECK(c == -static_cast<int128_t>(two_to_64));
+    CHECK(d == -static_cast<int128_t>(two_to_64) - 1);
+
+    // Full range, and small values stay basic integers
+    std::vector<std::byte> limits;
+    REQUIRE(make_encoder(limits)(std::numeric_limits<int128_t>::max(), std::numeric_limits<int128_t>::min(),
+                                 std::numeric_limits<uint128_t>::max(), static_cast<int128_t>(-5)));
+    int128_t  max, min, small;
+    uint128_t umax;
+    REQUIRE(make_decoder(limits)(max, min, umax, small));
+    CHECK(max == std::numeric_limits<int128_t>::max());
+    CHECK(min == std::numeric_limits<int128_t>::min());
+    CHECK(umax == std::numeric_limits<uint128_t>::max());
+    CHECK(small == -5);
+    CHECK_EQ(to_hex(limits).substr(to_hex(limits).size() - 2), "24");
+}
+
+TEST_CASE_TEMPLATE("bignum 128-bit members", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const Transfer transfer{"alice", "bob", -(static_cast<int128_t>(1) << 100), two_to_64 * 3};
+
+    T data;
+    REQUIRE(make_encoder(data)(transfer));
+    Transfer decoded;
+    REQUIRE(make_decoder(data)(decoded));
+    CHECK_EQ(decoded.from, transfer.from);
+    CHECK_EQ(decoded.to, transfer.to);
+    CHECK(decoded.amount == transfer.amount);
+    CHECK(decoded.fee == transfer.fee);
+}
+
+TEST_CASE("bignum 128-bit decoding limits") {
+    int128_t  value;
+    uint128_t unsigned_value;
+
+    // Leading zeros are allowed
+    auto padded = to_bytes("c2510000000000000000000000000000000001");
+    REQUIRE(make_decoder(padded)(value));
+    CHECK(value == 1);
+
+    auto too_big = to_bytes("c2510100000000000000000000000000000000");
+    CHECK_EQ(make_decoder(too_big)(value).error(), status_code::integer_overflow);
+
+    auto past_signed = to_bytes("c25080000000000000000000000000000000");
+    CHECK_EQ(make_decoder(past_signed)(value).error(), status_code::integer_overflow);
+    REQUIRE(make_decoder(past_signed)(unsigned_value));
+    CHECK(unsigned_value == static_cast<uint128_t>(1) << 127);
+
+    auto negative = to_bytes("c349010000000000000000");
+    CHECK_EQ(make_decoder(negative)(unsigned_value).error(), status_code::invalid_tag_value);
+
+    auto other_tag = to_bytes("c44100");
+    CHECK_EQ(make_decoder(other_tag)(value).error(), status_code::invalid_tag_value);
+}
+
+TEST_CASE_TEMPLATE("bignum arbitrary precision", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const auto magnitude = [](std::string_view hex) {
+        const auto bytes = to_bytes(hex);
+        return std::vector<std::byte>(bytes.begin(), bytes.end());
+    };
+
+    const BigInt huge(false, magnitude("0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f2021222324"));
+    const BigInt negative_huge(true, magnitude("0100000000000000000000000000000000000000000000000000000000000000000000"));
+    const BigInt small(true, magnitude("0000002a"));
+    const BigInt edge(true, magnitude("010000000000000000"));
+
+    T data;
+    REQUIRE(make_encoder(data)(huge, negative_huge, small, edge));
+    // -2^64 is a basic integer, -1 - n = 2^64 - 1
+    CHECK_EQ(to_hex(data).substr(to_hex(data).size() - 22), "38293bffffffffffffffff");
+
+    BigInt a, b, c, d;
+    REQUIRE(make_decoder(data)(a, b, c, d));
+    CHECK(a == huge);
+    CHECK(b == negative_huge);
+    CHECK(c == BigInt(true, magnitude("2a")));
+    CHECK(d == edge);
+
+    // 128-bit encodings are the same as those of the bignum
+    std::vector<std::byte> from_bignum;
+    std::vector<std::byte> from_int128;
+    REQUIRE(make_encoder(from_bignum)(BigInt(true, magnitude("0100000000000000000000000000"))));
+    REQUIRE(make_encoder(from_int128)(-(static_cast<int128_t>(1) << 104)));
+    CHECK_EQ(from_bignum, from_int128);
+}
@@ -5,11 +5,15 @@
 #include "test_util.h"
 
 #include <cbor_tags/cbor_decoder.h>
+#include <array>
 #include <cbor_tags/cbor_encoder.h>
 #include <cstdint>
+#include <deque>
 #include <doctest/doctest.h>
 #include <fmt/core.h>
 #include <fmt/ranges.h>
+#include <magic_enum/magic_enum.hpp>
+#include <string_view>
 
 using namespace cbor::tags;
 
@@ -265,4 +269,78 @@ TEST_CASE("CBOR - struct with enum + variant") {
         CHECK_EQ(v.index(), v2.index());
         CHECK_EQ(std::get<std::string>(v), std::get<std::string>(v2));
     }
-}
\ No newline at end of file
+}
+enum class Color : std::uint8_t { red, green, blue, unnamed };
+enum class Level : int { debug = -1, info = 0, warning = 10, error = 20 };
+
+template <> struct cbor::tags::enum_names<Color> {
+    static constexpr std::array<std::pair<Color, std::string_view>, 3> values{
+        {{Color::red, "red"}, {Color::green, "green"}, {Color::blue, "blue"}}};
+};
+
+template <> struct cbor::tags::enum_names<Level> {
+    static constexpr auto values = magic_enum::enum_entries<Level>();
+};
+
+struct LogLine {
+    Level       level;
+    Color       color;
+    std::string text;
+};
+
+TEST_CASE("CBOR - enum names") {
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(Color::green, Level::warning, Color::unnamed, Level::debug));
+    CHECK_EQ(to_hex(data), "65677265656e"
+                           "677761726e696e67"
+                           "03"
+                           "656465627567");
+
+    Color green, unnamed;
+    Level warning, debug;
+    REQUIRE(make_decoder(data)(green, warning, unnamed, debug));
+    CHECK_EQ(green, Color::green);
+    CHECK_EQ(warning, Level::warning);
+    CHECK_EQ(unnamed, Color::unnamed);
+    CHECK_EQ(debug, Level::debug);
+
+    // Every name is found, and only the names
+    for (const auto &[value, name] : enum_names<Level>::values) {
+        CHECK_EQ(detail::enum_name_table<Level>::find(name), value);
+    }
+    CHECK_FALSE(detail::enum_name_table<Level>::find("warn").has_value());
+    CHECK_FALSE(detail::enum_name_table<Level>::find("").has_value());
+    static_assert(detail::enum_name_table<Color>::find("blue") == Color::blue);
+}
+
+TEST_CASE_TEMPLATE("CBOR - enum names in a struct", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const std::vector<LogLine> lines{{Level::info, Color::red, "started"}, {Level::error, Color::blue, "failed"}};
+
+    T data;
+    REQUIRE(make_encoder(data)(lines));
+
+    std::vector<LogLine> decoded;
+    REQUIRE(make_decoder(data)(decoded));
+    REQUIRE_EQ(decoded.size(), lines.size());
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        CHECK_EQ(decoded[i].level, lines[i].level);
+        CHECK_EQ(decoded[i].color, lines[i].color);
+        CHECK_EQ(decoded[i].text, lines[i].text);
+    }
+}
+
+TEST_CASE("CBOR - enum names errors") {
+    Color color;
+
+    auto longer = to_bytes("6679656c6c6f77"); // "yellow", longer than every name
+    CHECK_EQ(make_decoder(longer)(color).error(), status_code::unknown_enum_name);
+
+    auto unknown = to_bytes("63726565"); // "ree"
+    CHECK_EQ(make_decoder(unknown)(color).error(), status_code::unknown_enum_name);
+
+    std::deque<std::byte> segmented(longer.begin(), longer.end());
+    CHECK_EQ(make_decoder(segmented)(color).error(), status_code::unknown_enum_name);
+
+    auto wrong_major = to_bytes("80");
+    CHECK_EQ(make_decoder(wrong_major)(color).error(), status_code::invalid_major_type_for_enum);
+}
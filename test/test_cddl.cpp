@@ -197,6 +197,39 @@ TEST_CASE("CWT payload map annotation") {
     fmt::print("Annotation: \n{}\n", fmt::to_string(annotation));
 }
 
+TEST_CASE_TEMPLATE("Annotation layout", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const auto bytes = to_bytes("d88c82182a9f01ff626869");
+    const T    buffer(bytes.begin(), bytes.end());
+
+    std::string annotation;
+    REQUIRE(buffer_annotate(buffer, annotation));
+    CHECK_EQ(annotation, "d8 8c\n"
+                         "   82\n"
+                         "      18 2a\n"
+                         "      9f\n"
+                         "         01\n"
+                         "         ff\n"
+                         "62\n"
+                         "   6869\n");
+
+    // Only the items starting at the indefinite array up to the text string, indented as in the whole buffer
+    annotation.clear();
+    REQUIRE(buffer_annotate(buffer, annotation, {.range_begin = 5, .range_end = 8}));
+    CHECK_EQ(annotation, "      9f\n"
+                         "         01\n"
+                         "         ff\n");
+}
+
+TEST_CASE("Annotation wraps string bytes and reports errors") {
+    std::string annotation;
+    REQUIRE(buffer_annotate(to_bytes("43010203"), annotation, {.max_depth = 2}));
+    CHECK_EQ(annotation, "43\n   0102\n   03\n");
+
+    CHECK_EQ(buffer_annotate(to_bytes("8201"), annotation).error(), status_code::incomplete);
+    CHECK_EQ(buffer_annotate(to_bytes("a101ff"), annotation).error(), status_code::malformed);
+    CHECK_EQ(buffer_annotate(to_bytes("bf01ff"), annotation).error(), status_code::malformed);
+}
+
 TEST_CASE("CDDL adhoc tagging") {
     struct A {
         std::string a;
@@ -225,6 +258,39 @@ TEST_CASE("Diagnostic data 0") {
                  "9c4c7c6a555e601d6fa29f9179bc3d7438bacaca5acd08c8d4d4f96131680c429a01f85951ecee743a52b9b63632c57209120e1c9e30");
 
     fmt::memory_buffer buffer;
-    diagnostic_buffer(data, buffer);
+    REQUIRE(diagnostic_buffer(data, buffer));
     fmt::print("Diagnostic: \n{}\n", fmt::to_string(buffer));
-}
\ No newline at end of file
+
+    CHECK(fmt::to_string(buffer).starts_with("18([h'a10126', {4: h'4173796d6d65747269634543445341323536'}, h'a7"));
+    CHECK(fmt::to_string(buffer).ends_with("'])"));
+}
+
+TEST_CASE("Diagnostic notation of all major types") {
+    const auto diagnostic = [](std::string_view hex) {
+        std::string text;
+        REQUIRE(diagnostic_buffer(to_bytes(hex), text));
+        return text;
+    };
+
+    CHECK_EQ(diagnostic("00"), "0");
+    CHECK_EQ(diagnostic("3bffffffffffffffff"), "-18446744073709551616");
+    CHECK_EQ(diagnostic("4401020304"), "h'01020304'");
+    CHECK_EQ(diagnostic("62c3bc"), "\"\xc3\xbc\"");
+    CHECK_EQ(diagnostic("826161a1616201"), R"(["a", {"b": 1}])");
+    CHECK_EQ(diagnostic("9f018202039f0405ffff"), "[_ 1, [2, 3], [_ 4, 5]]");
+    CHECK_EQ(diagnostic("bf61610161629f0203ffff"), R"({_ "a": 1, "b": [_ 2, 3]})");
+    CHECK_EQ(diagnostic("5f42010243030405ff"), "(_ h'0102', h'030405')");
+    CHECK_EQ(diagnostic("7f657374726561646d696e67ff"), R"((_ "strea", "ming"))");
+    CHECK_EQ(diagnostic("c11a514b67b0"), "1(1363896240)");
+    CHECK_EQ(diagnostic("f4f5f6f7f0f8ff"), "false,\ntrue,\nnull,\nundefined,\nsimple(16),\nsimple(255)");
+    CHECK_EQ(diagnostic("f93c00fa47c35000fb3ff199999999999a"), "1.0,\n100000.0,\n1.1");
+    CHECK_EQ(diagnostic("fb7e37e43c8800759c"), "1.0e+300");
+    CHECK_EQ(diagnostic("f97e00f97c00f9fc00"), "NaN,\nInfinity,\n-Infinity");
+}
+
+TEST_CASE("Diagnostic notation reports malformed input") {
+    std::string text;
+    CHECK_FALSE(diagnostic_buffer(to_bytes("8201"), text));
+    CHECK_FALSE(diagnostic_buffer(to_bytes("ff"), text));
+    CHECK_FALSE(diagnostic_buffer(to_bytes("5f6161ff"), text));
+}
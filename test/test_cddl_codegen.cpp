@@ -0,0 +1,87 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/extensions/cbor_cddl_schema.h"
+#include "test_util.h"
+
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+// Generated from cddl/sensors.cddl at build time, see cbor_tags_generate_cddl in test/CMakeLists.txt
+#include "sensors.h"
+
+using namespace cbor::tags;
+
+TEST_CASE("CDDL generated types") {
+    static_assert(HasInlineTag<sensors::report> && sensors::report::cbor_tag == 1500);
+    static_assert(std::is_same_v<decltype(sensors::reading::value), std::variant<std::int64_t, double>>);
+    static_assert(std::is_same_v<decltype(sensors::reading::unit), std::optional<std::string>>);
+    static_assert(std::is_same_v<sensors::readings, std::vector<sensors::reading>>);
+    static_assert(std::is_same_v<sensors::config, std::map<std::string, std::variant<std::string, std::uint64_t>>>);
+    static_assert(std::is_same_v<sensors::limits, std::map<std::uint64_t, float>>);
+}
+
+TEST_CASE_TEMPLATE("CDDL generated types round trip and match their schema", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const sensors::report report{
+        .station  = "north",
+        .readings = {{.sensor = "t1", .value = std::int64_t{-4}, .unit = "C", .taken = {.value = "2025-01-01T00:00:00Z"}},
+                     {.sensor = "h1", .value = 0.5, .unit = std::nullopt, .taken = {.value = "2025-01-01T00:00:10Z"}}},
+        .note     = "ok"};
+
+    T    buffer;
+    auto enc = make_encoder(buffer);
+    REQUIRE(enc(report));
+
+    const auto schema = cddl_schema::compile(sensors::cddl);
+    REQUIRE(schema);
+    CHECK(schema->validate(buffer));
+
+    sensors::report decoded;
+    auto            dec = make_decoder(buffer);
+    REQUIRE(dec(decoded));
+    CHECK_EQ(decoded.station, "north");
+    REQUIRE_EQ(decoded.readings.size(), 2);
+    CHECK_EQ(std::get<std::int64_t>(decoded.readings[0].value), -4);
+    CHECK_EQ(decoded.readings[0].unit, "C");
+    CHECK_EQ(decoded.readings[0].taken.value, "2025-01-01T00:00:00Z");
+    CHECK_EQ(std::get<double>(decoded.readings[1].value), 0.5);
+    CHECK_FALSE(decoded.readings[1].unit.has_value());
+    CHECK_EQ(decoded.note, "ok");
+
+    // The types do not carry the .size control on note, the schema does
+    auto long_note = report;
+    long_note.note = std::string(65, 'x');
+    T    other;
+    auto other_enc = make_encoder(other);
+    REQUIRE(other_enc(long_note));
+    CHECK_EQ(schema->validate(other).error(), status_code::schema_mismatch);
+}
+
+TEST_CASE("CDDL generated maps") {
+    const sensors::config config{{"name", "rooftop"}, {"interval", std::uint64_t{30}}, {"site", "b2"}};
+
+    std::vector<std::byte> buffer;
+    auto                   enc = make_encoder(buffer);
+    REQUIRE(enc(config));
+
+    const auto schema = cddl_schema::compile(sensors::cddl);
+    REQUIRE(schema);
+    CHECK(schema->validate(buffer, "config"));
+
+    // A map of named members decodes into the std::map, which the schema then checks for the members it requires
+    sensors::config decoded;
+    auto            dec = make_decoder(buffer);
+    REQUIRE(dec(decoded));
+    CHECK_EQ(decoded, config);
+
+    std::vector<std::byte> nameless;
+    auto                   nameless_enc = make_encoder(nameless);
+    REQUIRE(nameless_enc(sensors::config{{"interval", std::uint64_t{30}}}));
+    CHECK_FALSE(schema->validate(nameless, "config"));
+}
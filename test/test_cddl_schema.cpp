@@ -0,0 +1,224 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/extensions/cbor_cddl_schema.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+struct Reading {
+    std::string      sensor;
+    std::vector<int> values;
+};
+
+cddl_schema compiled(std::string_view cddl) {
+    auto schema = cddl_schema::compile(cddl);
+    REQUIRE(schema);
+    return std::move(*schema);
+}
+
+status_code mismatch(const cddl_schema &schema, std::string_view hex) {
+    const auto result = schema.validate(to_bytes(hex));
+    REQUIRE_FALSE(result);
+    return result.error();
+}
+} // namespace
+
+TEST_CASE("CDDL schema validates prelude types") {
+    const auto schema = compiled("value = int / tstr / bool / null / float");
+
+    CHECK(schema.validate(to_bytes("00")));
+    CHECK(schema.validate(to_bytes("3bffffffffffffffff")));
+    CHECK(schema.validate(to_bytes("6161")));
+    CHECK(schema.validate(to_bytes("f5")));
+    CHECK(schema.validate(to_bytes("f6")));
+    CHECK(schema.validate(to_bytes("f93c00")));
+    CHECK(schema.validate(to_bytes("fb3ff199999999999a")));
+
+    CHECK_EQ(mismatch(schema, "4161"), status_code::schema_mismatch);
+    CHECK_EQ(mismatch(schema, "f7"), status_code::schema_mismatch);
+    CHECK_EQ(mismatch(schema, "80"), status_code::schema_mismatch);
+    CHECK_EQ(mismatch(schema, "0000"), status_code::schema_mismatch); // Only one item
+    CHECK_EQ(mismatch(schema, "19"), status_code::incomplete);
+}
+
+TEST_CASE("CDDL schema ranges, literals and controls") {
+    const auto schema = compiled(R"(
+        message = [kind, port, id, ? note]
+        kind = "get" / "put"      ; text literals
+        port = 1..65535
+        id = bstr .size 4 / (int .lt -10)
+        note = tstr .size (1..3)
+    )");
+
+    CHECK(schema.validate(to_bytes("84636765741850440102030462686b")));
+    CHECK(schema.validate(to_bytes("8363707574014401020304")));
+    CHECK(schema.validate(to_bytes("846367657418502a626869")));
+
+    CHECK_FALSE(schema.validate(to_bytes("8363676574004401020304")));             // port 0
+    CHECK_FALSE(schema.validate(to_bytes("836364656c014401020304")));             // kind "del"
+    CHECK_FALSE(schema.validate(to_bytes("83636765740143010203")));               // id of 3 bytes
+    CHECK_FALSE(schema.validate(to_bytes("83636765740129")));                     // id -10
+    CHECK_FALSE(schema.validate(to_bytes("8463676574014401020304646869686f"))); // note too long
+
+    CHECK(schema.validate(to_bytes("19ffff"), "port"));
+    CHECK_FALSE(schema.validate(to_bytes("1a00010000"), "port"));
+    CHECK_EQ(schema.validate(to_bytes("01"), "missing").error(), status_code::invalid_schema);
+}
+
+TEST_CASE("CDDL schema maps members in any order") {
+    const auto schema = compiled(R"(
+        reading = {
+            sensor: tstr,
+            values: [* int],
+            ? unit: "C" / "F",
+            * int => any
+        }
+    )");
+
+    // {"sensor": "a", "values": [1, 2]}
+    CHECK(schema.validate(to_bytes("a26673656e736f7261616676616c756573820102")));
+    // {"values": [], "unit": "C", "sensor": "b", 7: null}
+    CHECK(schema.validate(to_bytes("a46676616c7565738064756e697461436673656e736f72616207f6")));
+    // Indefinite length map and array
+    CHECK(schema.validate(to_bytes("bf6673656e736f7261616676616c7565739f01ffff")));
+
+    CHECK_FALSE(schema.validate(to_bytes("a16673656e736f726161")));                         // values is missing
+    CHECK_FALSE(schema.validate(to_bytes("a26673656e736f72616164756e69746147")));           // unit "G" fails the cut
+    CHECK_FALSE(schema.validate(to_bytes("a36673656e736f7261616676616c7565738061786161"))); // unknown text key
+    CHECK_FALSE(schema.validate(to_bytes("a26673656e736f7261616676616c75657381f6")));       // null in values
+
+    std::vector<std::byte> buffer;
+    auto                   enc = make_encoder(buffer);
+    REQUIRE(enc(std::map<std::string, std::vector<int>>{{"sensor", {}}, {"values", {1, 2, 3}}}));
+    CHECK_EQ(schema.validate(buffer).error(), status_code::schema_mismatch); // sensor is an array
+}
+
+TEST_CASE("CDDL schema groups, occurrences and tags") {
+    const auto schema = compiled(R"(
+        document = #6.1234([2*3 entry, * pair])
+        entry = uint
+        pair = (name: tstr, value: int)
+        header = (version: 1, ? flags: uint)
+        envelope = {header, body: bstr}
+    )");
+
+    CHECK(schema.validate(to_bytes("d904d2820102")));
+    CHECK(schema.validate(to_bytes("d904d287010203616101616220")));
+    CHECK_FALSE(schema.validate(to_bytes("d904d28101")));         // one entry
+    CHECK_FALSE(schema.validate(to_bytes("d904d2840102036161"))); // half a pair
+    CHECK_FALSE(schema.validate(to_bytes("d904d3820102")));       // other tag
+    CHECK_FALSE(schema.validate(to_bytes("820102")));             // untagged
+
+    CHECK(schema.validate(to_bytes("a26776657273696f6e0164626f647940"), "envelope"));
+    CHECK(schema.validate(to_bytes("a36776657273696f6e0165666c6167730264626f647940"), "envelope"));
+    CHECK_FALSE(schema.validate(to_bytes("a26776657273696f6e0264626f647940"), "envelope")); // version 2
+    CHECK_FALSE(schema.validate(to_bytes("a16776657273696f6e01"), "envelope"));             // no body
+}
+
+TEST_CASE("CDDL schema splits array items between entries") {
+    const auto optional_first = compiled("a = [? int, int]");
+    CHECK(optional_first.validate(to_bytes("8101")));
+    CHECK(optional_first.validate(to_bytes("820102")));
+    CHECK(optional_first.validate(to_bytes("9f01ff")));
+    CHECK_FALSE(optional_first.validate(to_bytes("80")));
+    CHECK_FALSE(optional_first.validate(to_bytes("83010203")));
+
+    const auto any_first = compiled("a = [* int, int]");
+    CHECK(any_first.validate(to_bytes("8101")));
+    CHECK(any_first.validate(to_bytes("820102")));
+    CHECK(any_first.validate(to_bytes("9f010203ff")));
+    CHECK_FALSE(any_first.validate(to_bytes("80")));
+    CHECK_FALSE(any_first.validate(to_bytes("8301026161")));
+
+    // Whole occurrences of a group, and items within a nested group, go to what follows in the array
+    CHECK(compiled("a = [* (int, int), int, int]").validate(to_bytes("8401020304")));
+    CHECK(compiled("a = [(* int, 2), * int]").validate(to_bytes("83010203")));
+    CHECK_FALSE(compiled("a = [(* int, 2), * int]").validate(to_bytes("83010303")));
+    CHECK(compiled("a = [(* int), int]").validate(to_bytes("820102")));
+    CHECK(compiled("a = [* (int, * tstr)]").validate(to_bytes("84016161616202")));
+    CHECK(compiled("a = [* ()]").validate(to_bytes("80")));
+    CHECK_FALSE(compiled("a = [* ()]").validate(to_bytes("8101")));
+
+    std::vector<int> values(100000, 1);
+    values.push_back(-1);
+    std::vector<std::byte> buffer;
+    auto                   enc = make_encoder(buffer);
+    REQUIRE(enc(values));
+    CHECK(compiled("a = [* uint, nint]").validate(buffer));
+    CHECK_FALSE(compiled("a = [* uint, uint]").validate(buffer));
+
+    // Every way to split a long array that does not match is ruled out in one pass over it
+    const auto start = std::chrono::steady_clock::now();
+    CHECK_FALSE(compiled("a = [* int, * int, * int, tstr]").validate(buffer));
+    CHECK_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
+
+TEST_CASE("CDDL schema extends choices and recurses") {
+    const auto schema = compiled(R"(
+        tree = leaf / node
+        node = [* tree]
+        leaf /= uint
+        leaf = tstr
+        leaf /= null
+    )");
+
+    CHECK(schema.validate(to_bytes("8301816161f6")));
+    CHECK(schema.validate(to_bytes("83808180828080")));
+    CHECK_FALSE(schema.validate(to_bytes("8120")));
+
+    // Nesting past the cursor's depth limit is reported as such
+    std::vector<std::byte> deep(300, std::byte{0x81});
+    deep.push_back(std::byte{0x00});
+    CHECK_EQ(schema.validate(deep).error(), status_code::nesting_too_deep);
+}
+
+TEST_CASE_TEMPLATE("CDDL schema validates any buffer", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const auto schema = compiled(R"(reading = [sensor: tstr, values: [* int]])");
+
+    T    buffer;
+    auto enc = make_encoder(buffer);
+    REQUIRE(enc(Reading{.sensor = "temperature", .values = {1, -2, 300}}));
+    CHECK(schema.validate(buffer));
+
+    T    other;
+    auto other_enc = make_encoder(other);
+    REQUIRE(other_enc(std::vector<int>{1, 2}));
+    CHECK_EQ(schema.validate(other).error(), status_code::schema_mismatch);
+}
+
+TEST_CASE("CDDL schema rejects what it does not support") {
+    CHECK_FALSE(cddl_schema::compile(""));
+    CHECK_FALSE(cddl_schema::compile("a = b"));                      // b is not defined
+    CHECK_FALSE(cddl_schema::compile("a = [* b]\nb = c"));           // nor c
+    CHECK_FALSE(cddl_schema::compile("a = tstr .regexp \"x\""));     // control
+    CHECK_FALSE(cddl_schema::compile("a = h'00'"));                  // byte string literal
+    CHECK_FALSE(cddl_schema::compile("a = {b // c}\nb = 1\nc = 2")); // group choice
+    CHECK_FALSE(cddl_schema::compile("a = [5..1]"));                 // empty range
+    CHECK_FALSE(cddl_schema::compile("a = (b: int)"));               // the first rule must be a type
+    CHECK_FALSE(cddl_schema::compile("a = {int}"));                  // map members need keys
+
+    // Choices that lead back to themselves without reading anything
+    CHECK_EQ(cddl_schema::compile("a = [a2]\na2 = a2 / int").error(), status_code::invalid_schema);
+    CHECK_EQ(cddl_schema::compile("a = b / int\nb = tstr / a").error(), status_code::invalid_schema);
+    CHECK_EQ(cddl_schema::compile("a = b\nb = a").error(), status_code::invalid_schema);
+    CHECK(cddl_schema::compile("a = [* b]\nb = int / [b]"));
+
+    // Arrays unroll to a bounded number of positions
+    CHECK(cddl_schema::compile("a = [63*63 int]"));
+    CHECK(cddl_schema::compile("a = [0*100000 ()]"));
+    CHECK_EQ(cddl_schema::compile("a = [64*64 int]").error(), status_code::invalid_schema);
+    CHECK_EQ(cddl_schema::compile("a = [* (int, 2*70 tstr)]").error(), status_code::invalid_schema);
+    CHECK_EQ(cddl_schema::compile("a = [b]\nb = (int, ? b)").error(), status_code::invalid_schema);
+}
@@ -0,0 +1,116 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+using namespace cbor::tags;
+using namespace std::chrono_literals;
+
+namespace {
+template <typename Duration> using sys_time = std::chrono::time_point<std::chrono::system_clock, Duration>;
+
+struct Event {
+    std::string                        name;
+    sys_time<std::chrono::nanoseconds> at;
+    std::chrono::microseconds          took;
+    sys_time<std::chrono::seconds>     logged;
+};
+
+template <typename T> std::string encoded(const T &value) {
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(value));
+    return to_hex(data);
+}
+} // namespace
+
+TEST_CASE("chrono time points, shortest encoding") {
+    // RFC 8949 Appendix A
+    CHECK_EQ(encoded(sys_time<std::chrono::seconds>(1363896240s)), "c11a514b67b0");
+    CHECK_EQ(encoded(sys_time<std::chrono::milliseconds>(1363896240500ms)), "c1fb41d452d9ec200000");
+
+    // Half a second before the epoch fits a float32
+    CHECK_EQ(encoded(sys_time<std::chrono::nanoseconds>(-1500ms)), "c1fabfc00000");
+
+    // Nanoseconds no double holds, extended time
+    CHECK_EQ(encoded(sys_time<std::chrono::nanoseconds>(1700000000s + 123456789ns)), "d903e9a2011a6553f100281a075bcd15");
+
+    // Milliseconds near the epoch are shorter as extended time than as a double
+    CHECK_EQ(encoded(sys_time<std::chrono::milliseconds>(123ms)), "d903e9a2010022187b");
+}
+
+TEST_CASE("chrono durations") {
+    CHECK_EQ(encoded(90s), "d903eaa101185a");
+    CHECK_EQ(encoded(1500ms), "d903eaa20101221901f4");
+    CHECK_EQ(encoded(-1us), "d903eaa20120251a000f423f");
+    CHECK_EQ(encoded(std::chrono::hours{2}), "d903eaa101191c20");
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(1500ms, -1us, std::chrono::hours{2}, 1234567ns));
+    std::chrono::milliseconds a;
+    std::chrono::microseconds b;
+    std::chrono::hours        c;
+    std::chrono::microseconds d; // Rounded to the nearest microsecond
+    REQUIRE(make_decoder(data)(a, b, c, d));
+    CHECK_EQ(a, 1500ms);
+    CHECK_EQ(b, -1us);
+    CHECK_EQ(c, std::chrono::hours{2});
+    CHECK_EQ(d, 1235us);
+}
+
+TEST_CASE_TEMPLATE("chrono members", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const auto  at = sys_time<std::chrono::nanoseconds>(1700000000s + 123456789ns);
+    const Event event{"deploy", at, 2500us, std::chrono::floor<std::chrono::seconds>(at)};
+
+    T data;
+    REQUIRE(make_encoder(data)(event));
+    Event decoded;
+    REQUIRE(make_decoder(data)(decoded));
+    CHECK_EQ(decoded.name, event.name);
+    CHECK(decoded.at == event.at);
+    CHECK_EQ(decoded.took, event.took);
+    CHECK(decoded.logged == event.logged);
+}
+
+TEST_CASE("chrono decoding") {
+    // Floating point seconds rounded to the target
+    auto                                rfc_float = to_bytes("c1fb41d452d9ec200000");
+    sys_time<std::chrono::milliseconds> millis;
+    REQUIRE(make_decoder(rfc_float)(millis));
+    CHECK_EQ(millis.time_since_epoch(), 1363896240500ms);
+
+    auto                           extended = to_bytes("d903e9a2011a6553f100281a075bcd15");
+    sys_time<std::chrono::seconds> seconds;
+    REQUIRE(make_decoder(extended)(seconds));
+    CHECK_EQ(seconds.time_since_epoch(), 1700000000s);
+
+    // Elective keys are skipped, critical ones rejected
+    auto elective = to_bytes("d903e9a301000a635554432201");
+    REQUIRE(make_decoder(elective)(millis));
+    CHECK_EQ(millis.time_since_epoch(), 1ms);
+    auto critical = to_bytes("d903e9a201002000");
+    CHECK_EQ(make_decoder(critical)(millis).error(), status_code::invalid_tag_value);
+    auto no_seconds = to_bytes("d903e9a12201");
+    CHECK_EQ(make_decoder(no_seconds)(millis).error(), status_code::invalid_tag_value);
+    auto bad_fraction = to_bytes("d903e9a20100221903e8");
+    CHECK_EQ(make_decoder(bad_fraction)(millis).error(), status_code::invalid_tag_value);
+
+    // 10^12 seconds is past the range of nanoseconds
+    auto                               far = to_bytes("c11b000000e8d4a51000");
+    sys_time<std::chrono::nanoseconds> nanos;
+    CHECK_EQ(make_decoder(far)(nanos).error(), status_code::integer_overflow);
+    REQUIRE(make_decoder(far)(seconds));
+    CHECK_EQ(seconds.time_since_epoch(), std::chrono::seconds{1'000'000'000'000});
+
+    auto date_string = to_bytes("c074323031332d30332d32315432303a30343a30305a");
+    CHECK_EQ(make_decoder(date_string)(seconds).error(), status_code::invalid_tag_value);
+    auto duration_tag = to_bytes("d903eaa101185a");
+    CHECK_EQ(make_decoder(duration_tag)(seconds).error(), status_code::invalid_tag_value);
+}
@@ -0,0 +1,100 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_cursor.h"
+#include "cbor_tags/cbor_segmented.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <span>
+#include <vector>
+
+using namespace cbor::tags;
+
+TEST_CASE("cursor heads") {
+    const auto bytes = to_bytes("1a000f4240397fff7f9f5820fb7ff8000000000000ff");
+    cursor     walk(bytes);
+
+    item_head head;
+    REQUIRE_EQ(walk.read_head(head), status_code::success);
+    CHECK_EQ(head.major, major_type::UnsignedInteger);
+    CHECK_EQ(head.argument, 1000000);
+    REQUIRE_EQ(walk.read_head(head), status_code::success);
+    CHECK_EQ(head.major, major_type::NegativeInteger);
+    CHECK_EQ(head.argument, 0x7fff);
+    REQUIRE_EQ(walk.read_head(head), status_code::success);
+    CHECK_EQ(head.major, major_type::TextString);
+    CHECK(head.indefinite());
+    REQUIRE_EQ(walk.read_head(head), status_code::success);
+    CHECK_EQ(head.major, major_type::Array);
+    CHECK(head.indefinite());
+    REQUIRE_EQ(walk.read_head(head), status_code::success);
+    CHECK_EQ(head.major, major_type::ByteString);
+    CHECK_EQ(head.argument, 32);
+    CHECK_EQ(walk.offset(), 12);
+    REQUIRE_EQ(walk.skip_bytes(0), status_code::success);
+    REQUIRE_EQ(walk.read_head(head), status_code::success);
+    CHECK_EQ(head.major, major_type::Simple);
+    CHECK_EQ(head.info, std::byte{27});
+    CHECK_EQ(head.argument, 0x7ff8000000000000);
+    REQUIRE_EQ(walk.read_head(head), status_code::success);
+    CHECK(head.is_break());
+    CHECK(walk.at_end());
+    CHECK_EQ(walk.read_head(head), status_code::incomplete);
+}
+
+TEST_CASE_TEMPLATE("cursor skips whole items", T, std::vector<std::byte>, std::deque<std::byte>) {
+    // [1, {"a": [2, 3]}, h'0102' (chunked), 4(["x"]), -1] followed by 7
+    const auto bytes = to_bytes("9f01a161618202035f41014102ffc481617820ff07");
+    const T    data(bytes.begin(), bytes.end());
+    cursor     walk(data);
+
+    REQUIRE_EQ(walk.skip(), status_code::success);
+    CHECK_EQ(walk.offset(), bytes.size() - 1);
+    item_head head;
+    REQUIRE_EQ(walk.read_head(head), status_code::success);
+    CHECK_EQ(head.argument, 7);
+
+    cursor shallow(data);
+    CHECK_EQ(shallow.skip(2), status_code::nesting_too_deep);
+}
+
+TEST_CASE("cursor errors") {
+    for (const auto *hex : {"1c", "1d", "1e", "1f", "3f", "df", "f818", "8201", "a1", "a20102", "9f01", "5f6161ff", "bf01ff", "ff"}) {
+        CAPTURE(hex);
+        const auto bytes = to_bytes(hex);
+        cursor     walk(bytes);
+        CHECK_NE(walk.skip(), status_code::success);
+    }
+    const auto truncated = to_bytes("1a0102");
+    cursor     walk(truncated);
+    item_head  head;
+    CHECK_EQ(walk.read_head(head), status_code::incomplete);
+
+    // Counts past the end of the buffer fail before reading the items
+    const auto huge = to_bytes("9b7fffffffffffffff00");
+    cursor     huge_walk(huge);
+    CHECK_EQ(huge_walk.skip(), status_code::incomplete);
+}
+
+TEST_CASE("cursor bytes from chained buffers") {
+    const auto                          bytes = to_bytes("4a00010203040506070809");
+    std::vector<std::vector<std::byte>> chunks{{bytes.begin(), bytes.begin() + 4}, {bytes.begin() + 4, bytes.end()}};
+    segmented_buffer                    chained(chunks);
+    cursor                              walk(chained);
+
+    item_head head;
+    REQUIRE_EQ(walk.read_head(head), status_code::success);
+    std::vector<std::size_t> spans;
+    std::vector<std::byte>   payload;
+    REQUIRE_EQ(walk.read_bytes(head.argument,
+                               [&](std::span<const std::byte> span) {
+                                   spans.push_back(span.size());
+                                   payload.insert(payload.end(), span.begin(), span.end());
+                               }),
+               status_code::success);
+    CHECK_EQ(spans, std::vector<std::size_t>({3, 7}));
+    CHECK_EQ(payload, std::vector<std::byte>(bytes.begin() + 1, bytes.end()));
+    CHECK(walk.at_end());
+}
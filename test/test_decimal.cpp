@@ -0,0 +1,144 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decimal.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "test_util.h"
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+struct Payment {
+    std::string                currency;
+    decimal_fraction<>         amount;
+    bigfloat<>                 rate;
+    decimal_fraction<int128_t> total;
+};
+
+template <typename T> std::string text_of(const T &value, std::chars_format fmt = std::chars_format::general) {
+    std::array<char, 128> buffer;
+    const auto [end, ec] = value.to_chars(buffer.data(), buffer.data() + buffer.size(), fmt);
+    REQUIRE(ec == std::errc{});
+    return std::string(buffer.data(), end);
+}
+} // namespace
+
+TEST_CASE("decimal fraction and bigfloat encoding") {
+    // RFC 8949 3.4.4
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(decimal_fraction<>(-2, 27315), bigfloat<>(-1, 3)));
+    CHECK_EQ(to_hex(data), "c48221196ab3"
+                           "c5822003");
+
+    decimal_fraction<> decimal;
+    bigfloat<>         binary;
+    REQUIRE(make_decoder(data)(decimal, binary));
+    CHECK_EQ(decimal, decimal_fraction<>(-2, 27315));
+    CHECK_EQ(binary, bigfloat<>(-1, 3));
+
+    // A mantissa past 64 bits is a bignum
+    std::vector<std::byte> big;
+    REQUIRE(make_encoder(big)(decimal_fraction<int128_t>(-30, static_cast<int128_t>(1) << 64)));
+    CHECK_EQ(to_hex(big), "c482381dc249010000000000000000");
+    decimal_fraction<int128_t> wide;
+    REQUIRE(make_decoder(big)(wide));
+    CHECK(wide.mantissa == static_cast<int128_t>(1) << 64);
+    CHECK_EQ(wide.exponent, -30);
+}
+
+TEST_CASE_TEMPLATE("decimal fraction members", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const Payment payment{"EUR", {-2, 123456}, {-3, 9}, {-10, static_cast<int128_t>(std::numeric_limits<std::int64_t>::max()) * 100}};
+
+    T data;
+    REQUIRE(make_encoder(data)(payment));
+    Payment decoded;
+    REQUIRE(make_decoder(data)(decoded));
+    CHECK_EQ(decoded.currency, payment.currency);
+    CHECK_EQ(decoded.amount, payment.amount);
+    CHECK_EQ(decoded.rate, payment.rate);
+    CHECK(decoded.total == payment.total);
+
+    // Tagged types in a variant are told apart by their tag
+    T rate;
+    REQUIRE(make_encoder(rate)(payment.rate));
+    std::variant<decimal_fraction<>, bigfloat<>> either;
+    REQUIRE(make_decoder(rate)(either));
+    CHECK(std::holds_alternative<bigfloat<>>(either));
+}
+
+TEST_CASE("decimal fraction decoding errors") {
+    decimal_fraction<> value;
+    auto               wrong_tag = to_bytes("c5822003");
+    CHECK_EQ(make_decoder(wrong_tag)(value).error(), status_code::invalid_tag_value);
+    auto wrong_size = to_bytes("c48321196ab301");
+    CHECK_EQ(make_decoder(wrong_size)(value).error(), status_code::invalid_container_size);
+    auto not_array = to_bytes("c421");
+    CHECK_EQ(make_decoder(not_array)(value).error(), status_code::invalid_major_type_for_array);
+    auto untagged = to_bytes("8221196ab3");
+    CHECK_EQ(make_decoder(untagged)(value).error(), status_code::invalid_major_type_for_tag);
+}
+
+TEST_CASE("decimal fraction to double") {
+    CHECK_EQ(decimal_fraction<>(-2, 27315).to_double(), 273.15);
+    CHECK_EQ(decimal_fraction<>(3, -5).to_double(), -5000.0);
+    CHECK_EQ(decimal_fraction<>(-1, 1).to_double(), 0.1);
+    // Past the exact fast path, still correctly rounded
+    CHECK_EQ(decimal_fraction<>(-40, 123456789).to_double(), 123456789e-40);
+    CHECK_EQ(decimal_fraction<>(0, std::numeric_limits<std::int64_t>::max()).to_double(), 9223372036854775807.0);
+    CHECK_EQ(decimal_fraction<int128_t>(-20, static_cast<int128_t>(1) << 100).to_double(), 12676506002.282294014967032053760);
+    CHECK_EQ(decimal_fraction<>(400, 1).to_double(), std::numeric_limits<double>::infinity());
+    CHECK_EQ(decimal_fraction<>(-400, 1).to_double(), 0.0);
+
+    for (const auto value : {0.0, 1.5, -273.15, 0.1, 1e-300, 5e-324, 1.7976931348623157e308, 123456789.123}) {
+        const auto decimal = decimal_fraction<>::from_double(value);
+        REQUIRE(decimal.has_value());
+        CHECK_EQ(decimal->to_double(), value);
+    }
+    CHECK_EQ(*decimal_fraction<>::from_double(-273.15), decimal_fraction<>(-2, -27315));
+    CHECK_EQ(*decimal_fraction<>::from_double(1e21), decimal_fraction<>(21, 1));
+    CHECK_FALSE(decimal_fraction<>::from_double(std::numeric_limits<double>::infinity()).has_value());
+    CHECK_FALSE(decimal_fraction<>::from_double(std::numeric_limits<double>::quiet_NaN()).has_value());
+}
+
+TEST_CASE("bigfloat to double") {
+    CHECK_EQ(bigfloat<>(-1, 3).to_double(), 1.5);
+    CHECK_EQ(bigfloat<>(10, -1).to_double(), -1024.0);
+    for (const auto value : {0.0, 1.5, -0.1, 1e-310, 1.7976931348623157e308}) {
+        const auto binary = bigfloat<>::from_double(value);
+        REQUIRE(binary.has_value());
+        CHECK_EQ(binary->to_double(), value);
+    }
+    CHECK_EQ(*bigfloat<>::from_double(-0.375), bigfloat<>(-3, -3));
+    CHECK_EQ(text_of(bigfloat<>(-1, 3)), "1.5");
+}
+
+TEST_CASE("decimal fraction to chars") {
+    CHECK_EQ(text_of(decimal_fraction<>(-2, 27315)), "273.15");
+    CHECK_EQ(text_of(decimal_fraction<>(-2, 27315), std::chars_format::scientific), "2.7315e+02");
+    CHECK_EQ(text_of(decimal_fraction<>(-5, -15)), "-0.00015");
+    CHECK_EQ(text_of(decimal_fraction<>(-5, -15), std::chars_format::fixed), "-0.00015");
+    CHECK_EQ(text_of(decimal_fraction<>(-12, 15)), "1.5e-11");
+    CHECK_EQ(text_of(decimal_fraction<>(2, 15)), "1500");
+    CHECK_EQ(text_of(decimal_fraction<>(20, 7)), "7e+20");
+    CHECK_EQ(text_of(decimal_fraction<>(20, 7), std::chars_format::fixed), "700000000000000000000");
+    CHECK_EQ(text_of(decimal_fraction<>(-2, 0)), "0.00");
+    CHECK_EQ(text_of(decimal_fraction<>(3, 0)), "0");
+    CHECK_EQ(text_of(decimal_fraction<>(-150, 1)), "1e-150");
+    CHECK_EQ(text_of(decimal_fraction<>(-2, 1500)), "15.00");
+    CHECK_EQ(text_of(decimal_fraction<int128_t>(-38, std::numeric_limits<int128_t>::min())),
+             "-1.70141183460469231731687303715884105728");
+
+    std::array<char, 4> small;
+    CHECK(decimal_fraction<>(-2, 27315).to_chars(small.data(), small.data() + small.size()).ec == std::errc::value_too_large);
+}
@@ -2,6 +2,8 @@
 #include "cbor_tags/cbor.h"
 #include "cbor_tags/cbor_concepts.h"
 #include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/cbor_segmented.h"
 #include "test_util.h"
 
 #include <array>
@@ -15,8 +17,11 @@
 #include <memory_resource>
 #include <nameof.hpp>
 #include <optional>
+#include <ranges>
+#include <string>
 #include <utility>
 #include <variant>
+#include <vector>
 
 using namespace cbor::tags;
 using namespace std::string_view_literals;
@@ -187,4 +192,103 @@ TEST_CASE_TEMPLATE("Test decode tag 1 variant", T, std::vector<char>, std::deque
         dec(a);
         CHECK_EQ(value_a.b, std::nullopt);
     }
-}
\ No newline at end of file
+}
+struct SegmentedMessage {
+    static constexpr std::uint64_t cbor_tag = 77;
+    std::uint64_t                  id;
+    std::string                    name;
+    std::vector<std::byte>         payload;
+    std::vector<std::uint32_t>     values;
+    double                         ratio;
+};
+
+TEST_CASE("Decode from segmented buffer") {
+    static_assert(std::random_access_iterator<segmented_buffer::const_iterator>);
+    static_assert(IsSegmented<segmented_buffer>);
+    static_assert(!IsContiguous<segmented_buffer>);
+
+    std::vector<std::byte> data;
+    auto                   enc = make_encoder(data);
+    SegmentedMessage       original{.id      = 0xDEADBEEFCAFE,
+                                    .name    = std::string(300, 'x'),
+                                    .payload = std::vector<std::byte>(1000, std::byte{0xAB}),
+                                    .values  = {1, 24, 256, 65536, 0xFFFFFFFF},
+                                    .ratio   = 3.14};
+    REQUIRE(enc(original));
+
+    for (std::size_t chunk_size : {1, 2, 3, 7, 64, 4096}) {
+        std::vector<std::vector<std::byte>> chunks;
+        for (std::size_t i = 0; i < data.size(); i += chunk_size) {
+            chunks.emplace_back(data.begin() + i, data.begin() + std::min(data.size(), i + chunk_size));
+        }
+        chunks.insert(chunks.begin() + chunks.size() / 2, std::vector<std::byte>{}); // Empty segments are skipped
+
+        segmented_buffer buffer(chunks);
+        REQUIRE_EQ(buffer.size(), data.size());
+        CHECK(std::ranges::equal(buffer, data));
+
+        auto             dec = make_decoder(buffer);
+        SegmentedMessage result;
+        REQUIRE(dec(result));
+        CHECK_EQ(result.id, original.id);
+        CHECK_EQ(result.name, original.name);
+        CHECK_EQ(result.payload, original.payload);
+        CHECK_EQ(result.values, original.values);
+        CHECK_EQ(result.ratio, original.ratio);
+    }
+}
+
+TEST_CASE("Segmented buffer from spans and joined chunks") {
+    std::vector<std::byte> data;
+    auto                   enc = make_encoder(data);
+    REQUIRE(enc(std::string("Hello segmented world!"), std::uint64_t{1000000}));
+
+    auto                                    bytes = std::span<const std::byte>(data);
+    std::vector<std::span<const std::byte>> spans{bytes.subspan(0, 5), bytes.subspan(5, 10), bytes.subspan(15)};
+
+    {
+        segmented_buffer buffer(spans);
+        auto             it = buffer.begin();
+        it += 17;
+        CHECK_EQ(it - buffer.begin(), 17);
+        CHECK_EQ(*it, data[17]);
+        it -= 13;
+        CHECK_EQ(*it, data[4]);
+        CHECK_EQ(buffer.begin()[20], data[20]);
+
+        auto          dec = make_decoder(buffer);
+        std::string   text;
+        std::uint64_t number;
+        REQUIRE(dec(text, number));
+        CHECK_EQ(text, "Hello segmented world!");
+        CHECK_EQ(number, 1000000);
+    }
+    {
+        std::vector<std::vector<std::byte>> chunks{{data.begin(), data.begin() + 4}, {data.begin() + 4, data.end()}};
+        segmented_buffer                    buffer(chunks | std::views::join);
+        CHECK_EQ(buffer.segments().size(), 2);
+
+        auto          dec = make_decoder(buffer);
+        std::string   text;
+        std::uint64_t number;
+        REQUIRE(dec(text, number));
+        CHECK_EQ(text, "Hello segmented world!");
+        CHECK_EQ(number, 1000000);
+    }
+}
+
+TEST_CASE("Decode large strings from deque") {
+    std::vector<std::byte> data;
+    auto                   enc = make_encoder(data);
+    std::string            text(5000, 'a');
+    std::vector<std::byte> bytes(5000, std::byte{0x42});
+    REQUIRE(enc(text, bytes));
+
+    std::deque<std::byte>  buffer(data.begin(), data.end());
+    auto                   dec = make_decoder(buffer);
+    std::string            text_result;
+    std::vector<std::byte> bytes_result;
+    REQUIRE(dec(text_result, bytes_result));
+    CHECK_EQ(text_result, text);
+    CHECK_EQ(bytes_result, bytes);
+}
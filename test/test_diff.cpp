@@ -0,0 +1,138 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/extensions/cbor_diff.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+// Diffs from against to, applies the diff to from and checks that it rebuilt to, returns the number of operations
+std::size_t round_trip(std::string_view from_hex, std::string_view to_hex_string, std::vector<std::byte> *diff_out = nullptr) {
+    auto                   from = to_bytes(from_hex);
+    const auto             to   = to_bytes(to_hex_string);
+    std::vector<std::byte> changes;
+    const auto             count = diff(from, to, changes);
+    REQUIRE(count);
+    REQUIRE(apply_diff(from, changes));
+    CHECK_EQ(to_hex(from), to_hex(to));
+    if (diff_out) {
+        *diff_out = changes;
+    }
+    return *count;
+}
+
+// {"users": [{"name": "ann", "id": 1}, {"name": "bob", "id": 2}, {"name": "cy", "id": 3}, {"name": "dee", "id": 4}], "count": 4}
+constexpr std::string_view users = "a265757365727384a2646e616d6563616e6e62696401a2646e616d6563626f6262696402a2646e616d656263796269"
+                                   "6403a2646e616d65636465656269640465636f756e7404";
+} // namespace
+
+TEST_CASE("Diff emits operations for the changed leaves") {
+    // {"a": 1, "b": [1, 2], "c": "x"} to {"a": 1, "b": [1, 3], "d": true}
+    std::vector<std::byte> changes;
+    CHECK_EQ(round_trip("a3616101616282010261636178", "a361610161628201036164f5", &changes), 3);
+    CHECK_EQ(to_hex(changes), "838181616382826162010382816164f5"); // [[["c"]], [["b", 1], 3], [["d"], true]]
+
+    CHECK_EQ(round_trip(users, users, &changes), 0);
+    CHECK_EQ(to_hex(changes), "80");
+
+    // A key added deep inside, the head of its map grows from 2 to 3 pairs
+    CHECK_EQ(round_trip(users, "a265757365727384a2646e616d6563616e6e62696401a3646e616d6563626f626269640265"
+                               "61646d696ef5a2646e616d6562637962696403a2646e616d65636465656269640465636f756e7404"),
+             1);
+
+    // Integer keys under a tag, {4: h'6b6964', -1: "x"} to {4: h'6b696432'}
+    CHECK_EQ(round_trip("d28343a10126a204436b6964206178477061796c6f6164", "d28343a10126a104446b696432477061796c6f6164"), 2);
+
+    // Indefinite maps keep their head, {_ "a": 1, "b": 2} to {_ "b": 3, "c": 4}
+    CHECK_EQ(round_trip("bf616101616202ff", "bf616203616304ff"), 3);
+
+    // A map head wider than needed is written back in its shortest form once a key is added or removed
+    CHECK_EQ(round_trip("b802616101616202", "a2616101616303"), 2);
+}
+
+TEST_CASE("Diff inserts and removes array elements") {
+    // [1, 2] to [1, 2, 3], appended as [[[2], 3, true]]
+    std::vector<std::byte> changes;
+    CHECK_EQ(round_trip("820102", "83010203", &changes), 1);
+    CHECK_EQ(to_hex(changes), "8183810203f5");
+
+    // [1, 2, 3] to [1, 3], [[[1]]]
+    CHECK_EQ(round_trip("83010203", "820103", &changes), 1);
+    CHECK_EQ(to_hex(changes), "81818101");
+
+    // A user inserted in the middle and one removed from it, the users around them are not sent again
+    CHECK_EQ(round_trip(users, "a265757365727385a2646e616d6563616e6e62696401a2646e616d6563657665626964f6a2646e616d6563626f6262696402a2"
+                               "646e616d6562637962696403a2646e616d65636465656269640465636f756e7404",
+                        &changes),
+             1);
+    CHECK_EQ(to_hex(changes), "81838265757365727301a2646e616d6563657665626964f6f5");
+    CHECK_EQ(round_trip(users, "a265757365727383a2646e616d6563616e6e62696401a2646e616d6562637962696403a2646e616d65636465656269640465"
+                               "636f756e7404"),
+             1);
+
+    // Elements in between are diffed by position, the ones left over are inserted
+    CHECK_EQ(round_trip("8401020304", "86010908070405"), 5);
+
+    // Indefinite arrays keep their head, definite ones get the shortest head for the new count
+    CHECK_EQ(round_trip("9f0102ff", "9f010203ff"), 1);
+    CHECK_EQ(round_trip("98020102", "83010203"), 1);
+    CHECK_EQ(round_trip("97" + std::string(46, '0'), "9818" + std::string(46, '0') + "01"), 1);
+}
+
+TEST_CASE("Diff replaces what it cannot rebuild byte for byte") {
+    // Reordered keys, {"count": 4, "users": []}
+    std::vector<std::byte> changes;
+    CHECK_EQ(round_trip(users, "a265636f756e740465757365727380", &changes), 1);
+    CHECK_EQ(to_hex(changes), "818280a265636f756e740465757365727380");
+
+    // Heads that the applier would not write back, a definite map becoming indefinite, another tag and another type
+    CHECK_EQ(round_trip("b802616101616202", "b802616101616303", &changes), 1);
+    CHECK_EQ(to_hex(changes), "818280b802616101616303");
+    CHECK_EQ(round_trip("98020102", "9803010203"), 1);
+    CHECK_EQ(round_trip("a1616101", "bf616101ff"), 1);
+    CHECK_EQ(round_trip("c1a1616101", "c2a1616101"), 1);
+    CHECK_EQ(round_trip("a1616101", "a161616161"), 1);
+
+    // The head of a map with 23 pairs has to grow when the 24th is added
+    std::map<int, int> pairs;
+    for (int i = 0; i < 23; ++i) {
+        pairs[i] = i;
+    }
+    std::vector<std::byte> from;
+    auto                   from_enc = make_encoder(from);
+    REQUIRE(from_enc(pairs));
+    pairs[100] = 5;
+    std::vector<std::byte> to;
+    auto                   to_enc = make_encoder(to);
+    REQUIRE(to_enc(pairs));
+    CHECK_EQ(round_trip(to_hex(from), to_hex(to)), 1);
+}
+
+TEST_CASE("Diff errors") {
+    const auto             from = to_bytes("a3616101616282010261636178");
+    std::vector<std::byte> changes;
+    CHECK_EQ(diff(from, to_bytes("a36161"), changes).error(), status_code::incomplete);
+    CHECK_EQ(diff(to_bytes("ff"), from, changes).error(), status_code::malformed);
+    CHECK(changes.empty());
+
+    // Applied to a document the diff was not made from
+    REQUIRE(diff(from, to_bytes("a361610161628201036164f5"), changes));
+    auto other = to_bytes("a1617a01");
+    CHECK_EQ(apply_diff(other, changes).error(), status_code::not_found);
+
+    auto document = to_bytes("a1616101");
+    CHECK_EQ(apply_diff(document, to_bytes("a0")).error(), status_code::malformed);
+    CHECK_EQ(apply_diff(document, to_bytes("8184")).error(), status_code::malformed);
+    CHECK_EQ(apply_diff(document, to_bytes("8183800100")).error(), status_code::malformed); // The third element is not true
+    CHECK_EQ(apply_diff(document, to_bytes("818381616202f5")).error(), status_code::not_found); // Inserting into a map
+    CHECK_EQ(apply_diff(document, to_bytes("818281")).error(), status_code::incomplete);
+    CHECK_EQ(to_hex(document), "a1616101");
+}
@@ -0,0 +1,120 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_embedded.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "test_util.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <list>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+struct Signed {
+    std::string               signer;
+    std::vector<std::uint8_t> signature;
+    std::uint64_t             issued;
+};
+
+struct Envelope {
+    std::uint64_t    id;
+    embedded<Signed> payload;
+};
+
+// What an Envelope looks like on the wire
+struct EnvelopeShape {
+    std::uint64_t                                         id;
+    tagged_object<static_tag<24>, std::vector<std::byte>> payload;
+};
+} // namespace
+
+TEST_CASE_TEMPLATE("embedded encodes into a byte string", T, std::vector<std::byte>, std::deque<std::byte>, std::list<std::byte>) {
+    // Content sizes on both sides of every length argument width
+    for (std::size_t length : {0, 10, 21, 22, 23, 30, 252, 253, 254, 300, 65530, 65533, 65534, 70000}) {
+        CAPTURE(length);
+        const auto text = std::string(length, 'a');
+
+        std::vector<std::byte> inner;
+        REQUIRE(make_encoder(inner)(text));
+        std::vector<std::byte> expected;
+        REQUIRE(make_encoder(expected)(EnvelopeShape{.id = 1, .payload = {static_tag<24>{}, inner}}));
+
+        struct Holder {
+            std::uint64_t         id;
+            embedded<std::string> payload;
+        };
+        T buffer;
+        REQUIRE(make_encoder(buffer)(Holder{.id = 1, .payload = text}));
+        CHECK_EQ(to_hex(buffer), to_hex(expected));
+    }
+}
+
+TEST_CASE("embedded into a fixed buffer") {
+    std::vector<std::byte> expected;
+    REQUIRE(make_encoder(expected)(embedded<std::string>(std::string(40, 'x'))));
+
+    std::array<std::byte, 64> buffer{};
+    auto                      enc = make_encoder(buffer);
+    REQUIRE(enc(embedded<std::string>(std::string(40, 'x'))));
+    REQUIRE_EQ(enc.bytes_written(), expected.size());
+    CHECK_EQ(to_hex(std::span(buffer).first(expected.size())), to_hex(expected));
+}
+
+TEST_CASE("embedded decodes lazily and forwards untouched") {
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(Envelope{.id = 42, .payload = Signed{"alice", {1, 2, 3}, 1700000000}}));
+
+    Envelope envelope;
+    REQUIRE(make_decoder(data)(envelope));
+    CHECK_EQ(envelope.id, 42);
+    CHECK_FALSE(envelope.payload.decoded().has_value());
+    CHECK(envelope.payload.encoded().data() > data.data());
+    CHECK(envelope.payload.encoded().data() < data.data() + data.size());
+
+    // Not opened, re-encoded from the recorded bytes
+    std::vector<std::byte> forwarded;
+    REQUIRE(make_encoder(forwarded)(envelope));
+    CHECK_EQ(to_hex(forwarded), to_hex(data));
+
+    auto inner = envelope.payload.get();
+    REQUIRE(inner);
+    CHECK_EQ((*inner)->signer, "alice");
+    CHECK_EQ((*inner)->signature, std::vector<std::uint8_t>{1, 2, 3});
+    CHECK_EQ((*inner)->issued, 1700000000);
+    CHECK(envelope.payload.decoded().has_value());
+
+    // Replacing the value drops the recorded bytes
+    envelope.payload = Signed{"bob", {}, 1};
+    CHECK(envelope.payload.encoded().empty());
+    std::vector<std::byte> replaced;
+    REQUIRE(make_encoder(replaced)(envelope));
+    Envelope roundtrip;
+    REQUIRE(make_decoder(replaced)(roundtrip));
+    auto bob = roundtrip.payload.get();
+    REQUIRE(bob);
+    CHECK_EQ((*bob)->signer, "bob");
+}
+
+TEST_CASE("embedded rejects wrong tags and bad content") {
+    embedded<std::uint64_t> value;
+
+    auto wrong_tag = to_bytes("d81941" "01");
+    CHECK_EQ(make_decoder(wrong_tag)(value).error(), status_code::invalid_tag_value);
+
+    auto not_bstr = to_bytes("d81801");
+    CHECK_EQ(make_decoder(not_bstr)(value).error(), status_code::invalid_major_type_for_binary_string);
+
+    // The outer item is fine, the content only fails once opened
+    auto bad_content = to_bytes("d818416161");
+    REQUIRE(make_decoder(bad_content)(value));
+    auto inner = value.get();
+    REQUIRE_FALSE(inner);
+    CHECK_EQ(inner.error(), status_code::invalid_major_type_for_unsigned_integer);
+}
@@ -3,6 +3,7 @@
 #include "cbor_tags/cbor_encoder.h"
 #include "test_util.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <deque>
@@ -15,6 +16,8 @@
 #include <nameof.hpp>
 #include <numeric>
 #include <optional>
+#include <span>
+#include <string>
 #include <vector>
 
 using namespace cbor::tags;
@@ -183,4 +186,103 @@ TEST_CASE_TEMPLATE("Test variant<...>", T, std::array<uint8_t, 1024>, std::vecto
         auto expected_sv = "f6"sv;
         CHECK_EQ(to_hex(buffer).substr(0, expected_sv.size()), expected_sv);
     }
-}
\ No newline at end of file
+}
+TEST_CASE_TEMPLATE("Staged encoding into non-contiguous buffers", T, std::deque<std::byte>, std::list<std::byte>, std::deque<uint8_t>) {
+    struct Message {
+        std::uint64_t               a;
+        std::string                 short_text;
+        std::string                 long_text;
+        std::vector<double>         values;
+        std::optional<std::int64_t> b;
+    };
+    Message message{.a          = 0x0102030405060708,
+                    .short_text = "short",
+                    .long_text  = std::string(200, 'z'),
+                    .values     = {1.0, 2.5, -3.75, 1e300},
+                    .b          = -1000};
+
+    std::vector<std::byte> expected;
+    REQUIRE(make_encoder(expected)(message, std::uint64_t{1}, std::string(63, 'y')));
+
+    T    buffer;
+    auto enc = make_encoder(buffer);
+    REQUIRE(enc(message, std::uint64_t{1}, std::string(63, 'y')));
+    CHECK_EQ(to_hex(buffer), to_hex(expected));
+
+    // Outside of operator() nothing is staged, every encode is visible in the buffer right away
+    enc.encode(std::uint64_t{1000});
+    CHECK_EQ(to_hex(buffer).substr(to_hex(expected).size()), "1903e8");
+}
+
+TEST_CASE_TEMPLATE("Fixed buffer overflow and resume", T, std::array<std::byte, 16>, std::span<std::byte>) {
+    struct Message {
+        std::uint64_t       a;
+        std::string         text;
+        std::vector<double> values;
+    };
+    Message message{.a = 0x0102030405060708, .text = "Hello fixed size buffers!", .values = {1.0, -2.5, 1e300}};
+
+    std::vector<std::byte> expected;
+    REQUIRE(make_encoder(expected)(message));
+    REQUIRE_GT(expected.size(), 32);
+
+    // For std::span the two buffers view separate storage, std::array owns it
+    std::array<std::byte, 16> first_storage{};
+    std::array<std::byte, 16> second_storage{};
+    auto                      make_buffer = [](std::array<std::byte, 16> &storage) -> T {
+        if constexpr (std::is_same_v<T, std::span<std::byte>>) {
+            return T(storage);
+        } else {
+            return T{};
+        }
+    };
+    T                      first_buffer  = make_buffer(first_storage);
+    T                      second_buffer = make_buffer(second_storage);
+    std::vector<std::byte> joined;
+
+    auto enc    = make_encoder(first_buffer);
+    auto result = enc(message);
+    REQUIRE_FALSE(result);
+    CHECK_EQ(result.error(), status_code::buffer_overflow);
+    CHECK_EQ(enc.bytes_needed(), expected.size());
+    CHECK_EQ(enc.bytes_written(), 16);
+    joined.insert(joined.end(), first_buffer.begin(), first_buffer.end());
+
+    // Resume encoding the same message into the next buffers until it fits
+    std::size_t offset = enc.bytes_written();
+    while (offset < expected.size()) {
+        std::fill(second_buffer.begin(), second_buffer.end(), std::byte{0});
+        auto next = make_encoder(second_buffer);
+        next.resume_from(offset);
+        auto next_result = next(message);
+        CHECK_EQ(next.bytes_needed(), expected.size());
+        CHECK_EQ(static_cast<bool>(next_result), offset + next.bytes_written() == expected.size());
+        joined.insert(joined.end(), second_buffer.begin(), second_buffer.begin() + next.bytes_written());
+        offset += next.bytes_written();
+    }
+    CHECK_EQ(to_hex(joined), to_hex(expected));
+}
+
+TEST_CASE("Fixed buffer exact fit") {
+    std::vector<std::byte> expected;
+    REQUIRE(make_encoder(expected)(std::string("abc"), std::uint64_t{500}));
+    REQUIRE_EQ(expected.size(), 7);
+
+    std::array<std::byte, 7> buffer{};
+    auto                     enc = make_encoder(buffer);
+    REQUIRE(enc(std::string("abc"), std::uint64_t{500}));
+    CHECK_EQ(enc.bytes_needed(), 7);
+    CHECK_EQ(enc.bytes_written(), 7);
+    CHECK_EQ(to_hex(buffer), to_hex(expected));
+
+    // One more byte does not fit, nothing is written past the end
+    std::array<std::byte, 8> guarded{};
+    auto                     window = std::span<std::byte>(guarded).first(7);
+    auto                     enc2   = make_encoder(window);
+    REQUIRE(enc2(std::string("abc"), std::uint64_t{500}));
+    auto result = enc2(true);
+    REQUIRE_FALSE(result);
+    CHECK_EQ(result.error(), status_code::buffer_overflow);
+    CHECK_EQ(enc2.bytes_needed(), 8);
+    CHECK_EQ(guarded[7], std::byte{0});
+}
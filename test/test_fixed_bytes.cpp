@@ -0,0 +1,99 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/cbor_segmented.h"
+#include "test_util.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+constexpr uuid entity_id{{std::byte{0x8c}, std::byte{0x4f}, std::byte{0x6e}, std::byte{0x2a}, std::byte{0x1b}, std::byte{0x3d},
+                          std::byte{0x4e}, std::byte{0x5f}, std::byte{0x9a}, std::byte{0x0b}, std::byte{0x7c}, std::byte{0x6d},
+                          std::byte{0x5e}, std::byte{0x4f}, std::byte{0x3a}, std::byte{0x2b}}};
+
+struct Message {
+    uuid                     id;
+    std::array<std::byte, 4> checksum;
+    std::string              body;
+};
+} // namespace
+
+TEST_CASE("uuid encoding") {
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(entity_id, entity_id.bytes));
+    CHECK_EQ(to_hex(data), "d82550"
+                           "8c4f6e2a1b3d4e5f9a0b7c6d5e4f3a2b"
+                           "50"
+                           "8c4f6e2a1b3d4e5f9a0b7c6d5e4f3a2b");
+
+    uuid                      tagged;
+    std::array<std::byte, 16> untagged;
+    REQUIRE(make_decoder(data)(tagged, untagged));
+    CHECK_EQ(tagged, entity_id);
+    CHECK_EQ(untagged, entity_id.bytes);
+}
+
+TEST_CASE_TEMPLATE("fixed size byte string members", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const Message message{entity_id, {std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}}, "hello"};
+
+    T data;
+    REQUIRE(make_encoder(data)(message));
+    Message decoded;
+    REQUIRE(make_decoder(data)(decoded));
+    CHECK_EQ(decoded.id, message.id);
+    CHECK_EQ(decoded.checksum, message.checksum);
+    CHECK_EQ(decoded.body, message.body);
+}
+
+TEST_CASE("fixed size byte string from chained buffers") {
+    auto                                bytes = to_bytes("508c4f6e2a1b3d4e5f9a0b7c6d5e4f3a2b");
+    std::vector<std::vector<std::byte>> chunks{{bytes.begin(), bytes.begin() + 7}, {bytes.begin() + 7, bytes.end()}};
+    segmented_buffer                    chained(chunks);
+
+    std::array<std::byte, 16> id;
+    REQUIRE(make_decoder(chained)(id));
+    CHECK_EQ(id, entity_id.bytes);
+}
+
+TEST_CASE("fixed size byte string errors") {
+    std::array<std::byte, 4> value;
+
+    auto too_long = to_bytes("450102030405");
+    CHECK_EQ(make_decoder(too_long)(value).error(), status_code::invalid_container_size);
+    auto too_short = to_bytes("43010203");
+    CHECK_EQ(make_decoder(too_short)(value).error(), status_code::invalid_container_size);
+    auto text = to_bytes("6401020304");
+    CHECK_EQ(make_decoder(text)(value).error(), status_code::invalid_major_type_for_binary_string);
+    auto truncated = to_bytes("44010203");
+    CHECK_EQ(make_decoder(truncated)(value).error(), status_code::incomplete);
+
+    uuid id;
+    auto wrong_tag = to_bytes("d82450"
+                              "8c4f6e2a1b3d4e5f9a0b7c6d5e4f3a2b");
+    CHECK_FALSE(make_decoder(wrong_tag)(id));
+}
+
+TEST_CASE("fixed size byte strings in a stringref namespace") {
+    std::vector<uuid> ids{entity_id, entity_id, entity_id};
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(stringref_namespace{ids}));
+    CHECK_EQ(to_hex(data), "d90100"
+                           "83"
+                           "d82550"
+                           "8c4f6e2a1b3d4e5f9a0b7c6d5e4f3a2b"
+                           "d825d81900"
+                           "d825d81900");
+
+    std::vector<uuid> decoded;
+    REQUIRE(make_decoder(data)(stringref_namespace{decoded}));
+    CHECK_EQ(decoded, ids);
+}
@@ -0,0 +1,151 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_embedded.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/extensions/cbor_hash.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+std::uint64_t xxh64(std::string_view text, std::uint64_t seed = 0) {
+    content_hasher hasher(seed);
+    hasher.update(std::as_bytes(std::span(text.data(), text.size())));
+    return hasher.digest();
+}
+
+hash128 canonical(std::string_view hex) {
+    const auto hash = hash_item(to_bytes(hex), {.canonical = true});
+    REQUIRE(hash);
+    return *hash;
+}
+} // namespace
+
+TEST_CASE("Content hasher matches XXH64 and does not depend on how input is split") {
+    CHECK_EQ(xxh64(""), 0xEF46DB3751D8E999ULL);
+    CHECK_EQ(xxh64("abc"), 0x44BC2CF5AD770999ULL);
+    CHECK_EQ(xxh64("Nobody inspects the spammish repetition"), 0xFBCEA83C8A378BF1ULL);
+    CHECK_EQ(xxh64(std::string(100, 'a')), 0x375041E8B1DECFB3ULL);
+    CHECK_NE(xxh64("abc", 1), xxh64("abc"));
+
+    std::vector<std::byte> bytes(1000);
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<std::byte>(i * 7 + i / 13);
+    }
+    content_hasher whole;
+    whole.update(bytes);
+    for (std::size_t piece : {1, 3, 31, 32, 33, 500}) {
+        content_hasher split;
+        for (std::size_t at = 0; at < bytes.size(); at += piece) {
+            split.update(std::span(bytes).subspan(at, std::min(piece, bytes.size() - at)));
+        }
+        CHECK_EQ(split.digest128(), whole.digest128());
+    }
+    CHECK_NE(whole.digest128().low, whole.digest128().high);
+
+    // The high half is XXH64 again, with another seed
+    content_hasher high(content_hasher::high_seed);
+    high.update(bytes);
+    CHECK_EQ(whole.digest128().high, high.digest());
+    CHECK_EQ(whole.digest128().low, whole.digest());
+    CHECK_EQ(content_hasher(5).digest128().high, xxh64("", 5 ^ content_hasher::high_seed));
+}
+
+TEST_CASE_TEMPLATE("Hash the encoded bytes of an item", T, std::vector<std::byte>, std::deque<std::byte>) {
+    // {"a": 1, "b": [1, 2]} and a second item after it
+    const auto bytes = to_bytes("a26161016162820102f6");
+    const T    buffer(bytes.begin(), bytes.end());
+
+    const auto hash = hash_item(buffer);
+    REQUIRE(hash);
+    CHECK_EQ(hash->low, xxh64(std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size() - 1)));
+    CHECK_EQ(*hash, *hash_item(to_bytes("a26161016162820102")));
+    CHECK_NE(*hash, *hash_item(buffer, {.seed = 1}));
+
+    CHECK_EQ(hash_item(to_bytes("a2616101")).error(), status_code::incomplete);
+    CHECK_EQ(hash_item(to_bytes("a2616101"), {.canonical = true}).error(), status_code::incomplete);
+    CHECK_EQ(hash_item(to_bytes("ff"), {.canonical = true}).error(), status_code::malformed);
+}
+
+TEST_CASE("Canonical hashes do not depend on the encoding") {
+    // {"a": 1, "b": [1, 2]}
+    const auto expected = canonical("a26161016162820102");
+    CHECK_EQ(canonical("bf61629f0102ff616101ff"), expected);         // Indefinite lengths, keys in another order
+    CHECK_EQ(canonical("b80278016118016162980219000102"), expected); // Heads wider than needed
+    CHECK_EQ(canonical("bf61628201027f6161ff01ff"), expected);       // A key in chunks
+    CHECK_NE(*hash_item(to_bytes("bf61629f0102ff616101ff")), *hash_item(to_bytes("a26161016162820102")));
+
+    CHECK_NE(canonical("a26161016162820201"), expected);       // [2, 1], arrays keep their order
+    CHECK_NE(canonical("a361610161628201026163f6"), expected); // One more pair
+    CHECK_NE(canonical("a2616101616283010200"), expected);     // One more element
+    CHECK_NE(canonical("a1616101"), canonical("a1616201"));
+    CHECK_NE(canonical("a1616101"), canonical("a1016161")); // Keys and values do not swap
+    CHECK_EQ(canonical("c11a5f5e1000"), canonical("d8011b000000005f5e1000"));
+    CHECK_EQ(canonical("5f4161ff"), canonical("4161"));
+    CHECK_NE(canonical("5f4161ff"), canonical("6161"));
+}
+
+TEST_CASE("Canonical hashes take floats in their shortest exact width") {
+    CHECK_EQ(canonical("fb3ff0000000000000"), canonical("f93c00")); // 1.0
+    CHECK_EQ(canonical("fa3fc00000"), canonical("f93e00"));         // 1.5
+    CHECK_EQ(canonical("fb3e70000000000000"), canonical("f90001")); // 2^-24, the smallest half precision subnormal
+    CHECK_EQ(canonical("fa38800000"), canonical("f90400"));         // 2^-14, the smallest normal one
+    CHECK_EQ(canonical("fb7ff0000000000000"), canonical("f97c00")); // Infinity
+    CHECK_EQ(canonical("fa80000000"), canonical("f98000"));         // -0.0
+    CHECK_NE(canonical("f98000"), canonical("f90000"));
+    CHECK_EQ(canonical("fb7ff8000000000001"), canonical("f97e00")); // NaNs
+    CHECK_EQ(canonical("fa7fc00000"), canonical("f97e00"));
+    CHECK_EQ(canonical("fb3ff0000020000000"), canonical("fa3f800001")); // Exact in single but not half precision
+    CHECK_NE(canonical("fb3ff0000000000001"), canonical("f93c00"));     // Exact only in double precision
+    CHECK_NE(canonical("fb3e60000000000000"), canonical("f90000"));     // 2^-25 is not a half precision value
+    CHECK_EQ(canonical("82fb4000000000000000f93c00"), canonical("82f94000fa3f800000"));
+    CHECK_NE(canonical("f93c00"), canonical("01")); // 1.0 is not 1
+}
+
+TEST_CASE_TEMPLATE("Hash while encoding", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const std::map<std::string, std::vector<int>> value{{"readings", {1, 2, 300, -4}}, {"station", {}}, {std::string(40, 'x'), {7}}};
+
+    T                 buffer;
+    hashing_buffer<T> hashing(buffer);
+    auto              enc = make_encoder(hashing);
+    REQUIRE(enc(value));
+
+    std::vector<std::byte> plain;
+    auto                   plain_enc = make_encoder(plain);
+    REQUIRE(plain_enc(value));
+    CHECK_EQ(to_hex(std::vector<std::byte>(buffer.begin(), buffer.end())), to_hex(plain));
+    CHECK_EQ(hashing.digest128(), *hash_item(plain));
+    CHECK_EQ(hashing.digest(), hash_item(plain)->low);
+}
+
+TEST_CASE_TEMPLATE("Hash while encoding embedded and raw items", T, std::vector<std::byte>, std::deque<std::byte>) {
+    static_assert(!IsContiguous<hashing_buffer<T>>, "the encoder has to append to the wrapper rather than write through data()");
+
+    struct Envelope {
+        embedded<std::string> payload;
+        raw_cbor              forwarded;
+        std::map<int, int>    counts;
+    };
+    const auto forwarded = to_bytes("a26161016162820102");
+    const auto value     = Envelope{embedded<std::string>(std::string(300, 'x')), raw_cbor{forwarded}, {{1, 2}, {3, 4}}};
+
+    T                 buffer;
+    hashing_buffer<T> hashing(buffer);
+    auto              enc = make_encoder(hashing);
+    REQUIRE(enc(value));
+
+    std::vector<std::byte> plain;
+    auto                   plain_enc = make_encoder(plain);
+    REQUIRE(plain_enc(value));
+    CHECK_EQ(to_hex(std::vector<std::byte>(buffer.begin(), buffer.end())), to_hex(plain));
+    CHECK_EQ(hashing.digest128(), *hash_item(plain));
+}
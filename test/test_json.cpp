@@ -0,0 +1,287 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/cbor_segmented.h"
+#include "cbor_tags/extensions/cbor_json.h"
+#include "test_util.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+struct Reading {
+    std::string                   sensor;
+    std::vector<int>              values;
+    std::map<std::string, double> limits;
+};
+
+std::string json_of(std::string_view hex, json_options options = {}) {
+    const auto  bytes = to_bytes(hex);
+    std::string json;
+    REQUIRE(cbor_to_json(bytes, json, options));
+    return json;
+}
+
+status_code json_error(std::string_view hex, json_options options = {}) {
+    const auto  bytes = to_bytes(hex);
+    std::string json;
+    const auto  result = cbor_to_json(bytes, json, options);
+    REQUIRE_FALSE(result);
+    return result.error();
+}
+} // namespace
+
+TEST_CASE("json scalars") {
+    // RFC 8949 Appendix A
+    CHECK_EQ(json_of("00"), "0");
+    CHECK_EQ(json_of("1bffffffffffffffff"), "18446744073709551615");
+    CHECK_EQ(json_of("3bffffffffffffffff"), "-18446744073709551616");
+    CHECK_EQ(json_of("3903e7"), "-1000");
+    CHECK_EQ(json_of("f93e00"), "1.5");
+    CHECK_EQ(json_of("fa47c35000"), "1e+05");
+    CHECK_EQ(json_of("fb3ff199999999999a"), "1.1");
+    CHECK_EQ(json_of("fb7e37e43c8800759c"), "1e+300");
+    CHECK_EQ(json_of("fa3dcccccd"), "0.1");
+    CHECK_EQ(json_of("f97e00"), "null");
+    CHECK_EQ(json_of("fbfff0000000000000"), "null");
+    CHECK_EQ(json_of("f4"), "false");
+    CHECK_EQ(json_of("f5"), "true");
+    CHECK_EQ(json_of("f6"), "null");
+    CHECK_EQ(json_of("f7"), "null");
+    CHECK_EQ(json_of("f0"), "null");
+}
+
+TEST_CASE("json text escaping") {
+    CHECK_EQ(json_of("6161"), R"("a")");
+    CHECK_EQ(json_of("62c3bc"), "\"\xc3\xbc\"");
+    CHECK_EQ(json_of("62225c"), R"("\"\\")");
+
+    // Escapes before, inside and after a run of eight plain bytes
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(std::string("\ttab then a \"quoted\" word\nand a bell \x07 at the end\x1f")));
+    std::string json;
+    REQUIRE(cbor_to_json(data, json));
+    CHECK_EQ(json, R"("\ttab then a \"quoted\" word\nand a bell \u0007 at the end\u001f")");
+}
+
+TEST_CASE("json containers") {
+    CHECK_EQ(json_of("80"), "[]");
+    CHECK_EQ(json_of("a0"), "{}");
+    CHECK_EQ(json_of("a26161016162820203"), R"({"a":1,"b":[2,3]})");
+    CHECK_EQ(json_of("9f018202039f0405ffff"), "[1,[2,3],[4,5]]");
+    CHECK_EQ(json_of("bf61610161629f0203ffff"), R"({"a":1,"b":[2,3]})");
+    CHECK_EQ(json_of("7f657374726561646d696e67ff"), R"("streaming")");
+
+    // Keys that are not strings are quoted
+    CHECK_EQ(json_of("a4010220f93e00f5f4f6f6"), R"({"1":2,"-1":1.5,"true":false,"null":null})");
+}
+
+TEST_CASE("json byte strings") {
+    CHECK_EQ(json_of("4401020304"), R"("AQIDBA")");
+    CHECK_EQ(json_of("42fbff"), R"("-_8")");
+    CHECK_EQ(json_of("42fbff", {.bytes = json_bytes::base64}), R"("+/8=")");
+    CHECK_EQ(json_of("4401020304", {.bytes = json_bytes::base64}), R"("AQIDBA==")");
+    CHECK_EQ(json_of("4401020304", {.bytes = json_bytes::base16}), R"("01020304")");
+    CHECK_EQ(json_of("40"), R"("")");
+
+    // Chunks of an indefinite length byte string are one string
+    CHECK_EQ(json_of("5f42010243030405ff"), R"("AQIDBAU")");
+
+    // Expected conversions (tags 21 to 23) apply to the byte strings they enclose
+    CHECK_EQ(json_of("d6824401020304d7420a0b"), R"(["AQIDBA==","0a0b"])");
+    CHECK_EQ(json_of("d5a1614142fbff", {.bytes = json_bytes::base16}), R"({"A":"-_8"})");
+}
+
+TEST_CASE("json tags") {
+    CHECK_EQ(json_of("c074323031332d30332d32315432303a30343a30305a"), R"("2013-03-21T20:04:00Z")");
+    CHECK_EQ(json_of("c11a514b67b0"), "1363896240");
+    CHECK_EQ(json_of("c249010000000000000000"), R"("AQAAAAAAAAAA")");
+    CHECK_EQ(json_of("c349010000000000000000"), R"("~AQAAAAAAAAAA")");
+    CHECK_EQ(json_of("c48221196ab3"), "[-2,27315]");
+
+    const json_options tagged{.tags = json_tags::object};
+    CHECK_EQ(json_of("c11a514b67b0", tagged), R"({"tag":1,"value":1363896240})");
+    CHECK_EQ(json_of("d9d9f7c349010000000000000000", tagged), R"({"tag":55799,"value":{"tag":3,"value":"AQAAAAAAAAAA"}})");
+}
+
+TEST_CASE("json of encoded values") {
+    const Reading reading{"probe \"7\"", {1, -2, 300}, {{"max", 80.5}, {"min", -12.25}}};
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(reading, 42));
+
+    std::string json;
+    REQUIRE(cbor_to_json(data, json));
+    CHECK_EQ(json, "[\"probe \\\"7\\\"\",[1,-2,300],{\"max\":80.5,\"min\":-12.25}]\n42");
+}
+
+TEST_CASE_TEMPLATE("json from non-contiguous buffers", T, std::deque<std::byte>, segmented_buffer) {
+    // A text string longer than the output staging buffer, split across segments and staged blocks
+    std::string text(1500, 'x');
+    text[700] = '"';
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(std::vector<std::string>{text, "end"}));
+    std::string expected = R"([")" + text.substr(0, 700) + R"(\")" + text.substr(701) + R"(","end"])";
+
+    std::string json;
+    if constexpr (std::is_same_v<T, segmented_buffer>) {
+        std::vector<std::vector<std::byte>> chunks{{data.begin(), data.begin() + 100}, {data.begin() + 100, data.begin() + 1000},
+                                                   {data.begin() + 1000, data.end()}};
+        REQUIRE(cbor_to_json(segmented_buffer(chunks), json));
+    } else {
+        REQUIRE(cbor_to_json(T(data.begin(), data.end()), json));
+    }
+    CHECK_EQ(json, expected);
+}
+
+TEST_CASE("json to a sink") {
+    const auto               bytes = to_bytes("83616101a161620a");
+    std::vector<std::string> pieces;
+    auto                     sink = [&](std::string_view piece) { pieces.emplace_back(piece); };
+    REQUIRE(cbor_to_json(bytes, sink));
+    REQUIRE_EQ(pieces.size(), 1);
+    CHECK_EQ(pieces.front(), R"(["a",1,{"b":10}])");
+
+    std::vector<char> chars;
+    REQUIRE(cbor_to_json(bytes, chars));
+    CHECK_EQ(std::string_view(chars.data(), chars.size()), R"(["a",1,{"b":10}])");
+}
+
+TEST_CASE("json errors") {
+    CHECK_EQ(json_error("8201"), status_code::incomplete);
+    CHECK_EQ(json_error("1a0102"), status_code::incomplete);
+    CHECK_EQ(json_error("6461"), status_code::incomplete);
+    CHECK_EQ(json_error("1c"), status_code::malformed);
+    CHECK_EQ(json_error("ff"), status_code::malformed);
+    CHECK_EQ(json_error("8201ff"), status_code::malformed);
+    CHECK_EQ(json_error("5f6161ff"), status_code::malformed);
+    CHECK_EQ(json_error("f801"), status_code::malformed);
+    CHECK_EQ(json_error("a1800102"), status_code::invalid_major_type_for_text_string);
+    CHECK_EQ(json_error("818181818100", {.max_depth = 4}), status_code::nesting_too_deep);
+    CHECK_EQ(json_of("8181818100", {.max_depth = 4}), "[[[[0]]]]");
+
+    // What was written before the error is kept
+    const auto  bytes = to_bytes("8301021c");
+    std::string json;
+    CHECK_FALSE(cbor_to_json(bytes, json));
+    CHECK_EQ(json, "[1,2");
+}
+
+namespace {
+std::string cbor_of(std::string_view json, json_parse_options options = {}) {
+    std::vector<std::byte> data;
+    REQUIRE(json_to_cbor(json, data, options));
+    return to_hex(data);
+}
+
+status_code parse_error(std::string_view json, json_parse_options options = {}) {
+    std::vector<std::byte> data;
+    const auto             result = json_to_cbor(json, data, options);
+    REQUIRE_FALSE(result);
+    return result.error();
+}
+} // namespace
+
+TEST_CASE("json to cbor scalars") {
+    CHECK_EQ(cbor_of("0"), "00");
+    CHECK_EQ(cbor_of("-1"), "20");
+    CHECK_EQ(cbor_of("1000000"), "1a000f4240");
+    CHECK_EQ(cbor_of("18446744073709551615"), "1bffffffffffffffff");
+    CHECK_EQ(cbor_of("-18446744073709551616"), "3bffffffffffffffff");
+    CHECK_EQ(cbor_of("18446744073709551616"), "c249010000000000000000");
+    CHECK_EQ(cbor_of("true false null"), "f5f4f6");
+
+    // Preferred serialization, the shortest float that holds the value
+    CHECK_EQ(cbor_of("1.5"), "f93e00");
+    CHECK_EQ(cbor_of("-0.0"), "f98000");
+    CHECK_EQ(cbor_of("65504.0"), "f97bff");
+    CHECK_EQ(cbor_of("1e2"), "f95640");
+    CHECK_EQ(cbor_of("100000.0"), "fa47c35000");
+    CHECK_EQ(cbor_of("3.4028234663852886e+38"), "fa7f7fffff");
+    CHECK_EQ(cbor_of("1.1"), "fb3ff199999999999a");
+    CHECK_EQ(cbor_of("1E+300"), "fb7e37e43c8800759c");
+    CHECK_EQ(cbor_of("1e400"), "f97c00");
+    CHECK_EQ(cbor_of("-12e-400"), "f98000");
+    CHECK_EQ(cbor_of("0.001e-400"), "f90000");
+    CHECK_EQ(cbor_of("1000e306"), "f97c00");
+}
+
+TEST_CASE("json to cbor strings") {
+    CHECK_EQ(cbor_of(R"("")"), "60");
+    CHECK_EQ(cbor_of(R"("IETF")"), "6449455446");
+    CHECK_EQ(cbor_of(R"("\"\\\/\b\f\n\r\t")"), "68225c2f080c0a0d09");
+    CHECK_EQ(cbor_of(R"("aü水😀")"), "6a61c3bce6b0b4f09f9880");
+
+    std::string hex = "79012c";
+    for (int i = 0; i < 300; ++i) {
+        hex += "78";
+    }
+    CHECK_EQ(cbor_of('"' + std::string(300, 'x') + '"'), hex);
+}
+
+TEST_CASE("json to cbor containers") {
+    CHECK_EQ(cbor_of("[]"), "80");
+    CHECK_EQ(cbor_of(" { } "), "a0");
+    CHECK_EQ(cbor_of(R"({"a": 1, "b": [2, 3]})"), "a26161016162820203");
+    CHECK_EQ(cbor_of(R"({"a": 1, "b": [2, 3]})", {.containers = json_containers::indefinite}), "bf61610161629f0203ffff");
+
+    // Counts of 24 and more take a longer header, patched in once the array is closed
+    std::string json = "[[0";
+    for (int i = 1; i < 25; ++i) {
+        json += ",0";
+    }
+    json += "],[1]]";
+    CHECK_EQ(cbor_of(json), "829819" + std::string(50, '0') + "8101");
+
+    // Several JSON texts become a CBOR sequence
+    CHECK_EQ(cbor_of("1 [2]\n{}\n"), "018102a0");
+}
+
+TEST_CASE_TEMPLATE("json to cbor round trip", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const std::string_view json = R"({"id":7,"name":"probe \"7\"","tags":["a","ü"],"limits":{"max":80.5,"min":-12.25},"ok":true,"none":null})";
+
+    T data;
+    REQUIRE(json_to_cbor(json, data));
+    if constexpr (std::is_same_v<T, std::deque<std::byte>>) {
+        CHECK_EQ(data.front(), std::byte{0xbf}); // No cheap backpatching, indefinite length
+    }
+    std::string text;
+    REQUIRE(cbor_to_json(data, text));
+    CHECK_EQ(text, json);
+}
+
+TEST_CASE("json to cbor errors") {
+    CHECK_EQ(parse_error("[1,]"), status_code::malformed);
+    CHECK_EQ(parse_error("[1 2]"), status_code::malformed);
+    CHECK_EQ(parse_error(R"({"a" 1})"), status_code::malformed);
+    CHECK_EQ(parse_error("{1:2}"), status_code::malformed);
+    CHECK_EQ(parse_error("01"), status_code::malformed);
+    CHECK_EQ(parse_error("1.e5"), status_code::malformed);
+    CHECK_EQ(parse_error("+1"), status_code::malformed);
+    CHECK_EQ(parse_error("nul1"), status_code::malformed);
+    CHECK_EQ(parse_error("\"tab\there\""), status_code::malformed);
+    CHECK_EQ(parse_error(R"("\ud800")"), status_code::malformed);
+    CHECK_EQ(parse_error(R"("\udc00")"), status_code::malformed);
+    CHECK_EQ(parse_error(R"("\x")"), status_code::malformed);
+    CHECK_EQ(parse_error(R"("\u12g4")"), status_code::malformed);
+    CHECK_EQ(parse_error("[1"), status_code::incomplete);
+    CHECK_EQ(parse_error(R"({"a":)"), status_code::incomplete);
+    CHECK_EQ(parse_error(R"("abc)"), status_code::incomplete);
+    CHECK_EQ(parse_error(R"("\u00)"), status_code::incomplete);
+    CHECK_EQ(parse_error("tru"), status_code::incomplete);
+    CHECK_EQ(parse_error("1."), status_code::incomplete);
+    CHECK_EQ(parse_error("-"), status_code::incomplete);
+    CHECK_EQ(parse_error("[[[[1]]]]", {.max_depth = 3}), status_code::nesting_too_deep);
+
+    std::array<std::byte, 4> small;
+    CHECK_EQ(json_to_cbor("[1,2,3,4,5]", small).error(), status_code::buffer_overflow);
+}
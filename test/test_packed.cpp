@@ -0,0 +1,147 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+struct Reading {
+    std::string device;
+    std::string metric;
+    std::string unit;
+    double      value;
+    std::string source;
+};
+} // namespace
+
+TEST_CASE("packed shared items") {
+    std::vector<std::string> strings{"alpha", "alpha", "beta", "alpha"};
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(packed{strings}));
+    CHECK_EQ(to_hex(data), "d871"
+                           "83"
+                           "81" "65616c706861"
+                           "80"
+                           "84" "e0" "e0" "6462657461" "e0");
+
+    std::vector<std::string> decoded;
+    REQUIRE(make_decoder(data)(packed{decoded}));
+    CHECK_EQ(decoded, strings);
+
+    // A shared item is a view into the table
+    std::vector<std::string_view> views;
+    REQUIRE(make_decoder(data)(packed{views}));
+    CHECK_EQ(views[0].data(), views[1].data());
+}
+
+TEST_CASE("packed references past the first sixteen") {
+    std::vector<std::string> strings;
+    for (int round = 0; round < 4; ++round) {
+        for (char c = 'a'; c < 'a' + 20; ++c) {
+            strings.push_back(std::string(10, c));
+        }
+    }
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(packed{strings}));
+    // Items 16 and 17 are 6(0) and 6(-1)
+    const auto hex = to_hex(data);
+    CHECK_NE(hex.find("c600"), std::string::npos);
+    CHECK_NE(hex.find("c620"), std::string::npos);
+
+    std::vector<std::string> decoded;
+    REQUIRE(make_decoder(data)(packed{decoded}));
+    CHECK_EQ(decoded, strings);
+}
+
+TEST_CASE("packed argument prefixes") {
+    std::vector<std::string> urls{"https://example.com/a", "https://example.com/b", "https://example.com/c"};
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(packed{urls}));
+    CHECK_EQ(to_hex(data), "d871"
+                           "83"
+                           "80"
+                           "81" "7468747470733a2f2f6578616d706c652e636f6d2f"
+                           "83" "d8e06161" "d8e06162" "d8e06163");
+
+    std::vector<std::string> decoded;
+    REQUIRE(make_decoder(data)(packed{decoded}));
+    CHECK_EQ(decoded, urls);
+
+    // The argument and the rest are not adjacent, a view cannot hold them
+    std::vector<std::string_view> views;
+    CHECK_EQ(make_decoder(data)(packed{views}).error(), status_code::invalid_tag_value);
+}
+
+TEST_CASE("packed text and byte strings are shared apart") {
+    const std::vector<std::byte> bytes{std::byte{'a'}, std::byte{'b'}, std::byte{'c'}, std::byte{'d'}};
+    auto values = std::make_tuple(std::string("abcd"), bytes, std::string("abcd"), bytes, std::string("abcd"), bytes);
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(packed{values}));
+
+    auto decoded = std::make_tuple(std::string{}, std::vector<std::byte>{}, std::string{}, std::vector<std::byte>{}, std::string{},
+                                   std::vector<std::byte>{});
+    REQUIRE(make_decoder(data)(packed{decoded}));
+    CHECK(decoded == values);
+}
+
+TEST_CASE("packed telemetry batch") {
+    std::vector<Reading> batch;
+    for (std::uint64_t i = 0; i < 500; ++i) {
+        batch.push_back({.device = "sensor-" + std::to_string(i % 8),
+                         .metric = i % 2 == 0 ? "temperature" : "humidity",
+                         .unit   = i % 2 == 0 ? "celsius" : "percent",
+                         .value  = static_cast<double>(i) / 4,
+                         .source = "coap://gateway.site-3.example.net/readings/" + std::to_string(i)});
+    }
+
+    std::vector<std::byte> plain;
+    REQUIRE(make_encoder(plain)(batch));
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(packed{batch}));
+    CHECK_LT(data.size() * 2, plain.size());
+
+    std::vector<Reading> decoded;
+    REQUIRE(make_decoder(data)(packed{decoded}));
+    REQUIRE_EQ(decoded.size(), batch.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        CAPTURE(i);
+        CHECK_EQ(decoded[i].device, batch[i].device);
+        CHECK_EQ(decoded[i].metric, batch[i].metric);
+        CHECK_EQ(decoded[i].unit, batch[i].unit);
+        CHECK_EQ(decoded[i].value, batch[i].value);
+        CHECK_EQ(decoded[i].source, batch[i].source);
+    }
+}
+
+TEST_CASE("packed errors") {
+    std::vector<std::string> decoded;
+
+    auto out_of_range = to_bytes("d871" "83" "80" "80" "81" "e0");
+    CHECK_EQ(make_decoder(out_of_range)(packed{decoded}).error(), status_code::invalid_tag_value);
+
+    auto wrong_type = to_bytes("d871" "83" "81" "43616263" "80" "81" "e0");
+    CHECK_EQ(make_decoder(wrong_type)(packed{decoded}).error(), status_code::invalid_major_type_for_text_string);
+
+    auto not_packed = to_bytes("d872" "83" "80" "80" "80");
+    CHECK_EQ(make_decoder(not_packed)(packed{decoded}).error(), status_code::invalid_tag_value);
+
+    auto short_setup = to_bytes("d871" "82" "80" "80");
+    CHECK_EQ(make_decoder(short_setup)(packed{decoded}).error(), status_code::invalid_container_size);
+
+    // References outside of packed CBOR are just simple values
+    auto outside = to_bytes("81" "e0");
+    CHECK_EQ(make_decoder(outside)(decoded).error(), status_code::invalid_major_type_for_text_string);
+}
@@ -0,0 +1,129 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "cbor_tags/extensions/cbor_patch.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace cbor::tags;
+using namespace std::string_view_literals;
+
+namespace {
+cbor_path parsed(std::string_view text) {
+    auto path = cbor_path::parse(text);
+    REQUIRE(path);
+    return std::move(*path);
+}
+
+template <typename T> std::string hex_of(const T &buffer) { return to_hex(std::vector<std::byte>(buffer.begin(), buffer.end())); }
+
+// {"users": [{"name": "ann", "id": 1}, {"name": "bob", "id": 2}, {"name": "cy", "id": 3}, {"name": "dee", "id": 4}], "count": 4}
+constexpr auto users = "a265757365727384a2646e616d6563616e6e62696401a2646e616d6563626f6262696402a2646e616d6562637962696403a2646e616d65"
+                       "636465656269640465636f756e7404"sv;
+} // namespace
+
+TEST_CASE_TEMPLATE("Patch replaces the item at a path", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const auto bytes = to_bytes(users);
+    T          buffer(bytes.begin(), bytes.end());
+
+    // Same length, written over the old item
+    CHECK_EQ(*patch(buffer, parsed("/users/1/id"), 7), item_range{35, 1});
+    CHECK_EQ(buffer.size(), bytes.size());
+    CHECK_EQ(static_cast<int>(buffer[35]), 7);
+
+    // Longer, the tail moves and no head above changes
+    CHECK_EQ(*patch(buffer, parsed("/users/0/name"), std::string("annabel")), item_range{14, 8});
+    CHECK_EQ(hex_of(buffer), "a265757365727384a2646e616d6567616e6e6162656c62696401a2646e616d6563626f6262696407a2646e616d6562637962696403"
+                             "a2646e616d65636465656269640465636f756e7404");
+
+    // And back to shorter
+    REQUIRE(patch(buffer, parsed("/users/0/name"), std::string("ann")));
+    REQUIRE(patch(buffer, parsed("/users/1/id"), 2));
+    CHECK_EQ(hex_of(buffer), to_hex(bytes));
+
+    // A whole subtree
+    REQUIRE(patch(buffer, parsed("/users"), std::vector<int>{}));
+    CHECK_EQ(hex_of(buffer), "a26575736572738065636f756e7404");
+}
+
+TEST_CASE("Patch adds missing map keys") {
+    auto buffer = to_bytes("a1616101");
+    CHECK_EQ(*patch(buffer, parsed("/b"), 2), item_range{6, 1});
+    CHECK_EQ(to_hex(buffer), "a2616101616202");
+
+    // Digits are added as an integer key
+    CHECK_EQ(*patch(buffer, parsed("/-3"), true), item_range{8, 1});
+    CHECK_EQ(to_hex(buffer), "a361610161620222f5");
+
+    // Before the break of an indefinite map, without touching its head
+    auto indefinite = to_bytes("bf616101ff");
+    CHECK_EQ(*patch(indefinite, parsed("/b"), 2), item_range{6, 1});
+    CHECK_EQ(to_hex(indefinite), "bf616101616202ff");
+
+    // The head of a map with 23 pairs grows by a byte when the 24th is added
+    std::map<int, int> pairs;
+    for (int i = 0; i < 23; ++i) {
+        pairs[i] = i;
+    }
+    std::vector<std::byte> map_buffer;
+    auto                   enc = make_encoder(map_buffer);
+    REQUIRE(enc(pairs));
+    CHECK_EQ(static_cast<int>(map_buffer[0]), 0xb7);
+    const auto added = patch(map_buffer, parsed("/100"), 5);
+    REQUIRE(added);
+    CHECK_EQ(added->offset + added->size, map_buffer.size());
+    CHECK_EQ(to_hex(std::span(map_buffer).first(2)), "b818");
+
+    std::map<int, int> decoded;
+    auto               dec = make_decoder(map_buffer);
+    REQUIRE(dec(decoded));
+    CHECK_EQ(decoded.size(), 24);
+    CHECK_EQ(decoded[100], 5);
+}
+
+TEST_CASE("Patch through tags and in fixed size buffers") {
+    // 18([h'a10126', {4: h'6b6964', -1: "x"}, h'7061796c6f6164'])
+    auto cose = to_bytes("d28343a10126a204436b6964206178477061796c6f6164");
+    REQUIRE(patch(cose, parsed("/1/4"), std::vector<std::byte>{std::byte{'k'}, std::byte{'i'}, std::byte{'d'}, std::byte{'2'}}));
+    REQUIRE(patch(cose, parsed("/1/3"), 0));
+    CHECK_EQ(to_hex(cose), "d28343a10126a304446b6964322061780300477061796c6f6164");
+
+    auto                 bytes = to_bytes(users);
+    std::span<std::byte> fixed(bytes);
+    CHECK(patch(fixed, parsed("/count"), 9));
+    CHECK_EQ(static_cast<int>(bytes.back()), 9);
+    CHECK_EQ(patch(fixed, parsed("/count"), 900).error(), status_code::buffer_overflow);
+    CHECK_EQ(patch(fixed, parsed("/total"), 1).error(), status_code::buffer_overflow);
+    CHECK_EQ(static_cast<int>(bytes.back()), 9);
+}
+
+TEST_CASE("Patch errors") {
+    auto       buffer = to_bytes(users);
+    const auto before = to_hex(buffer);
+    CHECK_EQ(patch(buffer, parsed("/users/*/id"), 0).error(), status_code::invalid_path);
+    CHECK_EQ(patch(buffer, parsed("/users/9"), 0).error(), status_code::not_found);      // Arrays only take replacements
+    CHECK_EQ(patch(buffer, parsed("/users/9/id"), 0).error(), status_code::not_found);   // No parent
+    CHECK_EQ(patch(buffer, parsed("/count/x"), 0).error(), status_code::not_found);      // The parent is not a map
+    CHECK_EQ(to_hex(buffer), before);
+
+    // The replacement has to be exactly one item
+    CHECK_EQ(patch_encoded(buffer, parsed("/count"), {}).error(), status_code::malformed);
+    CHECK_EQ(patch_encoded(buffer, parsed("/count"), to_bytes("6261")).error(), status_code::malformed);
+    CHECK_EQ(patch_encoded(buffer, parsed("/count"), to_bytes("0102")).error(), status_code::malformed);
+    CHECK_EQ(patch_encoded(buffer, parsed("/total"), to_bytes("ff")).error(), status_code::malformed);
+    CHECK_EQ(to_hex(buffer), before);
+    CHECK_EQ(*patch_encoded(buffer, parsed("/count"), to_bytes("8101")), item_range{69, 2});
+
+    auto truncated = to_bytes("a261618201026162656162");
+    CHECK_EQ(patch(truncated, parsed("/c"), 0).error(), status_code::incomplete);
+    CHECK_EQ(to_hex(truncated), "a261618201026162656162");
+}
@@ -0,0 +1,208 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/extensions/cbor_query.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace cbor::tags;
+using namespace std::string_view_literals;
+
+namespace {
+cbor_path parsed(std::string_view text) {
+    auto path = cbor_path::parse(text);
+    REQUIRE(path);
+    return std::move(*path);
+}
+
+// {"users": [{"name": "ann", "id": 1}, {"name": "bob", "id": 2}, {"name": "cy", "id": 3}, {"name": "dee", "id": 4}], "count": 4}
+constexpr auto users = "a265757365727384a2646e616d6563616e6e62696401a2646e616d6563626f6262696402a2646e616d6562637962696403a2646e616d65"
+                       "636465656269640465636f756e7404"sv;
+} // namespace
+
+TEST_CASE_TEMPLATE("Query paths select items without decoding", T, std::vector<std::byte>, std::deque<std::byte>) {
+    const auto bytes = to_bytes(users);
+    const T    buffer(bytes.begin(), bytes.end());
+
+    const auto name = query_range(buffer, parsed("/users/2/name"));
+    REQUIRE(name);
+    CHECK_EQ(to_hex(std::vector<std::byte>(bytes.begin() + name->offset, bytes.begin() + name->offset + name->size)), "626379");
+
+    CHECK_EQ(*query_range(buffer, parsed("/count")), item_range{bytes.size() - 1, 1});
+    CHECK_EQ(*query_range(buffer, parsed("")), item_range{0, bytes.size()});
+
+    std::vector<std::string> names;
+    const auto               matches = query_each(buffer, parsed("/users/*/name"), [&](item_range range) {
+        names.push_back(to_hex(std::vector<std::byte>(bytes.begin() + range.offset, bytes.begin() + range.offset + range.size)));
+    });
+    REQUIRE(matches);
+    CHECK_EQ(*matches, 4);
+    CHECK_EQ(names, std::vector<std::string>{"63616e6e", "63626f62", "626379", "63646565"});
+
+    // Returning false stops at the first match
+    std::size_t calls = 0;
+    CHECK_EQ(*query_each(buffer, parsed("/users/*/id"), [&](item_range) { return ++calls == 2 ? false : true; }), 2);
+    CHECK_EQ(calls, 2);
+
+    CHECK_EQ(query_range(buffer, parsed("/users/4/name")).error(), status_code::not_found);
+    CHECK_EQ(query_range(buffer, parsed("/count/0")).error(), status_code::not_found);
+    CHECK_EQ(*query_each(buffer, parsed("/*/*/missing"), [](item_range) {}), 0);
+}
+
+TEST_CASE("Query spans and typed decoding") {
+    const auto buffer = to_bytes(users);
+
+    const auto span = query(buffer, parsed("/users/1"));
+    REQUIRE(span);
+    CHECK_EQ(to_hex(*span), "a2646e616d6563626f6262696402");
+    CHECK_EQ(span->data(), buffer.data() + 22);
+
+    std::string_view name;
+    REQUIRE(query_decode(buffer, parsed("/users/3/name"), name));
+    CHECK_EQ(name, "dee");
+    CHECK_EQ(name.data(), reinterpret_cast<const char *>(buffer.data()) + 56);
+
+    int count{};
+    REQUIRE(query_decode(buffer, parsed("/count"), count));
+    CHECK_EQ(count, 4);
+
+    std::string wrong;
+    CHECK_EQ(query_decode(buffer, parsed("/count"), wrong).error(), status_code::invalid_major_type_for_text_string);
+    CHECK_EQ(query_decode(buffer, parsed("/size"), count).error(), status_code::not_found);
+}
+
+TEST_CASE("Query keys, escapes, tags and indefinite lengths") {
+    // 18([h'a10126', {4: h'6b6964', -1: "x"}, h'7061796c6f6164'])
+    const auto cose = to_bytes("d28343a10126a204436b6964206178477061796c6f6164");
+    CHECK_EQ(to_hex(*query(cose, parsed("/1/4"))), "436b6964");
+    CHECK_EQ(to_hex(*query(cose, parsed("/1/-1"))), "6178");
+    CHECK_EQ(to_hex(*query(cose, parsed(""))), to_hex(cose)); // The tag stays on the selected item
+    CHECK_EQ(query(cose, parsed("/1/-2")).error(), status_code::not_found);
+    CHECK_EQ(query(cose, parsed("/1/04")).error(), status_code::not_found); // Only a text key "04"
+
+    // {_ "a": [_ 1, 1(2), 3], "a/b": {"~": true}, "3": "text three", 3: "int three"}
+    const auto doc = to_bytes("bf61619f01c10203ff63612f62a1617ef561336a746578742074687265650369696e74207468726565ff");
+    CHECK_EQ(to_hex(*query(doc, parsed("/a/1"))), "c102");
+    CHECK_EQ(to_hex(*query(doc, parsed("/a/2"))), "03");
+    CHECK_EQ(to_hex(*query(doc, parsed("/a~1b/~0"))), "f5");
+    CHECK_EQ(to_hex(*query(doc, parsed("/3"))), "6a74657874207468726565"); // The first key that is 3 or "3"
+    CHECK_EQ(*query_each(doc, parsed("/3"), [](item_range) {}), 1);
+    CHECK_EQ(*query_each(doc, parsed("/*"), [](item_range) {}), 4);
+
+    // An indefinite length text key, "a" then "b"
+    const auto chunked = to_bytes("a17f61616162ff01");
+    CHECK_EQ(to_hex(*query(chunked, parsed("/ab"))), "01");
+    CHECK_EQ(query(chunked, parsed("/a")).error(), status_code::not_found);
+}
+
+TEST_CASE("Query reads only what it needs") {
+    // {"a": [1, 2], "b": "ab" cut short of the five bytes it announces}
+    const auto truncated = to_bytes("a261618201026162656162");
+    CHECK_EQ(to_hex(*query(truncated, parsed("/a/1"))), "02");
+    CHECK_EQ(query(truncated, parsed("/b")).error(), status_code::incomplete);
+    CHECK_EQ(query_each(truncated, parsed("/*"), [](item_range) {}).error(), status_code::incomplete);
+
+    CHECK_EQ(query(to_bytes("a1ff01"), parsed("/x")).error(), status_code::malformed);
+
+    std::vector<std::byte> deep(300, std::byte{0x81});
+    deep.push_back(std::byte{0x00});
+    CHECK_EQ(query(deep, parsed("/0/0")).error(), status_code::nesting_too_deep);
+}
+
+TEST_CASE("Query path syntax") {
+    CHECK(cbor_path::parse(""));
+    CHECK(cbor_path::parse("/"));
+    CHECK_EQ(cbor_path::parse("/a/*/b")->steps().size(), 3);
+    CHECK_EQ(cbor_path::parse("users").error(), status_code::invalid_path);
+    CHECK_EQ(cbor_path::parse("/a~2").error(), status_code::invalid_path);
+    CHECK_EQ(cbor_path::parse("/a~").error(), status_code::invalid_path);
+
+    const auto path = parsed("/~01/-3/18446744073709551615/99999999999999999999");
+    CHECK_EQ(path.key(path.steps()[0]), "~1");
+    CHECK(path.steps()[1].integer);
+    CHECK(path.steps()[1].negative);
+    CHECK_EQ(path.steps()[1].argument, 2);
+    CHECK_EQ(path.steps()[2].argument, 18446744073709551615ULL);
+    CHECK_FALSE(path.steps()[3].integer); // Too large, only a text key
+}
+
+namespace {
+struct user_fields {
+    path<"/users/2/name", std::string_view> third_name;
+    path<"/users/0/id", int>                first_id;
+    path<"/count", std::uint64_t>           count;
+    path<"/users/3", item_range>            last_user;
+    path<"/users/0/email", std::string>     email;
+};
+
+struct cose_fields {
+    path<"/0", std::vector<std::byte>>   protected_header;
+    path<"/1/4", std::vector<std::byte>> kid;
+    path<"/1/-1", std::string_view>      x;
+    path<"/1", item_range>               unprotected;
+};
+
+struct range_fields {
+    path<"/users/1/name", item_range> name;
+    path<"/count", item_range>        count;
+};
+} // namespace
+
+TEST_CASE("Extract several paths in one walk") {
+    const auto buffer = to_bytes(users);
+
+    user_fields fields;
+    fields.email = {.value = "stale", .found = true};
+    const auto  found = extract(buffer, fields);
+    REQUIRE(found);
+    CHECK_EQ(*found, 4);
+    CHECK(fields.third_name.found);
+    CHECK_EQ(fields.third_name.value, "cy");
+    CHECK_EQ(fields.first_id.value, 1);
+    CHECK_EQ(fields.count.value, 4);
+    CHECK_EQ(fields.last_user.value, item_range{49, 14});
+    CHECK_FALSE(fields.email.found);
+
+    // Paths sharing a prefix, a path ending inside another's item and integer keys
+    const auto  cose = to_bytes("d28343a10126a204436b6964206178477061796c6f6164");
+    cose_fields header;
+    REQUIRE_EQ(*extract(cose, header), 4);
+    CHECK_EQ(to_hex(header.protected_header.value), "a10126");
+    CHECK_EQ(to_hex(header.kid.value), "6b6964");
+    CHECK_EQ(header.x.value, "x");
+    CHECK_EQ(header.unprotected.value, item_range{6, 9});
+
+    struct wrong_type {
+        path<"/count", std::string_view> count;
+    } mistyped;
+    CHECK_EQ(extract(buffer, mistyped).error(), status_code::invalid_major_type_for_text_string);
+}
+
+TEST_CASE_TEMPLATE("Extract stops once every path is resolved", T, std::vector<std::byte>, std::deque<std::byte>) {
+    // {"a": [1, 2], "b": "ab" cut short of the five bytes it announces}
+    const auto   bytes = to_bytes("a261618201026162656162");
+    const T      truncated(bytes.begin(), bytes.end());
+    range_fields missing;
+    CHECK_EQ(extract(truncated, missing).error(), status_code::incomplete);
+
+    struct {
+        path<"/a/1", item_range> second;
+        path<"/a/5", item_range> out_of_range;
+        path<"/a/x", item_range> keyed;
+    } early;
+    REQUIRE_EQ(*extract(truncated, early), 1);
+    CHECK_EQ(early.second.value, item_range{5, 1});
+    CHECK_FALSE(early.out_of_range.found);
+
+    const auto users_bytes = to_bytes(users);
+    const T    buffer(users_bytes.begin(), users_bytes.end());
+    range_fields fields;
+    REQUIRE_EQ(*extract(buffer, fields), 2);
+    CHECK_EQ(fields.name.value, item_range{28, 4});
+    CHECK_EQ(fields.count.value, item_range{users_bytes.size() - 1, 1});
+}
@@ -0,0 +1,121 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace cbor::tags;
+using namespace std::string_view_literals;
+
+namespace {
+struct Payload {
+    static constexpr std::uint64_t cbor_tag = 140;
+    std::string                    name;
+    std::vector<double>            values;
+    std::map<std::uint64_t, bool>  flags;
+};
+
+struct Envelope {
+    std::uint64_t    route;
+    std::string_view destination;
+    Payload          payload;
+};
+
+struct RawEnvelope {
+    std::uint64_t    route;
+    std::string_view destination;
+    raw_cbor         payload;
+};
+} // namespace
+
+TEST_CASE("raw_cbor forwards a payload untouched") {
+    std::vector<std::byte> original;
+    auto                   enc = make_encoder(original);
+    REQUIRE(enc(Envelope{.route = 7, .destination = "node-b", .payload = {"sensor", {1.5, -2.0}, {{1, true}, {2, false}}}}));
+
+    RawEnvelope envelope{};
+    auto        dec = make_decoder(original);
+    REQUIRE(dec(envelope));
+    CHECK_EQ(envelope.route, 7);
+    CHECK_EQ(envelope.destination, "node-b"sv);
+
+    // The captured bytes are exactly the payload's encoding, pointing into the original buffer
+    std::vector<std::byte> payload_only;
+    REQUIRE(make_encoder(payload_only)(Payload{"sensor", {1.5, -2.0}, {{1, true}, {2, false}}}));
+    CHECK_EQ(to_hex(envelope.payload.data), to_hex(payload_only));
+    CHECK_EQ(envelope.payload.data.data() + envelope.payload.data.size(), original.data() + original.size());
+
+    std::vector<std::byte> forwarded;
+    REQUIRE(make_encoder(forwarded)(envelope));
+    CHECK_EQ(to_hex(forwarded), to_hex(original));
+
+    // And the payload still decodes later
+    Payload payload;
+    auto    payload_bytes = envelope.payload.data;
+    REQUIRE(make_decoder(payload_bytes)(payload));
+    CHECK_EQ(payload.name, "sensor");
+    CHECK_EQ(payload.flags.at(2), false);
+}
+
+TEST_CASE("raw_cbor skips every major type") {
+    const std::vector<std::string_view> items{
+        "17",                         // 23
+        "1b0102030405060708",         // uint64
+        "3903e7",                     // -1000
+        "4401020304",                 // bstr
+        "6568656c6c6f",               // "hello"
+        "5f42010243030405ff",         // indefinite bstr
+        "7f6161ff",                   // indefinite tstr
+        "83018202039f0405ff",         // [1, [2, 3], [_ 4, 5]]
+        "9f018202039fffff",           // [_ 1, [2, 3], [_ ]]
+        "a201a10203188282f5f4",       // {1: {2: 3}, 130: [true, false]}
+        "bf61619f01ff6162a0ff",       // {_ "a": [_ 1], "b": {}}
+        "c11a5f5e1000",               // 1(epoch)
+        "d818c2c3420102",             // 24(2(3(h'0102')))
+        "f93c00",                     // float16
+        "fa47c35000",                 // float
+        "fb3ff199999999999a",         // double
+        "f820",                       // simple(32)
+        "f6",                         // null
+    };
+
+    for (auto hex : items) {
+        CAPTURE(hex);
+        auto bytes = to_bytes(std::string(hex) + "05");
+
+        raw_cbor      raw{};
+        std::uint64_t next{};
+        auto          dec = make_decoder(bytes);
+        REQUIRE(dec(raw, next));
+        CHECK_EQ(to_hex(raw.data), hex);
+        CHECK_EQ(next, 5);
+    }
+}
+
+TEST_CASE("raw_cbor rejects malformed items") {
+    for (auto hex : {"ff"sv, "8201"sv, "9f01"sv, "5f4101"sv, "1c"sv, "c1"sv, "62ff"sv}) {
+        CAPTURE(hex);
+        auto     bytes = to_bytes(hex);
+        raw_cbor raw{};
+        auto     dec = make_decoder(bytes);
+        CHECK_FALSE(dec(raw));
+    }
+}
+
+TEST_CASE("raw_cbor deep nesting does not recurse") {
+    constexpr std::size_t  depth = 100000;
+    std::vector<std::byte> bytes(depth, std::byte{0x81});
+    bytes.push_back(std::byte{0x00});
+
+    raw_cbor raw{};
+    auto     dec = make_decoder(bytes);
+    REQUIRE(dec(raw));
+    CHECK_EQ(raw.data.size(), depth + 1);
+}
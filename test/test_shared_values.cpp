@@ -0,0 +1,186 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_embedded.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <doctest/doctest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace cbor::tags;
+
+namespace {
+struct Settings {
+    std::string         profile;
+    std::vector<double> weights;
+};
+
+struct Node {
+    std::string               name;
+    std::shared_ptr<Settings> settings;
+};
+
+struct Link {
+    std::uint64_t         value;
+    std::shared_ptr<Link> next;
+};
+
+struct Pair {
+    std::shared_ptr<std::string> first;
+    std::shared_ptr<std::string> second;
+};
+} // namespace
+
+TEST_CASE_TEMPLATE("shared values are encoded once", T, std::vector<std::byte>, std::deque<std::byte>) {
+    auto common = std::make_shared<Settings>(Settings{"common", std::vector<double>(100, 0.5)});
+    auto own    = std::make_shared<Settings>(Settings{"own", {1.0}});
+
+    std::vector<Node> nodes{{"a", common}, {"b", common}, {"c", own}, {"d", nullptr}, {"e", common}};
+
+    T data;
+    REQUIRE(make_encoder(data)(nodes));
+
+    // The common settings once, behind tag 28, then two references to number 0. The settings held only here carry no tag.
+    std::vector<std::byte> single;
+    REQUIRE(make_encoder(single)(*common));
+    CHECK_LT(data.size(), 2 * single.size());
+    const auto hex = to_hex(data);
+    CHECK_NE(hex.find("d81c" + to_hex(single)), std::string::npos);
+    CHECK_NE(hex.find("6162d81d00"), std::string::npos);
+    CHECK_NE(hex.find("6165d81d00"), std::string::npos);
+    CHECK_NE(hex.find("6164f6"), std::string::npos);
+
+    std::vector<Node> decoded;
+    REQUIRE(make_decoder(data)(decoded));
+    REQUIRE_EQ(decoded.size(), 5);
+    REQUIRE(decoded[0].settings);
+    CHECK_EQ(decoded[0].settings->profile, "common");
+    CHECK_EQ(decoded[0].settings->weights.size(), 100);
+    CHECK_EQ(decoded[0].settings.get(), decoded[1].settings.get());
+    CHECK_EQ(decoded[0].settings.get(), decoded[4].settings.get());
+    CHECK_EQ(decoded[0].settings.use_count(), 3);
+    REQUIRE(decoded[2].settings);
+    CHECK_NE(decoded[2].settings.get(), decoded[0].settings.get());
+    CHECK_EQ(decoded[2].settings->profile, "own");
+    CHECK_FALSE(decoded[3].settings);
+}
+
+TEST_CASE("shared values are numbered per call") {
+    auto text = std::make_shared<std::string>("repeated");
+
+    std::vector<std::byte> data;
+    auto                   enc = make_encoder(data);
+    REQUIRE(enc(Pair{text, text}));
+    REQUIRE(enc(Pair{text, text}));
+    CHECK_EQ(to_hex(data), "82d81c687265706561746564d81d00"
+                           "82d81c687265706561746564d81d00");
+
+    auto dec = make_decoder(data);
+    Pair first;
+    Pair second;
+    REQUIRE(dec(first));
+    REQUIRE(dec(second));
+    CHECK_EQ(first.first.get(), first.second.get());
+    CHECK_EQ(second.first.get(), second.second.get());
+    CHECK_NE(first.first.get(), second.first.get());
+    CHECK_EQ(*second.second, "repeated");
+}
+
+TEST_CASE("shared values with cycles") {
+    auto head  = std::make_shared<Link>(Link{1, nullptr});
+    head->next = std::make_shared<Link>(Link{2, head});
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(head));
+    CHECK_EQ(to_hex(data), "d81c" "8201" "82" "02" "d81d00");
+    head->next.reset();
+
+    std::shared_ptr<Link> decoded;
+    REQUIRE(make_decoder(data)(decoded));
+    REQUIRE(decoded);
+    REQUIRE(decoded->next);
+    CHECK_EQ(decoded->value, 1);
+    CHECK_EQ(decoded->next->value, 2);
+    CHECK_EQ(decoded->next->next.get(), decoded.get());
+    decoded->next.reset();
+}
+
+TEST_CASE_TEMPLATE("shared value tags in wider heads", T, std::vector<std::byte>, std::deque<std::byte>) {
+    // Tags 28 and 29 with two and four byte heads
+    const auto bytes = to_bytes("82" "d9001c6161" "da0000001d00");
+    T          data(bytes.begin(), bytes.end());
+    Pair       pair;
+    REQUIRE(make_decoder(data)(pair));
+    REQUIRE(pair.first);
+    CHECK_EQ(*pair.first, "a");
+    CHECK_EQ(pair.first.get(), pair.second.get());
+
+    // Any other tag in a wide head is left to the pointee
+    using tagged     = std::pair<static_tag<511>, std::uint64_t>;
+    const auto other = to_bytes("d901ff07");
+    T          other_data(other.begin(), other.end());
+    std::shared_ptr<tagged> value;
+    REQUIRE(make_decoder(other_data)(value));
+    REQUIRE(value);
+    CHECK_EQ(value->second, 7);
+}
+
+TEST_CASE("shared values inside skipped and embedded items") {
+    auto text = std::make_shared<std::string>("inner");
+
+    // Skipping a shareable value still numbers it, the reference after it is to the second one
+    struct Skipping {
+        raw_cbor                     skipped;
+        std::shared_ptr<std::string> second;
+        std::shared_ptr<std::string> again;
+    };
+    auto     bytes = to_bytes("83" "d81c6161" "d81c6162" "d81d01");
+    Skipping skipping{};
+    REQUIRE(make_decoder(bytes)(skipping));
+    CHECK_EQ(to_hex(skipping.skipped.data), "d81c6161");
+    CHECK_EQ(skipping.second.get(), skipping.again.get());
+
+    // A reference to a value that was only skipped cannot be resolved
+    auto unresolved = to_bytes("83" "d81c6161" "d81d00" "d81d00");
+    CHECK_EQ(make_decoder(unresolved)(skipping).error(), status_code::invalid_tag_value);
+
+    // Embedded content is numbered apart from the item holding it
+    struct Holder {
+        std::shared_ptr<std::string> outer;
+        embedded<Pair>               inner;
+        std::shared_ptr<std::string> again;
+    };
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(Holder{text, Pair{text, text}, text}));
+    Holder holder;
+    REQUIRE(make_decoder(data)(holder));
+    CHECK_EQ(holder.outer.get(), holder.again.get());
+    auto pair = holder.inner.get();
+    REQUIRE(pair);
+    CHECK_EQ((*pair)->first.get(), (*pair)->second.get());
+    CHECK_EQ(*(*pair)->first, "inner");
+}
+
+TEST_CASE("shared value errors") {
+    Pair pair;
+
+    auto out_of_range = to_bytes("82" "d81c6161" "d81d01");
+    CHECK_EQ(make_decoder(out_of_range)(pair).error(), status_code::invalid_tag_value);
+
+    auto not_an_index = to_bytes("82" "d81c6161" "d81d6161");
+    CHECK_EQ(make_decoder(not_an_index)(pair).error(), status_code::invalid_major_type_for_unsigned_integer);
+
+    // The shared value was decoded as a string, it cannot be referred to as a number
+    struct Mixed {
+        std::shared_ptr<std::string>   text;
+        std::shared_ptr<std::uint64_t> number;
+    };
+    Mixed mixed;
+    auto  wrong_type = to_bytes("82" "d81c6161" "d81d00");
+    CHECK_EQ(make_decoder(wrong_type)(mixed).error(), status_code::invalid_tag_value);
+}
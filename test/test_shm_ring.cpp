@@ -0,0 +1,178 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/extensions/cbor_shm.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace cbor::tags;
+using namespace std::string_view_literals;
+
+namespace {
+struct Tick {
+    std::uint64_t              sequence;
+    std::string_view           symbol;
+    double                     price;
+    std::span<const std::byte> extra;
+};
+} // namespace
+
+TEST_CASE("Shared memory ring send and receive in place") {
+    auto ring = shm_ring::create(128, 4);
+    CHECK_EQ(ring.slot_size(), 128);
+    CHECK_EQ(ring.slot_count(), 4);
+
+    const std::vector<std::byte> extra{std::byte{1}, std::byte{2}, std::byte{3}};
+    REQUIRE(ring.try_send(Tick{1, "ABC", 10.5, extra}));
+    REQUIRE(ring.try_send(Tick{2, "DEFG", 11.25, {}}));
+
+    auto msg = ring.try_receive();
+    REQUIRE(msg);
+    Tick tick{};
+    REQUIRE(msg->decode(tick));
+    CHECK_EQ(tick.sequence, 1);
+    CHECK_EQ(tick.symbol, "ABC"sv);
+    CHECK_EQ(tick.price, 10.5);
+    REQUIRE_EQ(tick.extra.size(), 3);
+    CHECK_EQ(tick.extra[2], std::byte{3});
+
+    // Zero-copy, the views point into the slot
+    const auto bytes = msg->bytes();
+    CHECK(tick.symbol.data() >= reinterpret_cast<const char *>(bytes.data()));
+    CHECK(tick.symbol.data() < reinterpret_cast<const char *>(bytes.data() + bytes.size()));
+    msg->release();
+
+    auto msg2 = ring.try_receive();
+    REQUIRE(msg2);
+    REQUIRE(msg2->decode(tick));
+    CHECK_EQ(tick.sequence, 2);
+    CHECK_EQ(tick.symbol, "DEFG"sv);
+
+    auto none = ring.try_receive();
+    REQUIRE_FALSE(none);
+    CHECK_EQ(none.error(), status_code::would_block);
+}
+
+TEST_CASE("Shared memory ring full and oversized messages") {
+    auto ring = shm_ring::create(16, 2);
+
+    // Too large for a slot, the slot is skipped by receivers
+    auto too_big = ring.try_send(std::string(32, 'x'));
+    REQUIRE_FALSE(too_big);
+    CHECK_EQ(too_big.error(), status_code::buffer_overflow);
+
+    REQUIRE(ring.try_send(std::uint64_t{7}));
+    auto full = ring.try_send(std::uint64_t{8});
+    REQUIRE_FALSE(full);
+    CHECK_EQ(full.error(), status_code::would_block);
+
+    {
+        auto msg = ring.try_receive();
+        REQUIRE(msg);
+        std::uint64_t value{};
+        REQUIRE(msg->decode(value));
+        CHECK_EQ(value, 7);
+
+        // The skipped slot was freed while receiving, the held one is not free until released
+        CHECK(ring.try_send(std::uint64_t{8}));
+        CHECK_FALSE(ring.try_send(std::uint64_t{9}));
+    }
+    REQUIRE(ring.try_send(std::uint64_t{9}));
+    CHECK_FALSE(ring.try_send(std::uint64_t{10}));
+}
+
+TEST_CASE("Shared memory ring across processes") {
+    constexpr std::uint64_t count = 1000;
+    auto                    ring  = shm_ring::create(64, 8);
+
+    const pid_t child = ::fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        auto producer = shm_ring::attach(ring.fd());
+        for (std::uint64_t i = 0; i < count; ++i) {
+            while (!producer.try_send(i, std::string_view("payload"))) {
+                ::usleep(10);
+            }
+        }
+        ::_exit(0);
+    }
+
+    std::uint64_t received = 0;
+    bool          in_order = true;
+    while (received < count) {
+        auto msg = ring.try_receive();
+        if (!msg) {
+            ::usleep(10);
+            continue;
+        }
+        std::uint64_t    value{};
+        std::string_view text;
+        REQUIRE(msg->decode(value, text));
+        in_order = in_order && value == received && text == "payload";
+        ++received;
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    CHECK(in_order);
+    CHECK(WIFEXITED(status));
+    CHECK_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST_CASE("Shared memory ring rejects a corrupt header") {
+    auto ring = shm_ring::create(64, 8);
+
+    // slot_count follows magic and slot_size in the header
+    const auto set_slot_count = [&](std::uint64_t count) { REQUIRE_EQ(::pwrite(ring.fd(), &count, sizeof(count), 16), sizeof(count)); };
+    set_slot_count(0);
+    CHECK_THROWS_AS(shm_ring::attach(ring.fd()), std::system_error);
+    set_slot_count(9);
+    CHECK_THROWS_AS(shm_ring::attach(ring.fd()), std::system_error);
+    set_slot_count(std::uint64_t{1} << 58); // Wraps to a small size when multiplied by the stride
+    CHECK_THROWS_AS(shm_ring::attach(ring.fd()), std::system_error);
+    set_slot_count(8);
+    auto peer = shm_ring::attach(ring.fd());
+    CHECK_EQ(peer.slot_count(), 8);
+
+    // Once mapped, the ring keeps the geometry it checked
+    set_slot_count(1000);
+    CHECK_EQ(peer.slot_count(), 8);
+    REQUIRE(peer.try_send(std::uint64_t{7}));
+    CHECK(peer.try_receive());
+}
+
+TEST_CASE("Shared memory ring rejects a slot size past the slot") {
+    auto ring = shm_ring::create(64, 2);
+    REQUIRE(ring.try_send(std::string_view{"first"}));
+    REQUIRE(ring.try_send(std::string_view{"second"}));
+
+    // A peer with its own mapping overwrites the size of the first slot, the word after its sequence number past the 192 byte header
+    const auto size = ::lseek(ring.fd(), 0, SEEK_END);
+    void      *peer = ::mmap(nullptr, static_cast<std::size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, ring.fd(), 0);
+    REQUIRE_NE(peer, MAP_FAILED);
+    const std::uint64_t huge = std::uint64_t{1} << 40;
+    std::memcpy(static_cast<std::byte *>(peer) + 192 + sizeof(std::uint64_t), &huge, sizeof(huge));
+    ::munmap(peer, static_cast<std::size_t>(size));
+
+    auto corrupt = ring.try_receive();
+    REQUIRE_FALSE(corrupt);
+    CHECK_EQ(corrupt.error(), status_code::malformed);
+
+    // The slot was released, the ring goes on with the next message and has room for two again
+    auto next = ring.try_receive();
+    REQUIRE(next);
+    std::string_view text;
+    REQUIRE(next->decode(text));
+    CHECK_EQ(text, "second");
+    next->release();
+    CHECK(ring.try_send(std::string_view{"third"}));
+    CHECK(ring.try_send(std::string_view{"fourth"}));
+}
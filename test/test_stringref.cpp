@@ -0,0 +1,203 @@
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_decoder.h"
+#include "cbor_tags/cbor_embedded.h"
+#include "cbor_tags/cbor_encoder.h"
+#include "test_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using namespace cbor::tags;
+using namespace std::string_view_literals;
+
+namespace {
+struct LogRecord {
+    std::string   host;
+    std::string   level;
+    std::string   message;
+    std::uint64_t timestamp;
+};
+
+struct LogRecordView {
+    std::string_view host;
+    std::string_view level;
+    std::string_view message;
+    std::uint64_t    timestamp;
+};
+
+struct Forwarded {
+    std::string host;
+    raw_cbor    payload;
+    std::string again;
+};
+} // namespace
+
+TEST_CASE("stringref encoding") {
+    std::vector<std::string> strings{"aaa", "aaa", "bb", "bb", "cccc", "cccc"};
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(stringref_namespace{strings}));
+    CHECK_EQ(to_hex(data), "d90100"
+                           "86"
+                           "63616161"
+                           "d81900"
+                           "626262"
+                           "626262"
+                           "6463636363"
+                           "d81901");
+
+    std::vector<std::string> decoded;
+    REQUIRE(make_decoder(data)(stringref_namespace{decoded}));
+    CHECK_EQ(decoded, strings);
+}
+
+TEST_CASE("stringref numbering thresholds") {
+    // The first 24 strings are numbered from 3 bytes, after that a 3 byte string is always repeated
+    std::vector<std::string> strings;
+    for (char c = 'a'; strings.size() < 24; ++c) {
+        strings.push_back(std::string(3, c));
+    }
+    strings.insert(strings.end(), {"zzz", "zzz", "yyyy", "yyyy", "aaa"});
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(stringref_namespace{strings}));
+    CHECK(to_hex(data).ends_with("637a7a7a"
+                                 "637a7a7a"
+                                 "6479797979"
+                                 "d8191818"
+                                 "d81900"));
+
+    std::vector<std::string> decoded;
+    REQUIRE(make_decoder(data)(stringref_namespace{decoded}));
+    CHECK_EQ(decoded, strings);
+}
+
+TEST_CASE("stringref text and byte strings are numbered apart") {
+    const std::vector<std::byte> bytes{std::byte{'a'}, std::byte{'b'}, std::byte{'c'}};
+    auto                         values = std::make_tuple(std::string("abc"), bytes, std::string("abc"), bytes);
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(stringref_namespace{values}));
+    CHECK_EQ(to_hex(data), "d90100"
+                           "84"
+                           "63616263"
+                           "43616263"
+                           "d81900"
+                           "d81901");
+
+    auto decoded = std::make_tuple(std::string{}, std::vector<std::byte>{}, std::string{}, std::vector<std::byte>{});
+    REQUIRE(make_decoder(data)(stringref_namespace{decoded}));
+    CHECK(decoded == values);
+}
+
+TEST_CASE("stringref log batch") {
+    std::vector<LogRecord> batch;
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        batch.push_back({.host      = "frontend-" + std::to_string(i % 4) + ".example.com",
+                         .level     = i % 10 == 0 ? "warning" : "info",
+                         .message   = i % 3 == 0 ? "request served" : "cache refreshed",
+                         .timestamp = 1700000000 + i});
+    }
+
+    std::vector<std::byte> plain;
+    REQUIRE(make_encoder(plain)(batch));
+    std::vector<std::byte> compressed;
+    REQUIRE(make_encoder(compressed)(stringref_namespace{batch}));
+    CHECK_LT(compressed.size() * 2, plain.size());
+
+    std::vector<LogRecord> decoded;
+    REQUIRE(make_decoder(compressed)(stringref_namespace{decoded}));
+    REQUIRE_EQ(decoded.size(), batch.size());
+    CHECK_EQ(decoded[199].host, batch[199].host);
+    CHECK_EQ(decoded[199].level, batch[199].level);
+    CHECK_EQ(decoded[199].message, batch[199].message);
+
+    // Views of referenced strings point at the first occurrence
+    std::vector<LogRecordView> views;
+    REQUIRE(make_decoder(compressed)(stringref_namespace{views}));
+    CHECK_EQ(views[4].host, "frontend-0.example.com"sv);
+    CHECK_EQ(views[4].host.data(), views[0].host.data());
+}
+
+TEST_CASE("stringref with raw items") {
+    struct Inner {
+        std::string first;
+        std::string second;
+    };
+    struct Outer {
+        std::string host;
+        Inner       payload;
+        std::string again;
+    };
+    Outer outer{.host = "gateway", .payload = {"shared", "gateway"}, .again = "shared"};
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(stringref_namespace{outer}));
+
+    // Skipping the payload still numbers "shared", so the reference after it resolves
+    Forwarded forwarded;
+    REQUIRE(make_decoder(data)(stringref_namespace{forwarded}));
+    CHECK_EQ(forwarded.host, "gateway");
+    CHECK_EQ(forwarded.again, "shared");
+
+    // Forwarding a raw item that holds no references gives it a namespace of its own
+    std::vector<std::byte> source;
+    REQUIRE(make_encoder(source)(Inner{"shared", "gateway"}));
+    auto source_view = std::span<const std::byte>(source);
+    forwarded.payload = raw_cbor{source_view};
+
+    std::vector<std::byte> reencoded;
+    REQUIRE(make_encoder(reencoded)(stringref_namespace{forwarded}));
+    Forwarded roundtrip;
+    REQUIRE(make_decoder(reencoded)(stringref_namespace{roundtrip}));
+    CHECK_EQ(roundtrip.host, "gateway");
+    CHECK_EQ(roundtrip.again, "shared");
+    CHECK_EQ(to_hex(roundtrip.payload.data), "d90100" + to_hex(source));
+}
+
+TEST_CASE("stringref with embedded items") {
+    struct Inner {
+        std::string first;
+        std::string second;
+    };
+    struct Env {
+        embedded<Inner> a;
+        embedded<Inner> b;
+    };
+
+    std::vector<std::byte> data;
+    REQUIRE(make_encoder(data)(Env{.a = Inner{"shared", "gateway"}, .b = Inner{"shared", "gateway"}}));
+    Env env;
+    REQUIRE(make_decoder(data)(env));
+
+    // Forwarded as is, the second payload is a byte string again rather than a reference to the first
+    std::vector<std::byte> reencoded;
+    REQUIRE(make_encoder(reencoded)(stringref_namespace{env}));
+    Env roundtrip;
+    REQUIRE(make_decoder(reencoded)(stringref_namespace{roundtrip}));
+    CHECK_EQ(to_hex(roundtrip.a.encoded()), to_hex(env.a.encoded()));
+    CHECK_EQ(to_hex(roundtrip.b.encoded()), to_hex(env.b.encoded()));
+    REQUIRE(roundtrip.b.get());
+    CHECK_EQ((*roundtrip.b.get())->second, "gateway");
+}
+
+TEST_CASE("stringref errors") {
+    std::vector<std::string> decoded;
+
+    auto out_of_range = to_bytes("d90100" "82" "63616161" "d81901");
+    CHECK_EQ(make_decoder(out_of_range)(stringref_namespace{decoded}).error(), status_code::invalid_tag_value);
+
+    // Not numbered, too short
+    auto too_short = to_bytes("d90100" "82" "626161" "d81900");
+    CHECK_EQ(make_decoder(too_short)(stringref_namespace{decoded}).error(), status_code::invalid_tag_value);
+
+    // References outside of a namespace are just tags
+    auto outside = to_bytes("82" "63616161" "d81900");
+    CHECK_EQ(make_decoder(outside)(decoded).error(), status_code::invalid_major_type_for_text_string);
+}
@@ -0,0 +1,525 @@
+#include "cbor_tags/extensions/cbor_cddl_schema.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Generates C++ types from a CDDL schema, one per type rule, laid out the way the encoder and decoder map types to CBOR:
+//
+//   name = [a: tstr, b: uint]      struct name { std::string a; std::uint64_t b; };
+//   name = #6.140([a: tstr, b])    struct name { static constexpr std::uint64_t cbor_tag = 140; std::string a; ... };
+//   name = #6.141(tstr)            struct name { static constexpr std::uint64_t cbor_tag = 141; std::string value; };
+//   name = [* int] / [int]         using name = std::vector<std::int64_t>;
+//   name = {* tstr => int}         using name = std::map<std::string, std::int64_t>;
+//   name = tstr / null             using name = std::optional<std::string>;
+//   name = int / tstr / bstr       using name = std::variant<std::int64_t, std::string, std::vector<std::byte>>;
+//
+// Arrays and tags nested in other types become structs named after the member, e.g owner_member. Maps with named members have no
+// aggregate form, they become a std::map from the key types to a variant of the value types. Ranges, literals and controls narrow
+// values the C++ types cannot express, the header keeps the schema text so cddl_schema can check them.
+//
+// Not supported: recursive rules, optional or repeated entries among the members of an array, choices between types the decoder
+// cannot tell apart, e.g two untagged arrays, and the any type inside a choice.
+
+using namespace cbor::tags;
+
+namespace {
+
+// A generated type with the major types it decodes from, so choices can be checked like the decoder checks its variants
+struct cpp_type {
+    std::string           name;
+    std::uint16_t         majors{};          // Bit per major type
+    bool                  numbered{};        // Tags and simple values, told apart by their number so they may share a major type
+    bool                  alternative{true}; // May be a variant alternative, untagged structs and raw_cbor have no major type there
+    std::vector<cpp_type> choices{};         // Alternatives of a variant or optional, so nested choices flatten
+};
+
+constexpr std::uint16_t major_bit(major_type major) { return static_cast<std::uint16_t>(1U << static_cast<unsigned>(major)); }
+
+const cpp_type uint_type{"std::uint64_t", major_bit(major_type::UnsignedInteger)};
+const cpp_type nint_type{"cbor::tags::negative", major_bit(major_type::NegativeInteger)};
+const cpp_type int_type{"std::int64_t", major_bit(major_type::UnsignedInteger) | major_bit(major_type::NegativeInteger)};
+const cpp_type bytes_type{"std::vector<std::byte>", major_bit(major_type::ByteString)};
+const cpp_type text_type{"std::string", major_bit(major_type::TextString)};
+const cpp_type bool_type{"bool", major_bit(major_type::Simple), true};
+const cpp_type null_type{"std::nullptr_t", major_bit(major_type::Simple), true};
+const cpp_type simple_type{"cbor::tags::simple", major_bit(major_type::Simple), true};
+const cpp_type float16_type{"cbor::tags::float16_t", major_bit(major_type::Simple), true};
+const cpp_type float32_type{"float", major_bit(major_type::Simple), true};
+const cpp_type float64_type{"double", major_bit(major_type::Simple), true};
+const cpp_type any_type{"cbor::tags::raw_cbor", 0xFF, false, false};
+
+bool is_integer(const cpp_type &type) { return type.name == uint_type.name || type.name == nint_type.name || type.name == int_type.name; }
+
+std::string identifier(std::string_view name) {
+    static constexpr std::string_view keywords[] = {
+        "and", "auto", "bool", "break", "case", "catch", "char", "class", "const", "continue", "default", "delete", "do", "double", "else",
+        "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable",
+        "namespace", "new", "not", "nullptr", "operator", "or", "private", "protected", "public", "register", "return", "short", "signed",
+        "sizeof", "static", "struct", "switch", "template", "this", "throw", "true", "try", "typedef", "typename", "union", "unsigned",
+        "using", "virtual", "void", "volatile", "while", "xor"};
+
+    std::string result;
+    for (const char c : name) {
+        result += std::isalnum(static_cast<unsigned char>(c)) || c == '_' ? c : '_';
+    }
+    if (result.empty() || std::isdigit(static_cast<unsigned char>(result.front()))) {
+        result.insert(0, "_");
+    }
+    if (std::ranges::find(keywords, result) != std::end(keywords)) {
+        result += '_';
+    }
+    return result;
+}
+
+class struct_generator {
+  public:
+    explicit struct_generator(std::string_view cddl) : cddl_(cddl), compiler_(tables_) {}
+
+    void generate(std::string_view name_space, std::string_view source, fmt::memory_buffer &out) {
+        // Compiling the schema first reports undefined names and unsupported syntax, the generator walks the unresolved tables
+        if (!cddl_schema::compile(cddl_)) {
+            throw std::runtime_error("invalid or unsupported CDDL");
+        }
+        if (cddl_.find(")cddl\"") != std::string_view::npos) {
+            throw std::runtime_error("the schema cannot be kept in a raw string literal");
+        }
+        compiler_.parse(cddl_prelude);
+        prelude_rules_ = compiler_.rules().size();
+        scope_         = fmt::format("{}::", name_space);
+        compiler_.parse(cddl_);
+
+        for (std::size_t i = prelude_rules_; i < compiler_.rules().size(); ++i) {
+            if (!compiler_.rules()[i].group) {
+                define(i);
+            }
+        }
+
+        fmt::format_to(std::back_inserter(out), R"(// Generated by cddl_struct_generator from {}, do not edit
+#pragma once
+
+#include "cbor_tags/cbor.h"
+#include "cbor_tags/cbor_concepts.h"
+#include "cbor_tags/cbor_integer.h"
+#include "cbor_tags/cbor_simple.h"
+#include "cbor_tags/float16_ieee754.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace {} {{
+
+// The schema the types were generated from, cddl_schema can check the ranges, literals and controls the types do not express
+inline constexpr std::string_view cddl = R"cddl({})cddl";
+)",
+                       source, name_space, cddl_);
+        fmt::format_to(std::back_inserter(out), "{}\n}} // namespace {}\n", declarations_, name_space);
+    }
+
+  private:
+    using rule = detail::cddl_compiler::rule;
+
+    enum class state : std::uint8_t { defining, defined };
+
+    // Rules
+
+    const rule &rule_at(std::size_t index) const { return compiler_.rules()[index]; }
+
+    std::size_t find_rule(std::string_view name) const {
+        for (auto i = compiler_.rules().size(); i > 0; --i) {
+            if (rule_at(i - 1).name == name) {
+                return i - 1;
+            }
+        }
+        throw std::runtime_error(fmt::format("'{}' is not defined", name));
+    }
+
+    // The type of a rule, defining it and what it refers to before anything that uses it
+    cpp_type define(std::size_t index) {
+        if (const auto it = defined_.find(index); it != defined_.end()) {
+            if (it->second.second == state::defining) {
+                throw std::runtime_error(fmt::format("'{}' is recursive", rule_at(index).name));
+            }
+            return it->second.first;
+        }
+        const auto &r = rule_at(index);
+        if (r.group) {
+            throw std::runtime_error(fmt::format("group '{}' is used as a type", r.name));
+        }
+        if (index < prelude_rules_) {
+            if (const auto builtin = prelude_type(r.name)) {
+                return *builtin;
+            }
+        }
+
+        defined_[index] = {cpp_type{}, state::defining};
+        const auto name = identifier(r.name);
+        auto       type = type_of(r.node, name);
+        if (type.name != scope_ + name) {
+            // Only arrays of members and tags produce a struct of their own, everything else is an alias
+            if (!declared_.insert(name).second) {
+                throw std::runtime_error(fmt::format("{} is declared twice", name));
+            }
+            declarations_ += fmt::format("\nusing {} = {};\n", name, type.name);
+            type.name = scope_ + name;
+        }
+        defined_[index] = {type, state::defined};
+        return type;
+    }
+
+    // Prelude types with a direct C++ counterpart, the rest are generated like any other rule
+    static std::optional<cpp_type> prelude_type(std::string_view name) {
+        const auto choice = [](std::string_view text, std::vector<cpp_type> alternatives) {
+            return cpp_type{std::string(text), major_bit(major_type::Simple), true, true, std::move(alternatives)};
+        };
+        if (name == "any") {
+            return any_type;
+        }
+        if (name == "uint") {
+            return uint_type;
+        }
+        if (name == "nint") {
+            return nint_type;
+        }
+        if (name == "int") {
+            return int_type;
+        }
+        if (name == "bstr" || name == "bytes") {
+            return bytes_type;
+        }
+        if (name == "tstr" || name == "text") {
+            return text_type;
+        }
+        if (name == "bool" || name == "true" || name == "false") {
+            return bool_type;
+        }
+        if (name == "nil" || name == "null") {
+            return null_type;
+        }
+        if (name == "float16") {
+            return float16_type;
+        }
+        if (name == "float32") {
+            return float32_type;
+        }
+        if (name == "float64") {
+            return float64_type;
+        }
+        if (name == "float16-32") {
+            return choice("std::variant<cbor::tags::float16_t, float>", {float16_type, float32_type});
+        }
+        if (name == "float32-64") {
+            return choice("std::variant<float, double>", {float32_type, float64_type});
+        }
+        if (name == "float") {
+            return choice("std::variant<cbor::tags::float16_t, float, double>", {float16_type, float32_type, float64_type});
+        }
+        return std::nullopt;
+    }
+
+    // Types
+
+    // The C++ type of a node, struct_name names the struct an array of members or a tag declares
+    cpp_type type_of(std::uint32_t index, const std::string &struct_name) {
+        const auto &node = tables_.nodes[index];
+        switch (node.kind) {
+        case detail::cddl_kind::any: return any_type;
+        case detail::cddl_kind::reference: return define(find_rule(string_of(node)));
+        case detail::cddl_kind::integer:
+            return !node.low.negative ? uint_type : node.high.negative ? nint_type : int_type;
+        case detail::cddl_kind::floating:
+            switch (node.widths) {
+            case 0b001: return float16_type;
+            case 0b010: return float32_type;
+            case 0b100: return float64_type;
+            default: {
+                const cpp_type        all[] = {float16_type, float32_type, float64_type};
+                std::vector<cpp_type> widths;
+                for (unsigned i = 0; i < 3; ++i) {
+                    if ((node.widths & (1U << i)) != 0) {
+                        widths.push_back(all[i]);
+                    }
+                }
+                return merge(widths);
+            }
+            }
+        case detail::cddl_kind::simple:
+            return node.low.argument == 20 || node.low.argument == 21 ? bool_type : node.low.argument == 22 ? null_type : simple_type;
+        case detail::cddl_kind::bytes: return bytes_type;
+        case detail::cddl_kind::text:
+        case detail::cddl_kind::text_literal: return text_type;
+        case detail::cddl_kind::major:
+            switch (node.major) {
+            case major_type::UnsignedInteger: return uint_type;
+            case major_type::NegativeInteger: return nint_type;
+            case major_type::ByteString: return bytes_type;
+            case major_type::TextString: return text_type;
+            default: throw std::runtime_error(fmt::format("#{} has no C++ type, name the type instead", static_cast<int>(node.major)));
+            }
+        case detail::cddl_kind::choice: {
+            std::vector<cpp_type> alternatives;
+            for (std::uint32_t i = 0; i < node.count; ++i) {
+                alternatives.push_back(type_of(tables_.edges[node.first + i], fmt::format("{}_{}", struct_name, i)));
+            }
+            return merge(alternatives);
+        }
+        case detail::cddl_kind::array: return array(node, struct_name);
+        case detail::cddl_kind::map: return map(node, struct_name);
+        case detail::cddl_kind::tag: return tag(node, struct_name);
+        }
+        throw std::runtime_error("unknown node");
+    }
+
+    // A fixed list of members is an aggregate, the encoder wraps its members in an array. A single member or a repeated entry is a
+    // vector, since an aggregate of one member is encoded as that member.
+    cpp_type array(const detail::cddl_node &node, const std::string &struct_name) {
+        const auto entries = flatten(node.first, node.count);
+        if (entries.empty()) {
+            throw std::runtime_error(fmt::format("{} is an empty array", struct_name));
+        }
+        if (entries.size() == 1) {
+            return vector_of(type_of(entries.front().value, struct_name + "_item"));
+        }
+        for (const auto &entry : entries) {
+            if (entry.min != 1 || entry.max != 1) {
+                throw std::runtime_error(fmt::format("{} has optional or repeated members, which an aggregate cannot express", struct_name));
+            }
+        }
+
+        auto members = members_of(entries, struct_name);
+        declare(struct_name, std::nullopt, std::move(members));
+        return cpp_type{scope_ + struct_name, major_bit(major_type::Array), false, false};
+    }
+
+    // #6.n([members]) puts the members right after the tag, like the encoder does for an aggregate with an inline cbor_tag. Any other
+    // enclosed type is the single member value.
+    cpp_type tag(const detail::cddl_node &node, const std::string &struct_name) {
+        const auto &enclosed = tables_.nodes[node.first];
+
+        std::vector<std::pair<std::string, std::string>> members;
+        if (enclosed.kind == detail::cddl_kind::array) {
+            const auto entries = flatten(enclosed.first, enclosed.count);
+            if (entries.size() > 1 && std::ranges::all_of(entries, [](const auto &e) { return e.min == 1 && e.max == 1; })) {
+                members = members_of(entries, struct_name);
+            }
+        }
+        if (members.empty()) {
+            members.emplace_back(type_of(node.first, struct_name + "_value").name, "value");
+        }
+        declare(struct_name, node.low.argument, std::move(members));
+        return cpp_type{scope_ + struct_name, major_bit(major_type::Tag), true};
+    }
+
+    // Maps become std::map of the key types to the value types, a map of named members included
+    cpp_type map(const detail::cddl_node &node, const std::string &struct_name) {
+        std::vector<cpp_type> keys;
+        std::vector<cpp_type> values;
+        for (const auto &entry : flatten(node.first, node.count)) {
+            if (entry.key == detail::cddl_no_node) {
+                throw std::runtime_error(fmt::format("{} has a map member without a key", struct_name));
+            }
+            keys.push_back(type_of(entry.key, struct_name + "_key"));
+            values.push_back(type_of(entry.value, fmt::format("{}_{}", struct_name, member_name(entry, values.size()))));
+        }
+        if (keys.empty()) {
+            throw std::runtime_error(fmt::format("{} is an empty map", struct_name));
+        }
+        const auto key   = merge(keys);
+        const auto value = merge(values);
+        return cpp_type{fmt::format("std::map<{}, {}>", key.name, value.name), major_bit(major_type::Map)};
+    }
+
+    static cpp_type vector_of(const cpp_type &item) {
+        return cpp_type{fmt::format("std::vector<{}>", item.name), major_bit(major_type::Array)};
+    }
+
+    // A choice is the one type all alternatives share, an optional of the type besides null, or a variant the decoder can pick an
+    // alternative of by the major type, tag or simple value
+    cpp_type merge(const std::vector<cpp_type> &alternatives) {
+        std::vector<cpp_type> flat;
+        for (const auto &alternative : alternatives) {
+            const auto &parts = alternative.choices.empty() ? std::vector<cpp_type>{alternative} : alternative.choices;
+            for (const auto &part : parts) {
+                if (std::ranges::find(flat, part.name, &cpp_type::name) == flat.end()) {
+                    flat.push_back(part);
+                }
+            }
+        }
+        if (std::ranges::count_if(flat, is_integer) > 1) {
+            std::erase_if(flat, is_integer);
+            flat.insert(flat.begin(), int_type);
+        }
+        if (flat.size() == 1) {
+            return flat.front();
+        }
+        for (const auto &alternative : flat) {
+            if (!alternative.alternative) {
+                throw std::runtime_error(fmt::format("{} cannot be told apart from other alternatives of a choice", alternative.name));
+            }
+        }
+        for (std::size_t i = 0; i < flat.size(); ++i) {
+            for (std::size_t j = i + 1; j < flat.size(); ++j) {
+                if ((flat[i].majors & flat[j].majors) != 0 && !(flat[i].numbered && flat[j].numbered)) {
+                    throw std::runtime_error(fmt::format("{} and {} share a major type in a choice", flat[i].name, flat[j].name));
+                }
+            }
+        }
+
+        std::uint16_t majors{};
+        for (const auto &alternative : flat) {
+            majors |= alternative.majors;
+        }
+        const auto null = std::ranges::find(flat, null_type.name, &cpp_type::name);
+        if (flat.size() == 2 && null != flat.end()) {
+            const auto &other = flat[null == flat.begin() ? 1 : 0];
+            return cpp_type{fmt::format("std::optional<{}>", other.name), majors, false, true, flat};
+        }
+        std::string names;
+        for (const auto &alternative : flat) {
+            names += names.empty() ? alternative.name : ", " + alternative.name;
+        }
+        return cpp_type{fmt::format("std::variant<{}>", names), majors, false, true, flat};
+    }
+
+    // Groups
+
+    // The entries of a group with nested groups and group rules spliced in, which must occur exactly once
+    std::vector<detail::cddl_entry> flatten(std::uint32_t first, std::uint32_t count, std::size_t depth = 0) {
+        if (depth > detail::cddl_max_group_nesting) {
+            throw std::runtime_error("groups are nested too deep");
+        }
+        std::vector<detail::cddl_entry> entries;
+        for (std::uint32_t i = first; i < first + count; ++i) {
+            const auto &entry = tables_.entries[i];
+            auto        group = entry.value == detail::cddl_no_node ? std::optional(std::pair{entry.first, entry.count}) : std::nullopt;
+            if (!group && entry.key == detail::cddl_no_node && tables_.nodes[entry.value].kind == detail::cddl_kind::reference) {
+                if (const auto &r = rule_at(find_rule(string_of(tables_.nodes[entry.value]))); r.group) {
+                    group = std::pair{r.first, r.count};
+                }
+            }
+            if (!group) {
+                entries.push_back(entry);
+                continue;
+            }
+            if (entry.min != 1 || entry.max != 1) {
+                throw std::runtime_error("optional or repeated groups cannot be spliced into a type");
+            }
+            const auto nested = flatten(group->first, group->second, depth + 1);
+            entries.insert(entries.end(), nested.begin(), nested.end());
+        }
+        return entries;
+    }
+
+    std::string member_name(const detail::cddl_entry &entry, std::size_t position) const {
+        if (entry.key != detail::cddl_no_node && tables_.nodes[entry.key].kind == detail::cddl_kind::text_literal) {
+            return identifier(string_of(tables_.nodes[entry.key]));
+        }
+        if (entry.key == detail::cddl_no_node && tables_.nodes[entry.value].kind == detail::cddl_kind::reference) {
+            return identifier(string_of(tables_.nodes[entry.value]));
+        }
+        return fmt::format("item{}", position);
+    }
+
+    std::vector<std::pair<std::string, std::string>> members_of(const std::vector<detail::cddl_entry> &entries,
+                                                                const std::string              &struct_name) {
+        std::vector<std::pair<std::string, std::string>> members;
+        for (const auto &entry : entries) {
+            auto name = member_name(entry, members.size());
+            if (std::ranges::find(members, name, &std::pair<std::string, std::string>::second) != members.end()) {
+                name += fmt::format("_{}", members.size());
+            }
+            members.emplace_back(type_of(entry.value, fmt::format("{}_{}", struct_name, name)).name, name);
+        }
+        return members;
+    }
+
+    // Declarations
+
+    // A struct with its members aligned like clang-format does, the inline tag goes first
+    void declare(const std::string &name, std::optional<std::uint64_t> tag, std::vector<std::pair<std::string, std::string>> members) {
+        if (!declared_.insert(name).second) {
+            throw std::runtime_error(fmt::format("{} is declared twice", name));
+        }
+        if (tag) {
+            members.emplace(members.begin(), "static constexpr std::uint64_t", fmt::format("cbor_tag = {}", *tag));
+        }
+        std::size_t width = 0;
+        for (const auto &[type, member] : members) {
+            width = std::max(width, type.size());
+        }
+        declarations_ += fmt::format("\nstruct {} {{\n", name);
+        for (const auto &[type, member] : members) {
+            declarations_ += fmt::format("    {}{} {};\n", type, std::string(width - type.size(), ' '), member);
+        }
+        declarations_ += "};\n";
+    }
+
+    std::string_view string_of(const detail::cddl_node &node) const {
+        return std::string_view(tables_.strings).substr(node.first, node.count);
+    }
+
+    std::string_view                                       cddl_;
+    detail::cddl_tables                                    tables_;
+    detail::cddl_compiler                                  compiler_;
+    std::size_t                                            prelude_rules_{};
+    std::string                                            scope_; // Generated names are qualified, so a member may share the name of its type
+    std::map<std::size_t, std::pair<cpp_type, state>>      defined_;
+    std::set<std::string>                                  declared_;
+    std::string                                            declarations_;
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 4) {
+        fmt::print(stderr, "Usage: {} <schema.cddl> <output.h> [namespace]\n", argv[0]);
+        return 1;
+    }
+    const std::filesystem::path input(argv[1]);
+    const std::filesystem::path output(argv[2]);
+    const auto                  name_space = argc == 4 ? std::string(argv[3]) : identifier(input.stem().string());
+
+    std::ifstream in_file(input);
+    if (!in_file) {
+        fmt::print(stderr, "Error: Failed to open {}\n", input.string());
+        return 1;
+    }
+    std::stringstream cddl;
+    cddl << in_file.rdbuf();
+    const auto text = cddl.str();
+
+    fmt::memory_buffer buffer;
+    try {
+        struct_generator generator(text);
+        generator.generate(name_space, input.filename().string(), buffer);
+    } catch (const std::exception &e) {
+        fmt::print(stderr, "Error: {}: {}\n", input.string(), e.what());
+        return 1;
+    }
+
+    std::ofstream out_file(output);
+    if (!out_file) {
+        fmt::print(stderr, "Error: Failed to open output file {}\n", output.string());
+        return 1;
+    }
+    out_file << std::string_view(buffer.data(), buffer.size());
+    return 0;
+}